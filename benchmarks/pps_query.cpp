@@ -72,58 +72,58 @@ void PPSQuery::print() {
   
 }
 
-std::set<uint64_t> PPSQuery::participants(Message * msg, Workload * wl) {
-  std::set<uint64_t> participant_set;
+uint64_t PPSQuery::participants(Message * msg, Workload * wl) {
+  uint64_t participant_set = 0;
   PPSClientQueryMessage* pps_msg = ((PPSClientQueryMessage*)msg);
   uint64_t id;
 
   switch(pps_msg->txn_type) {
     case PPS_GETPART:
       id = GET_NODE_ID(parts_to_partition(pps_msg->part_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       break;
     case PPS_GETPRODUCT:
       id = GET_NODE_ID(products_to_partition(pps_msg->product_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       break;
     case PPS_GETSUPPLIER:
       id = GET_NODE_ID(suppliers_to_partition(pps_msg->supplier_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       break;
     case PPS_GETPARTBYSUPPLIER:
       id = GET_NODE_ID(suppliers_to_partition(pps_msg->supplier_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       for (uint64_t key = 0; key < pps_msg->part_keys.size(); key++) {
           uint64_t tmp = pps_msg->part_keys[key];
           id = GET_NODE_ID(parts_to_partition(tmp));
-          participant_set.insert(id);
+          participant_set |= 1UL << id;
       }
       break;
     case PPS_GETPARTBYPRODUCT:
       id = GET_NODE_ID(products_to_partition(pps_msg->product_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       for (uint64_t key = 0; key < pps_msg->part_keys.size(); key++) {
           uint64_t tmp = pps_msg->part_keys[key];
           id = GET_NODE_ID(parts_to_partition(tmp));
-          participant_set.insert(id);
+          participant_set |= 1UL << id;
       }
       break;
     case PPS_ORDERPRODUCT:
       id = GET_NODE_ID(products_to_partition(pps_msg->product_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       for (uint64_t key = 0; key < pps_msg->part_keys.size(); key++) {
           uint64_t tmp = pps_msg->part_keys[key];
           id = GET_NODE_ID(parts_to_partition(tmp));
-          participant_set.insert(id);
+          participant_set |= 1UL << id;
       }
       break;
     case PPS_UPDATEPRODUCTPART:
       id = GET_NODE_ID(products_to_partition(pps_msg->product_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       break;
     case PPS_UPDATEPART:
       id = GET_NODE_ID(parts_to_partition(pps_msg->part_key));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       break;
     default: assert(false);
   }
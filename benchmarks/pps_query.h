@@ -49,7 +49,8 @@ public:
     void reset();
     void release();
     void print();
-    static std::set<uint64_t> participants(Message * msg, Workload * wl);
+    // bitmap of the nodes the txn touches
+    static uint64_t participants(Message * msg, Workload * wl);
     uint64_t participants(bool *& pps,Workload * wl);
     uint64_t get_participants(Workload * wl);
     bool readonly();
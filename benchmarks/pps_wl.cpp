@@ -21,12 +21,14 @@
 #include "thread.h"
 #include "table.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "index_btree.h"
 #include "pps_helper.h"
 #include "row.h"
 #include "query.h"
 #include "txn.h"
 #include "mem_alloc.h"
+#include "checkpoint.h"
 
 RC PPSWorkload::init() {
 	Workload::init();
@@ -46,7 +48,10 @@ RC PPSWorkload::init() {
   printf("Done\n");
   printf("Initializing table... ");
   fflush(stdout);
-	init_table();
+	if (checkpointer.load_tables(this) != RCOK) {
+		init_table();
+		checkpointer.save_snapshot(this);
+	}
   printf("Done\n");
   fflush(stdout);
 	return RCOK;
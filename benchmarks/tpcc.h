@@ -48,6 +48,27 @@ enum TPCCRemTxnType {
   TPCC_NEWORDER7,
   TPCC_NEWORDER8,
   TPCC_NEWORDER9,
+  TPCC_ORDERSTATUS_S,
+  TPCC_ORDERSTATUS0,
+  TPCC_ORDERSTATUS1,
+  TPCC_ORDERSTATUS2,
+  TPCC_ORDERSTATUS3,
+  TPCC_ORDERSTATUS4,
+  TPCC_ORDERSTATUS5,
+  TPCC_DELIVERY_S,
+  TPCC_DELIVERY0,
+  TPCC_DELIVERY1,
+  TPCC_DELIVERY2,
+  TPCC_DELIVERY3,
+  TPCC_DELIVERY4,
+  TPCC_DELIVERY5,
+  TPCC_DELIVERY6,
+  TPCC_DELIVERY7,
+  TPCC_STOCKLEVEL_S,
+  TPCC_STOCKLEVEL0,
+  TPCC_STOCKLEVEL1,
+  TPCC_STOCKLEVEL2,
+  TPCC_STOCKLEVEL3,
   TPCC_FIN,
   TPCC_RDONE};
 
@@ -74,17 +95,15 @@ public:
 	INDEX * 	i_customer_id;
 	INDEX * 	i_customer_last;
 	INDEX * 	i_stock;
+	INDEX * 	i_neworder; // key = (w_id, d_id, o_id)
 	INDEX * 	i_order; // key = (w_id, d_id, o_id)
-//	INDEX * 	i_order_wdo; // key = (w_id, d_id, o_id)
-//	INDEX * 	i_order_wdc; // key = (w_id, d_id, c_id)
+	INDEX * 	i_order_cust; // key = (w_id, d_id, c_id), newest order first
 	INDEX * 	i_orderline; // key = (w_id, d_id, o_id)
-	INDEX * 	i_orderline_wd; // key = (w_id, d_id). 
 	
-	// XXX HACK
-	// For delivary. Only one txn can be delivering a warehouse at a time.
-	// *_delivering[warehouse_id] -> the warehouse is delivering.
-	bool ** delivering;
-//	bool volatile ** delivering;
+	// For delivery. Oldest o_id of each district that may still have a
+	// new-order row, indexed by distKey. Delivered new-order rows have
+	// NO_O_ID set to 0 and are skipped by moving the hint past them.
+	uint64_t * no_o_id_hint;
 
 private:
 	uint64_t num_wh;
@@ -95,12 +114,9 @@ private:
 	// init_tab_cust initializes both tab_cust and tab_hist.
 	void init_tab_cust(int id, uint64_t d_id, uint64_t w_id);
 	void init_tab_hist(uint64_t c_id, uint64_t d_id, uint64_t w_id);
-	void init_tab_order(int id,uint64_t d_id, uint64_t w_id);
+	void init_tab_order(uint64_t d_id, uint64_t w_id);
 	
-	UInt32 perm_count;
-	uint64_t * perm_c_id;
-	void init_permutation();
-	uint64_t get_permutation();
+	void init_permutation(uint64_t * perm_c_id);
 
 	static void * threadInitItem(void * This);
 	static void * threadInitWh(void * This);
@@ -123,6 +139,7 @@ public:
 	void init(uint64_t thd_id, Workload * h_wl);
   void reset();
   RC acquire_locks(); 
+  void publish_commit();
 	RC run_txn();
 	RC run_txn_post_wait();
 	RC run_calvin_txn(); 
@@ -136,12 +153,29 @@ private:
   row_t * row;
 
   uint64_t next_item_id;
+  // [ORDER_STATUS, DELIVERY, STOCK_LEVEL]
+  uint64_t next_d_id;
+  uint64_t cur_c_id;
+  // Stock-Level visits the orders in [cur_o_id, end_o_id)
+  uint64_t cur_o_id;
+  uint64_t end_o_id;
+  itemid_t * next_ol_item;
+  double ol_total;
+  // [STOCK_LEVEL] distinct low-stock items seen so far, and their count
+  std::set<uint64_t> low_stock_items;
+  uint64_t stock_count;
+  // orders delivered for each district; 0 if none. [CALVIN] picked by
+  // acquire_locks, otherwise the hint is moved past them at commit
+  uint64_t dlv_o_id[DIST_PER_WH + 1];
 
 void next_tpcc_state();
 RC run_txn_state();
   bool is_done();
   bool is_local_item(uint64_t idx);
   RC send_remote_request(); 
+  row_t * find_customer(uint64_t c_id, uint64_t c_d_id, uint64_t c_w_id, char * c_last, bool by_last_name);
+  void next_order_line(uint64_t w_id, uint64_t d_id);
+  void next_district();
 
 	RC run_payment_0(uint64_t w_id, uint64_t d_id, uint64_t d_w_id, double h_amount, row_t *& r_wh_local);
 	RC run_payment_1(uint64_t w_id, uint64_t d_id, uint64_t d_w_id, double h_amount, row_t * r_wh_local);
@@ -159,9 +193,24 @@ RC run_txn_state();
 	RC new_order_7(uint64_t ol_i_id, row_t * r_item_local);
 	RC new_order_8(uint64_t w_id,uint64_t  d_id,bool remote, uint64_t ol_i_id, uint64_t ol_supply_w_id, uint64_t ol_quantity,uint64_t  ol_number,uint64_t  o_id, row_t *& r_stock_local);
 	RC new_order_9(uint64_t w_id,uint64_t  d_id,bool remote, uint64_t ol_i_id, uint64_t ol_supply_w_id, uint64_t ol_quantity,uint64_t  ol_number,uint64_t ol_amount, uint64_t  o_id, row_t * r_stock_local);
-	RC run_order_status(TPCCQuery * query);
-	RC run_delivery(TPCCQuery * query);
-	RC run_stock_level(TPCCQuery * query);
+	RC run_order_status_0(uint64_t w_id, uint64_t d_id, uint64_t c_id, char * c_last, bool by_last_name, row_t *& r_cust_local);
+	RC run_order_status_1(row_t * r_cust_local);
+	RC run_order_status_2(uint64_t w_id, uint64_t d_id, row_t *& r_order_local);
+	RC run_order_status_3(uint64_t w_id, uint64_t d_id, row_t * r_order_local);
+	RC run_order_status_4(row_t *& r_ol_local);
+	RC run_order_status_5(row_t * r_ol_local);
+	RC run_delivery_0(uint64_t w_id, uint64_t d_id, row_t *& r_no_local);
+	RC run_delivery_1(uint64_t w_id, uint64_t d_id, row_t * r_no_local);
+	RC run_delivery_2(uint64_t w_id, uint64_t d_id, row_t *& r_order_local);
+	RC run_delivery_3(uint64_t w_id, uint64_t d_id, uint64_t o_carrier_id, row_t * r_order_local);
+	RC run_delivery_4(row_t *& r_ol_local);
+	RC run_delivery_5(row_t * r_ol_local);
+	RC run_delivery_6(uint64_t w_id, uint64_t d_id, row_t *& r_cust_local);
+	RC run_delivery_7(row_t * r_cust_local);
+	RC run_stock_level_0(uint64_t w_id, uint64_t d_id, row_t *& r_dist_local);
+	RC run_stock_level_1(uint64_t w_id, uint64_t d_id, row_t * r_dist_local);
+	RC run_stock_level_2(uint64_t w_id, row_t *& r_stock_local);
+	RC run_stock_level_3(uint64_t w_id, uint64_t d_id, uint64_t threshold, row_t * r_stock_local);
 };
 
 #endif
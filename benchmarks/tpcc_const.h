@@ -50,7 +50,8 @@ enum {
 	C_DISCOUNT,
 	C_BALANCE,
 	C_YTD_PAYMENT,
-	C_PAYMENT_CNT
+	C_PAYMENT_CNT,
+	C_DELIVERY_CNT
 };
 enum {
 	H_C_ID,
@@ -81,7 +82,11 @@ enum {
 	OL_D_ID,
 	OL_W_ID,
 	OL_NUMBER,
-	OL_I_ID
+	OL_I_ID,
+	OL_SUPPLY_W_ID,
+	OL_DELIVERY_D,
+	OL_QUANTITY,
+	OL_AMOUNT
 };
 enum {
 	I_ID,
@@ -24,8 +24,14 @@ uint64_t custKey(uint64_t c_id, uint64_t c_d_id, uint64_t c_w_id) {
 	return (distKey(c_d_id, c_w_id) * g_cust_per_dist + c_id);
 }
 
+// o_id grows past g_cust_per_dist as orders are placed, so it is the high
+// part of the key: the keys of all districts stay dense and never overlap
+static uint64_t distKeyCnt() {
+	return distKey(g_dist_per_wh, g_num_wh) + 1;
+}
+
 uint64_t orderlineKey(uint64_t w_id, uint64_t d_id, uint64_t o_id) {
-	return distKey(d_id, w_id) * g_cust_per_dist + o_id; 
+	return o_id * distKeyCnt() + distKey(d_id, w_id); 
 }
 
 uint64_t orderPrimaryKey(uint64_t w_id, uint64_t d_id, uint64_t o_id) {
@@ -55,7 +61,7 @@ uint64_t w_from_custKey(uint64_t c_key) {
 }
 
 uint64_t w_from_orderlineKey(uint64_t s_key) {
-  return w_from_distKey(s_key / g_cust_per_dist);
+  return w_from_distKey(s_key % distKeyCnt());
 }
 
 uint64_t w_from_orderPrimaryKey(uint64_t s_key) {
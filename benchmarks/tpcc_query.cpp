@@ -27,8 +27,13 @@ BaseQuery * TPCCQueryGenerator::create_query(Workload * h_wl,uint64_t home_parti
   double x = (double)(rand() % 100) / 100.0;
 	if (x < g_perc_payment)
 		return gen_payment(home_partition_id);
-	else 
-		return gen_new_order(home_partition_id);
+	if (x < g_perc_payment + g_perc_order_status)
+		return gen_order_status(home_partition_id);
+	if (x < g_perc_payment + g_perc_order_status + g_perc_delivery)
+		return gen_delivery(home_partition_id);
+	if (x < g_perc_payment + g_perc_order_status + g_perc_delivery + g_perc_stock_level)
+		return gen_stock_level(home_partition_id);
+	return gen_new_order(home_partition_id);
 
 }
 
@@ -64,25 +69,30 @@ void TPCCQuery::print() {
     }
 }
 
-std::set<uint64_t> TPCCQuery::participants(Message * msg, Workload * wl) {
-  std::set<uint64_t> participant_set;
+uint64_t TPCCQuery::participants(Message * msg, Workload * wl) {
+  uint64_t participant_set = 0;
   TPCCClientQueryMessage* tpcc_msg = ((TPCCClientQueryMessage*)msg);
   uint64_t id;
 
   id = GET_NODE_ID(wh_to_part(tpcc_msg->w_id));
-  participant_set.insert(id);
+  participant_set |= 1UL << id;
 
   switch(tpcc_msg->txn_type) {
     case TPCC_PAYMENT:
       id = GET_NODE_ID(wh_to_part(tpcc_msg->c_w_id));
-      participant_set.insert(id);
+      participant_set |= 1UL << id;
       break;
     case TPCC_NEW_ORDER: 
       for(uint64_t i = 0; i < tpcc_msg->ol_cnt; i++) {
         uint64_t req_nid = GET_NODE_ID(wh_to_part(tpcc_msg->items[i]->ol_supply_w_id));
-        participant_set.insert(req_nid);
+        participant_set |= 1UL << req_nid;
       }
       break;
+    case TPCC_ORDER_STATUS:
+    case TPCC_DELIVERY:
+    case TPCC_STOCK_LEVEL:
+      // only the home warehouse
+      break;
     default: assert(false);
   }
 
@@ -136,6 +146,13 @@ uint64_t TPCCQuery::participants(bool *& pps,Workload * wl) {
         }
       }
       break;
+    case TPCC_ORDER_STATUS:
+    case TPCC_DELIVERY:
+    case TPCC_STOCK_LEVEL:
+      id = GET_NODE_ID(wh_to_part(w_id));
+      pps[id] = true;
+      n++;
+      break;
     default: assert(false);
   }
 
@@ -143,7 +160,17 @@ uint64_t TPCCQuery::participants(bool *& pps,Workload * wl) {
 }
 
 bool TPCCQuery::readonly() {
-  return false;
+  return txn_type == TPCC_ORDER_STATUS || txn_type == TPCC_STOCK_LEVEL;
+}
+
+uint64_t TPCCQueryGenerator::gen_home_warehouse(uint64_t home_partition) {
+  uint64_t home_warehouse;
+	if (FIRST_PART_LOCAL) {
+    while(wh_to_part(home_warehouse = URand(1, g_num_wh)) != home_partition) {}
+  }
+	else
+		home_warehouse = URand(1, g_num_wh);
+  return home_warehouse;
 }
 
 BaseQuery * TPCCQueryGenerator::gen_payment(uint64_t home_partition) {
@@ -262,6 +289,62 @@ BaseQuery * TPCCQueryGenerator::gen_new_order(uint64_t home_partition) {
 
 }
 
+BaseQuery * TPCCQueryGenerator::gen_order_status(uint64_t home_partition) {
+  TPCCQuery * query = new TPCCQuery;
+
+	query->txn_type = TPCC_ORDER_STATUS;
+  query->w_id = gen_home_warehouse(home_partition);
+	query->d_id = URand(1, g_dist_per_wh);
+	query->d_w_id = query->w_id;
+	query->c_w_id = query->w_id;
+	query->c_d_id = query->d_id;
+  query->rbk = false;
+	if(URand(1, 100) <= 60) {
+		// by last name
+		query->by_last_name = true;
+		Lastname(NURand(255,0,999),query->c_last);
+	} else {
+		// by cust id
+		query->by_last_name = false;
+		query->c_id = NURand(1023, 1, g_cust_per_dist);
+	}
+
+  query->partitions.init(1);
+  query->partitions.add(wh_to_part(query->w_id));
+  return query;
+}
+
+BaseQuery * TPCCQueryGenerator::gen_delivery(uint64_t home_partition) {
+  TPCCQuery * query = new TPCCQuery;
+
+	query->txn_type = TPCC_DELIVERY;
+  query->w_id = gen_home_warehouse(home_partition);
+	query->d_w_id = query->w_id;
+	query->o_carrier_id = URand(1, 10);
+  query->rbk = false;
+  query->by_last_name = false;
+
+  query->partitions.init(1);
+  query->partitions.add(wh_to_part(query->w_id));
+  return query;
+}
+
+BaseQuery * TPCCQueryGenerator::gen_stock_level(uint64_t home_partition) {
+  TPCCQuery * query = new TPCCQuery;
+
+	query->txn_type = TPCC_STOCK_LEVEL;
+  query->w_id = gen_home_warehouse(home_partition);
+	query->d_id = URand(1, g_dist_per_wh);
+	query->d_w_id = query->w_id;
+	query->threshold = URand(10, 20);
+  query->rbk = false;
+  query->by_last_name = false;
+
+  query->partitions.init(1);
+  query->partitions.add(wh_to_part(query->w_id));
+  return query;
+}
+
 uint64_t TPCCQuery::get_participants(Workload * wl) {
    uint64_t participant_cnt = 0;
    uint64_t active_cnt = 0;
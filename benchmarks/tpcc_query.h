@@ -47,6 +47,10 @@ private:
 	BaseQuery * gen_requests(uint64_t home_partition_id, Workload * h_wl);
   BaseQuery * gen_payment(uint64_t home_partition); 
   BaseQuery * gen_new_order(uint64_t home_partition); 
+  BaseQuery * gen_order_status(uint64_t home_partition); 
+  BaseQuery * gen_delivery(uint64_t home_partition); 
+  BaseQuery * gen_stock_level(uint64_t home_partition); 
+  uint64_t gen_home_warehouse(uint64_t home_partition); 
 	myrand * mrand;
 };
 
@@ -58,7 +62,8 @@ public:
   void release();
   void release_items();
   void print();
-  static std::set<uint64_t> participants(Message * msg, Workload * wl); 
+  // bitmap of the nodes the txn touches
+  static uint64_t participants(Message * msg, Workload * wl); 
   uint64_t participants(bool *& pps,Workload * wl); 
   uint64_t get_participants(Workload * wl); 
   bool readonly();
@@ -85,7 +90,8 @@ public:
 	// Input for delivery
 	uint64_t o_carrier_id;
 	uint64_t ol_delivery_d;
-	// for order-status
+	// Input for stock-level
+	uint64_t threshold;
 
 	// Other
 	uint64_t ol_i_id;
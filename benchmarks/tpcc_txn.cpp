@@ -23,6 +23,7 @@
 #include "table.h"
 #include "row.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "index_btree.h"
 #include "tpcc_const.h"
 #include "transport.h"
@@ -43,11 +44,40 @@ void TPCCTxnManager::reset() {
     state = TPCC_PAYMENT0;
   } else if (tpcc_query->txn_type == TPCC_NEW_ORDER) {
     state = TPCC_NEWORDER0;
+  } else if (tpcc_query->txn_type == TPCC_ORDER_STATUS) {
+    state = TPCC_ORDERSTATUS0;
+  } else if (tpcc_query->txn_type == TPCC_DELIVERY) {
+    state = TPCC_DELIVERY0;
+  } else if (tpcc_query->txn_type == TPCC_STOCK_LEVEL) {
+    state = TPCC_STOCKLEVEL0;
   }
   next_item_id = 0;
+  next_d_id = 1;
+  cur_c_id = 0;
+  cur_o_id = 0;
+  end_o_id = 0;
+  next_ol_item = NULL;
+  ol_total = 0;
+  low_stock_items.clear();
+  stock_count = 0;
+#if CC_ALG != CALVIN
+  memset(dlv_o_id, 0, sizeof(dlv_o_id));
+#endif
 	TxnManager::reset();
 }
 
+void TPCCTxnManager::publish_commit() {
+#if CC_ALG != CALVIN
+	TPCCQuery* tpcc_query = (TPCCQuery*) query;
+	if (tpcc_query->txn_type != TPCC_DELIVERY)
+		return;
+	for (uint64_t d = 1; d <= g_dist_per_wh; d++) {
+		if (dlv_o_id[d] != 0)
+			ATOM_CAS(_wl->no_o_id_hint[distKey(d, tpcc_query->w_id)], dlv_o_id[d], dlv_o_id[d] + 1);
+	}
+#endif
+}
+
 RC TPCCTxnManager::run_txn_post_wait() {
     get_row_post_wait(row);
     next_tpcc_state();
@@ -67,7 +97,8 @@ RC TPCCTxnManager::run_txn() {
   return rc;
 #endif
 
-  if(IS_LOCAL(txn->txn_id) && (state == TPCC_PAYMENT0 || state == TPCC_NEWORDER0)) {
+  if(IS_LOCAL(txn->txn_id) && (state == TPCC_PAYMENT0 || state == TPCC_NEWORDER0
+        || state == TPCC_ORDERSTATUS0 || state == TPCC_DELIVERY0 || state == TPCC_STOCKLEVEL0)) {
     DEBUG("Running txn %ld\n",txn->txn_id);
 #if DISTR_DEBUG
     query->print();
@@ -107,6 +138,11 @@ bool TPCCTxnManager::is_done() {
       //done = next_item_id == tpcc_query->ol_cnt || state == TPCC_FIN;
       done = next_item_id == tpcc_query->items.size() || state == TPCC_FIN;
       break;
+    case TPCC_ORDER_STATUS:
+    case TPCC_DELIVERY:
+    case TPCC_STOCK_LEVEL:
+      done = state == TPCC_FIN;
+      break;
     default: assert(false);
   }
 
@@ -231,6 +267,98 @@ RC TPCCTxnManager::acquire_locks() {
             rc = rc2;
         }
       break;
+    // The rows these touch depend on what the database holds, so the lock
+    // thread reads the base rows to find them. It is the only thread that
+    // decides which orders a txn works on.
+    case TPCC_ORDER_STATUS:
+      if(GET_NODE_ID(part_id_w) == g_node_id) {
+      // Cust
+        row = find_customer(c_id, d_id, w_id, c_last, tpcc_query->by_last_name);
+        rc2 = get_lock(row, RD);
+        if(rc2 != RCOK)
+          rc = rc2;
+        row->get_value(C_ID, cur_c_id);
+      // Order
+        item = index_read(_wl->i_order_cust, custKey(cur_c_id, d_id, w_id), part_id_w, 0);
+        if(item == NULL)
+          break;
+        row = (row_t *) item->location;
+        rc2 = get_lock(row, RD);
+        if(rc2 != RCOK)
+          rc = rc2;
+        row->get_value(O_ID, cur_o_id);
+      // Order lines
+        item = index_read(_wl->i_orderline, orderlineKey(w_id, d_id, cur_o_id), part_id_w, 0);
+        for(; item != NULL; item = item->next) {
+          rc2 = get_lock((row_t *) item->location, RD);
+          if(rc2 != RCOK)
+            rc = rc2;
+        }
+      }
+      break;
+    case TPCC_DELIVERY:
+      if(GET_NODE_ID(part_id_w) == g_node_id) {
+        for(uint64_t d = 1; d <= g_dist_per_wh; d++) {
+          dlv_o_id[d] = 0;
+          uint64_t o_id = _wl->no_o_id_hint[distKey(d, w_id)];
+          key = orderPrimaryKey(w_id, d, o_id);
+          item = index_read(_wl->i_neworder, key, part_id_w, 0);
+          if(item == NULL)
+            continue;
+          // claim the oldest new-order of the district
+          dlv_o_id[d] = o_id;
+          ATOM_CAS(_wl->no_o_id_hint[distKey(d, w_id)], o_id, o_id + 1);
+        // New-order
+          rc2 = get_lock((row_t *) item->location, WR);
+          if(rc2 != RCOK)
+            rc = rc2;
+        // Order
+          item = index_read(_wl->i_order, key, part_id_w);
+          row = (row_t *) item->location;
+          rc2 = get_lock(row, WR);
+          if(rc2 != RCOK)
+            rc = rc2;
+          uint64_t o_c_id;
+          row->get_value(O_C_ID, o_c_id);
+        // Order lines
+          item = index_read(_wl->i_orderline, orderlineKey(w_id, d, o_id), part_id_w, 0);
+          for(; item != NULL; item = item->next) {
+            rc2 = get_lock((row_t *) item->location, WR);
+            if(rc2 != RCOK)
+              rc = rc2;
+          }
+        // Cust
+          item = index_read(_wl->i_customer_id, custKey(o_c_id, d, w_id), part_id_w);
+          rc2 = get_lock((row_t *) item->location, WR);
+          if(rc2 != RCOK)
+            rc = rc2;
+        }
+      }
+      break;
+    case TPCC_STOCK_LEVEL:
+      if(GET_NODE_ID(part_id_w) == g_node_id) {
+      // Dist
+        item = index_read(_wl->i_district, distKey(d_id, w_id), part_id_w);
+        row = (row_t *) item->location;
+        rc2 = get_lock(row, RD);
+        if(rc2 != RCOK)
+          rc = rc2;
+        row->get_value(D_NEXT_O_ID, end_o_id);
+        cur_o_id = end_o_id > STOCK_LEVEL_ORDERS ? end_o_id - STOCK_LEVEL_ORDERS : 1;
+      // Stock
+        for(uint64_t o_id = cur_o_id; o_id < end_o_id; o_id++) {
+          item = index_read(_wl->i_orderline, orderlineKey(w_id, d_id, o_id), part_id_w, 0);
+          for(; item != NULL; item = item->next) {
+            uint64_t ol_i_id;
+            ((row_t *) item->location)->get_value(OL_I_ID, ol_i_id);
+            itemid_t * s_item = index_read(_wl->i_stock, stockKey(ol_i_id, w_id), part_id_w);
+            rc2 = get_lock((row_t *) s_item->location, RD);
+            if(rc2 != RCOK)
+              rc = rc2;
+          }
+        }
+      }
+      break;
     default: assert(false);
   }
   if(decr_lr() == 0) {
@@ -313,6 +441,84 @@ void TPCCTxnManager::next_tpcc_state() {
         state = TPCC_FIN;
       }
       break;
+    case TPCC_ORDERSTATUS_S:
+      state = TPCC_ORDERSTATUS0;
+      break;
+    case TPCC_ORDERSTATUS0:
+      state = TPCC_ORDERSTATUS1;
+      break;
+    case TPCC_ORDERSTATUS1:
+      state = TPCC_ORDERSTATUS2;
+      break;
+    case TPCC_ORDERSTATUS2:
+      // the customer has no order
+      if(row == NULL)
+        state = TPCC_FIN;
+      else
+        state = TPCC_ORDERSTATUS3;
+      break;
+    case TPCC_ORDERSTATUS3:
+    case TPCC_ORDERSTATUS5: // loop pt
+      if(next_ol_item == NULL)
+        state = TPCC_FIN;
+      else
+        state = TPCC_ORDERSTATUS4;
+      break;
+    case TPCC_ORDERSTATUS4:
+      state = TPCC_ORDERSTATUS5;
+      break;
+    case TPCC_DELIVERY_S:
+      state = TPCC_DELIVERY0;
+      break;
+    case TPCC_DELIVERY0: // loop pt over districts
+      // no new order to deliver in this district
+      if(row == NULL)
+        next_district();
+      else
+        state = TPCC_DELIVERY1;
+      break;
+    case TPCC_DELIVERY1:
+      // lost the new order to another delivery, try the next one
+      if(cur_o_id == 0)
+        state = TPCC_DELIVERY0;
+      else
+        state = TPCC_DELIVERY2;
+      break;
+    case TPCC_DELIVERY2:
+      state = TPCC_DELIVERY3;
+      break;
+    case TPCC_DELIVERY3:
+    case TPCC_DELIVERY5: // loop pt over order lines
+      if(next_ol_item == NULL)
+        state = TPCC_DELIVERY6;
+      else
+        state = TPCC_DELIVERY4;
+      break;
+    case TPCC_DELIVERY4:
+      state = TPCC_DELIVERY5;
+      break;
+    case TPCC_DELIVERY6:
+      state = TPCC_DELIVERY7;
+      break;
+    case TPCC_DELIVERY7:
+      next_district();
+      break;
+    case TPCC_STOCKLEVEL_S:
+      state = TPCC_STOCKLEVEL0;
+      break;
+    case TPCC_STOCKLEVEL0:
+      state = TPCC_STOCKLEVEL1;
+      break;
+    case TPCC_STOCKLEVEL1:
+    case TPCC_STOCKLEVEL3: // loop pt
+      if(next_ol_item == NULL)
+        state = TPCC_FIN;
+      else
+        state = TPCC_STOCKLEVEL2;
+      break;
+    case TPCC_STOCKLEVEL2:
+      state = TPCC_STOCKLEVEL3;
+      break;
     case TPCC_FIN:
       break;
     default:
@@ -321,6 +527,13 @@ void TPCCTxnManager::next_tpcc_state() {
 
 }
 
+void TPCCTxnManager::next_district() {
+  if(++next_d_id > g_dist_per_wh)
+    state = TPCC_FIN;
+  else
+    state = TPCC_DELIVERY0;
+}
+
 bool TPCCTxnManager::is_local_item(uint64_t idx) {
   TPCCQuery* tpcc_query = (TPCCQuery*) query;
 	uint64_t ol_supply_w_id = tpcc_query->items[idx]->ol_supply_w_id;
@@ -345,6 +558,10 @@ RC TPCCTxnManager::send_remote_request() {
   } else if(state == TPCC_NEWORDER0) {
     dest_node_id = GET_NODE_ID(wh_to_part(w_id));
     next_state = TPCC_NEWORDER6;
+  } else if(state == TPCC_ORDERSTATUS0 || state == TPCC_DELIVERY0 || state == TPCC_STOCKLEVEL0) {
+    // the whole txn runs at the home warehouse
+    dest_node_id = GET_NODE_ID(wh_to_part(w_id));
+    next_state = TPCC_FIN;
   } else if(state == TPCC_NEWORDER8) {
     dest_node_id = GET_NODE_ID(wh_to_part(tpcc_query->items[next_item_id]->ol_supply_w_id));
     /*
@@ -370,7 +587,7 @@ RC TPCCTxnManager::send_remote_request() {
 void TPCCTxnManager::copy_remote_items(TPCCQueryMessage * msg) {
   TPCCQuery* tpcc_query = (TPCCQuery*) query;
   msg->items.init(tpcc_query->items.size());
-  if(tpcc_query->txn_type == TPCC_PAYMENT)
+  if(tpcc_query->txn_type != TPCC_NEW_ORDER)
     return;
   uint64_t dest_node_id = GET_NODE_ID(wh_to_part(tpcc_query->items[next_item_id]->ol_supply_w_id));
   while(next_item_id < tpcc_query->items.size() && !is_local_item(next_item_id) && GET_NODE_ID(wh_to_part(tpcc_query->items[next_item_id]->ol_supply_w_id)) == dest_node_id) {
@@ -406,6 +623,8 @@ RC TPCCTxnManager::run_txn_state() {
     uint64_t ol_number = next_item_id;
     uint64_t ol_amount = tpcc_query->ol_amount;
     uint64_t o_id = tpcc_query->o_id;
+    uint64_t o_carrier_id = tpcc_query->o_carrier_id;
+    uint64_t threshold = tpcc_query->threshold;
 
     uint64_t part_id_w = wh_to_part(w_id);
     uint64_t part_id_c_w = wh_to_part(c_w_id);
@@ -482,6 +701,72 @@ RC TPCCTxnManager::run_txn_state() {
 		case TPCC_NEWORDER9 :
             rc = new_order_9( w_id, d_id, remote, ol_i_id, ol_supply_w_id, ol_quantity,  ol_number, ol_amount, o_id, row);
             break;
+		case TPCC_ORDERSTATUS0 :
+            if(w_loc)
+                rc = run_order_status_0(w_id, d_id, c_id, c_last, by_last_name, row);
+            else {
+                rc = send_remote_request();
+            }
+            break;
+		case TPCC_ORDERSTATUS1 :
+            rc = run_order_status_1(row);
+            break;
+		case TPCC_ORDERSTATUS2 :
+            rc = run_order_status_2(w_id, d_id, row);
+            break;
+		case TPCC_ORDERSTATUS3 :
+            rc = run_order_status_3(w_id, d_id, row);
+            break;
+		case TPCC_ORDERSTATUS4 :
+            rc = run_order_status_4(row);
+            break;
+		case TPCC_ORDERSTATUS5 :
+            rc = run_order_status_5(row);
+            break;
+		case TPCC_DELIVERY0 :
+            if(w_loc)
+                rc = run_delivery_0(w_id, next_d_id, row);
+            else {
+                rc = send_remote_request();
+            }
+            break;
+		case TPCC_DELIVERY1 :
+            rc = run_delivery_1(w_id, next_d_id, row);
+            break;
+		case TPCC_DELIVERY2 :
+            rc = run_delivery_2(w_id, next_d_id, row);
+            break;
+		case TPCC_DELIVERY3 :
+            rc = run_delivery_3(w_id, next_d_id, o_carrier_id, row);
+            break;
+		case TPCC_DELIVERY4 :
+            rc = run_delivery_4(row);
+            break;
+		case TPCC_DELIVERY5 :
+            rc = run_delivery_5(row);
+            break;
+		case TPCC_DELIVERY6 :
+            rc = run_delivery_6(w_id, next_d_id, row);
+            break;
+		case TPCC_DELIVERY7 :
+            rc = run_delivery_7(row);
+            break;
+		case TPCC_STOCKLEVEL0 :
+            if(w_loc)
+                rc = run_stock_level_0(w_id, d_id, row);
+            else {
+                rc = send_remote_request();
+            }
+            break;
+		case TPCC_STOCKLEVEL1 :
+            rc = run_stock_level_1(w_id, d_id, row);
+            break;
+		case TPCC_STOCKLEVEL2 :
+            rc = run_stock_level_2(w_id, row);
+            break;
+		case TPCC_STOCKLEVEL3 :
+            rc = run_stock_level_3(w_id, d_id, threshold, row);
+            break;
     case TPCC_FIN :
         state = TPCC_FIN;
         if(tpcc_query->rbk)
@@ -777,8 +1062,8 @@ inline RC TPCCTxnManager::new_order_5(uint64_t w_id, uint64_t d_id, uint64_t c_i
 	//int64_t o_id;
 	//d_tax = *(double *) r_dist_local->get_value(D_TAX);
 	*o_id = *(int64_t *) r_dist_local->get_value(D_NEXT_O_ID);
-	(*o_id) ++;
-	r_dist_local->set_value(D_NEXT_O_ID, *o_id);
+	uint64_t d_next_o_id = *o_id + 1;
+	r_dist_local->set_value(D_NEXT_O_ID, d_next_o_id);
 
 	// return o_id
 	/*========================================================================================+
@@ -797,6 +1082,8 @@ inline RC TPCCTxnManager::new_order_5(uint64_t w_id, uint64_t d_id, uint64_t c_i
 	int64_t all_local = (remote? 0 : 1);
 	r_order->set_value(O_ALL_LOCAL, all_local);
 	insert_row(r_order, _wl->t_order);
+	index_insert(_wl->i_order, orderPrimaryKey(w_id, d_id, *o_id), r_order, wh_to_part(w_id));
+	index_insert(_wl->i_order_cust, custKey(c_id, d_id, w_id), r_order, wh_to_part(w_id));
 	/*=======================================================+
     EXEC SQL INSERT INTO NEW_ORDER (no_o_id, no_d_id, no_w_id)
         VALUES (:o_id, :d_id, :w_id);
@@ -807,6 +1094,7 @@ inline RC TPCCTxnManager::new_order_5(uint64_t w_id, uint64_t d_id, uint64_t c_i
 	r_no->set_value(NO_D_ID, d_id);
 	r_no->set_value(NO_W_ID, w_id);
 	insert_row(r_no, _wl->t_neworder);
+	index_insert(_wl->i_neworder, orderPrimaryKey(w_id, d_id, *o_id), r_no, wh_to_part(w_id));
 
 	return RCOK;
 }
@@ -928,11 +1216,314 @@ inline RC TPCCTxnManager::new_order_9(uint64_t w_id,uint64_t  d_id,bool remote,
 		r_ol->set_value(OL_AMOUNT, &ol_amount);
 #endif		
 		insert_row(r_ol, _wl->t_orderline);
+		// XXX: a line supplied by a remote node is only indexed there
+		index_insert(_wl->i_orderline, orderlineKey(w_id, d_id, o_id), r_ol, wh_to_part(w_id));
 
 	return RCOK;
 }
 
 
+row_t * TPCCTxnManager::find_customer(uint64_t c_id, uint64_t c_d_id, uint64_t c_w_id, char * c_last, bool by_last_name) {
+	itemid_t * item;
+	if (by_last_name) {
+		// same pick as run_payment_4: the middle of the customers with this name
+		item = index_read(_wl->i_customer_last, custNPKey(c_last, c_d_id, c_w_id), wh_to_part(c_w_id));
+		assert(item != NULL);
+		int cnt = 0;
+		itemid_t * it = item;
+		itemid_t * mid = item;
+		while (it != NULL) {
+			cnt ++;
+			it = it->next;
+			if (cnt % 2 == 0)
+				mid = mid->next;
+		}
+		return (row_t *) mid->location;
+	}
+	item = index_read(_wl->i_customer_id, custKey(c_id, c_d_id, c_w_id), wh_to_part(c_w_id));
+	assert(item != NULL);
+	return (row_t *) item->location;
+}
+
+void TPCCTxnManager::next_order_line(uint64_t w_id, uint64_t d_id) {
+	if (next_ol_item != NULL)
+		next_ol_item = next_ol_item->next;
+	while (next_ol_item == NULL && cur_o_id < end_o_id) {
+		next_ol_item = index_read(_wl->i_orderline, orderlineKey(w_id, d_id, cur_o_id), wh_to_part(w_id), 0);
+		cur_o_id ++;
+	}
+}
+
+// order_status 0
+inline RC TPCCTxnManager::run_order_status_0(uint64_t w_id, uint64_t d_id, uint64_t c_id, char * c_last, bool by_last_name, row_t *& r_cust_local) {
+	/*=====================================================================+
+		EXEC SQL SELECT c_balance, c_first, c_middle, c_last
+		INTO :c_balance, :c_first, :c_middle, :c_last
+		FROM customer
+		WHERE c_id=:c_id AND c_d_id=:d_id AND c_w_id=:w_id;
+	+======================================================================*/
+	row_t * r_cust = find_customer(c_id, d_id, w_id, c_last, by_last_name);
+	RC rc = get_row(r_cust, RD, r_cust_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_order_status_1(row_t * r_cust_local) {
+	assert(r_cust_local != NULL);
+	double c_balance;
+	r_cust_local->get_value(C_BALANCE, c_balance);
+	r_cust_local->get_value(C_ID, cur_c_id);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::run_order_status_2(uint64_t w_id, uint64_t d_id, row_t *& r_order_local) {
+	/*=====================================================================+
+		EXEC SQL SELECT o_id, o_carrier_id, o_entry_d
+		INTO :o_id, :o_carrier_id, :entdate
+		FROM orders
+		ORDER BY o_id DESC;
+	+======================================================================*/
+	itemid_t * item = NULL;
+#if CC_ALG == CALVIN
+	// the order locked by acquire_locks
+	if (cur_o_id != 0)
+		item = index_read(_wl->i_order, orderPrimaryKey(w_id, d_id, cur_o_id), wh_to_part(w_id), 0);
+#else
+	// the orders of a customer are chained newest first
+	item = index_read(_wl->i_order_cust, custKey(cur_c_id, d_id, w_id), wh_to_part(w_id), 0);
+#endif
+	if (item == NULL) {
+		r_order_local = NULL;
+		return RCOK;
+	}
+	row_t * r_order = (row_t *) item->location;
+	RC rc = get_row(r_order, RD, r_order_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_order_status_3(uint64_t w_id, uint64_t d_id, row_t * r_order_local) {
+	assert(r_order_local != NULL);
+	uint64_t o_entry_d;
+	uint64_t o_carrier_id;
+	r_order_local->get_value(O_ID, cur_o_id);
+	r_order_local->get_value(O_ENTRY_D, o_entry_d);
+	r_order_local->get_value(O_CARRIER_ID, o_carrier_id);
+	/*=====================================================================+
+		EXEC SQL DECLARE c_line CURSOR FOR
+		SELECT ol_i_id, ol_supply_w_id, ol_quantity, ol_amount, ol_delivery_d
+		FROM order_line
+		WHERE ol_o_id=:o_id AND ol_d_id=:d_id AND ol_w_id=:w_id;
+		EXEC SQL OPEN c_line;
+	+======================================================================*/
+	next_ol_item = index_read(_wl->i_orderline, orderlineKey(w_id, d_id, cur_o_id), wh_to_part(w_id), 0);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::run_order_status_4(row_t *& r_ol_local) {
+	assert(next_ol_item != NULL);
+	row_t * r_ol = (row_t *) next_ol_item->location;
+	RC rc = get_row(r_ol, RD, r_ol_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_order_status_5(row_t * r_ol_local) {
+	assert(r_ol_local != NULL);
+	uint64_t ol_i_id;
+	uint64_t ol_supply_w_id;
+	uint64_t ol_quantity;
+	double ol_amount;
+	int64_t ol_delivery_d;
+	r_ol_local->get_value(OL_I_ID, ol_i_id);
+	r_ol_local->get_value(OL_SUPPLY_W_ID, ol_supply_w_id);
+	r_ol_local->get_value(OL_QUANTITY, ol_quantity);
+	r_ol_local->get_value(OL_AMOUNT, ol_amount);
+	r_ol_local->get_value(OL_DELIVERY_D, ol_delivery_d);
+	next_ol_item = next_ol_item->next;
+	return RCOK;
+}
+
+// delivery 0
+inline RC TPCCTxnManager::run_delivery_0(uint64_t w_id, uint64_t d_id, row_t *& r_no_local) {
+	/*=====================================================================+
+		EXEC SQL DECLARE c_no CURSOR FOR
+		SELECT no_o_id
+		FROM new_order
+		WHERE no_d_id = :d_id AND no_w_id = :w_id
+		ORDER BY no_o_id ASC;
+		EXEC SQL OPEN c_no;
+		EXEC SQL FETCH c_no INTO :no_o_id;
+	+======================================================================*/
+#if CC_ALG == CALVIN
+	cur_o_id = dlv_o_id[d_id];
+#else
+	cur_o_id = _wl->no_o_id_hint[distKey(d_id, w_id)];
+#endif
+	itemid_t * item = NULL;
+	if (cur_o_id != 0)
+		item = index_read(_wl->i_neworder, orderPrimaryKey(w_id, d_id, cur_o_id), wh_to_part(w_id), 0);
+	if (item == NULL) {
+		r_no_local = NULL;
+		return RCOK;
+	}
+	row_t * r_no = (row_t *) item->location;
+	RC rc = get_row(r_no, WR, r_no_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_delivery_1(uint64_t w_id, uint64_t d_id, row_t * r_no_local) {
+	assert(r_no_local != NULL);
+	/*=====================================================================+
+		EXEC SQL DELETE FROM new_order WHERE CURRENT OF c_no;
+	+======================================================================*/
+	uint64_t no_o_id;
+	r_no_local->get_value(NO_O_ID, no_o_id);
+	if (no_o_id == 0) {
+		// delivered by a txn that committed after we read the hint
+		assert(CC_ALG != CALVIN);
+		ATOM_CAS(_wl->no_o_id_hint[distKey(d_id, w_id)], cur_o_id, cur_o_id + 1);
+		cur_o_id = 0;
+		return RCOK;
+	}
+#if CC_ALG != CALVIN
+	// the hint moves past it once we commit; [CALVIN] acquire_locks already moved it
+	dlv_o_id[d_id] = cur_o_id;
+#endif
+	// rows are never removed from the indexes; a zero o_id marks a deleted new-order
+	no_o_id = 0;
+	r_no_local->set_value(NO_O_ID, no_o_id);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::run_delivery_2(uint64_t w_id, uint64_t d_id, row_t *& r_order_local) {
+	/*=====================================================================+
+		EXEC SQL SELECT o_c_id INTO :c_id FROM orders
+		WHERE o_id = :no_o_id AND o_d_id = :d_id AND o_w_id = :w_id;
+		EXEC SQL UPDATE orders SET o_carrier_id = :o_carrier_id
+		WHERE o_id = :no_o_id AND o_d_id = :d_id AND o_w_id = :w_id;
+	+======================================================================*/
+	itemid_t * item = index_read(_wl->i_order, orderPrimaryKey(w_id, d_id, cur_o_id), wh_to_part(w_id));
+	assert(item != NULL);
+	row_t * r_order = (row_t *) item->location;
+	RC rc = get_row(r_order, WR, r_order_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_delivery_3(uint64_t w_id, uint64_t d_id, uint64_t o_carrier_id, row_t * r_order_local) {
+	assert(r_order_local != NULL);
+	r_order_local->get_value(O_C_ID, cur_c_id);
+	r_order_local->set_value(O_CARRIER_ID, o_carrier_id);
+	/*=====================================================================+
+		EXEC SQL UPDATE order_line SET ol_delivery_d = :datetime
+		WHERE ol_o_id = :no_o_id AND ol_d_id = :d_id AND ol_w_id = :w_id;
+		EXEC SQL SELECT SUM(ol_amount) INTO :ol_total FROM order_line
+		WHERE ol_o_id = :no_o_id AND ol_d_id = :d_id AND ol_w_id = :w_id;
+	+======================================================================*/
+	ol_total = 0;
+	next_ol_item = index_read(_wl->i_orderline, orderlineKey(w_id, d_id, cur_o_id), wh_to_part(w_id), 0);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::run_delivery_4(row_t *& r_ol_local) {
+	assert(next_ol_item != NULL);
+	row_t * r_ol = (row_t *) next_ol_item->location;
+	RC rc = get_row(r_ol, WR, r_ol_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_delivery_5(row_t * r_ol_local) {
+	assert(r_ol_local != NULL);
+	double ol_amount;
+	r_ol_local->get_value(OL_AMOUNT, ol_amount);
+	ol_total += ol_amount;
+	int64_t date = 2013;
+	r_ol_local->set_value(OL_DELIVERY_D, date);
+	next_ol_item = next_ol_item->next;
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::run_delivery_6(uint64_t w_id, uint64_t d_id, row_t *& r_cust_local) {
+	/*=====================================================================+
+		EXEC SQL UPDATE customer SET c_balance = c_balance + :ol_total,
+		c_delivery_cnt = c_delivery_cnt + 1
+		WHERE c_id = :c_id AND c_d_id = :d_id AND c_w_id = :w_id;
+	+======================================================================*/
+	itemid_t * item = index_read(_wl->i_customer_id, custKey(cur_c_id, d_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	row_t * r_cust = (row_t *) item->location;
+	RC rc = get_row(r_cust, WR, r_cust_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_delivery_7(row_t * r_cust_local) {
+	assert(r_cust_local != NULL);
+	double c_balance;
+	uint64_t c_delivery_cnt;
+	r_cust_local->get_value(C_BALANCE, c_balance);
+	r_cust_local->set_value(C_BALANCE, c_balance + ol_total);
+	r_cust_local->get_value(C_DELIVERY_CNT, c_delivery_cnt);
+	r_cust_local->set_value(C_DELIVERY_CNT, c_delivery_cnt + 1);
+	return RCOK;
+}
+
+// stock_level 0
+inline RC TPCCTxnManager::run_stock_level_0(uint64_t w_id, uint64_t d_id, row_t *& r_dist_local) {
+	/*=====================================================================+
+		EXEC SQL SELECT d_next_o_id INTO :o_id
+		FROM district
+		WHERE d_w_id=:w_id AND d_id=:d_id;
+	+======================================================================*/
+	itemid_t * item = index_read(_wl->i_district, distKey(d_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	row_t * r_dist = (row_t *) item->location;
+	RC rc = get_row(r_dist, RD, r_dist_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_stock_level_1(uint64_t w_id, uint64_t d_id, row_t * r_dist_local) {
+	assert(r_dist_local != NULL);
+	// [CALVIN] keeps the range of orders acquire_locks locked
+#if CC_ALG != CALVIN
+	r_dist_local->get_value(D_NEXT_O_ID, end_o_id);
+	cur_o_id = end_o_id > STOCK_LEVEL_ORDERS ? end_o_id - STOCK_LEVEL_ORDERS : 1;
+#endif
+	/*=====================================================================+
+		EXEC SQL SELECT COUNT(DISTINCT (s_i_id)) INTO :stock_count
+		FROM order_line, stock
+		WHERE ol_w_id=:w_id AND ol_d_id=:d_id AND ol_o_id<:o_id AND
+		ol_o_id>=:o_id-20 AND s_w_id=:w_id AND
+		s_i_id=ol_i_id AND s_quantity < :threshold;
+	+======================================================================*/
+	next_ol_item = NULL;
+	next_order_line(w_id, d_id);
+	return RCOK;
+}
+
+inline RC TPCCTxnManager::run_stock_level_2(uint64_t w_id, row_t *& r_stock_local) {
+	assert(next_ol_item != NULL);
+	// ol_i_id never changes once the line is inserted, so it is read
+	// from the base row without going through the CC
+	uint64_t ol_i_id;
+	((row_t *) next_ol_item->location)->get_value(OL_I_ID, ol_i_id);
+	itemid_t * item = index_read(_wl->i_stock, stockKey(ol_i_id, w_id), wh_to_part(w_id));
+	assert(item != NULL);
+	row_t * r_stock = (row_t *) item->location;
+	RC rc = get_row(r_stock, RD, r_stock_local);
+	return rc;
+}
+
+inline RC TPCCTxnManager::run_stock_level_3(uint64_t w_id, uint64_t d_id, uint64_t threshold, row_t * r_stock_local) {
+	assert(r_stock_local != NULL);
+	uint64_t s_quantity;
+	r_stock_local->get_value(S_QUANTITY, s_quantity);
+	if (s_quantity < threshold) {
+		uint64_t s_i_id;
+		r_stock_local->get_value(S_I_ID, s_i_id);
+		low_stock_items.insert(s_i_id);
+		stock_count = low_stock_items.size();
+	}
+	next_order_line(w_id, d_id);
+	return RCOK;
+}
+
 RC TPCCTxnManager::run_calvin_txn() {
   RC rc = RCOK;
   uint64_t starttime = get_sys_clock();
@@ -1055,6 +1646,11 @@ RC TPCCTxnManager::run_tpcc_phase2() {
           }
         }
         break;
+		case TPCC_ORDER_STATUS :
+		case TPCC_DELIVERY :
+		case TPCC_STOCK_LEVEL :
+      // single-node txns; all the work is done in phase 5
+      break;
     default: assert(false);
   }
   return rc;
@@ -1100,7 +1696,8 @@ RC TPCCTxnManager::run_tpcc_phase5() {
       break;
 		case TPCC_NEW_ORDER :
       if(w_loc) {
-        //rc = new_order_4( w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row); 
+        // row holds the last row read in phase 2, not the district
+        rc = new_order_4( w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row); 
         rc = new_order_5( w_id, d_id, c_id, remote, ol_cnt, o_entry_d, &tpcc_query->o_id, row); 
       }
         for(uint64_t i = 0; i < tpcc_query->ol_cnt; i++) {
@@ -1118,6 +1715,48 @@ RC TPCCTxnManager::run_tpcc_phase5() {
           }
         }
         break;
+		case TPCC_ORDER_STATUS :
+      if(w_loc) {
+        rc = run_order_status_0(w_id, d_id, c_id, c_last, by_last_name, row);
+        rc = run_order_status_1(row);
+        rc = run_order_status_2(w_id, d_id, row);
+        if(row == NULL)
+          break;
+        rc = run_order_status_3(w_id, d_id, row);
+        while(next_ol_item != NULL) {
+          rc = run_order_status_4(row);
+          rc = run_order_status_5(row);
+        }
+      }
+      break;
+		case TPCC_DELIVERY :
+      if(w_loc) {
+        for(next_d_id = 1; next_d_id <= g_dist_per_wh; next_d_id++) {
+          rc = run_delivery_0(w_id, next_d_id, row);
+          if(row == NULL)
+            continue;
+          rc = run_delivery_1(w_id, next_d_id, row);
+          rc = run_delivery_2(w_id, next_d_id, row);
+          rc = run_delivery_3(w_id, next_d_id, tpcc_query->o_carrier_id, row);
+          while(next_ol_item != NULL) {
+            rc = run_delivery_4(row);
+            rc = run_delivery_5(row);
+          }
+          rc = run_delivery_6(w_id, next_d_id, row);
+          rc = run_delivery_7(row);
+        }
+      }
+      break;
+		case TPCC_STOCK_LEVEL :
+      if(w_loc) {
+        rc = run_stock_level_0(w_id, d_id, row);
+        rc = run_stock_level_1(w_id, d_id, row);
+        while(next_ol_item != NULL) {
+          rc = run_stock_level_2(w_id, row);
+          rc = run_stock_level_3(w_id, d_id, tpcc_query->threshold, row);
+        }
+      }
+      break;
     default: assert(false);
   }
   return rc;
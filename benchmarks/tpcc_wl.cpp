@@ -21,14 +21,21 @@
 #include "thread.h"
 #include "table.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "index_btree.h"
 #include "tpcc_helper.h"
 #include "row.h"
 #include "query.h"
 #include "txn.h"
 #include "mem_alloc.h"
+#include "checkpoint.h"
 #include "tpcc_const.h"
 
+// The last 900 of the 3000 orders loaded per district are not delivered yet
+static uint64_t first_new_order() {
+	return g_cust_per_dist - g_cust_per_dist * 3 / 10 + 1;
+}
+
 RC TPCCWorkload::init() {
 	Workload::init();
 	//char * cpath = getenv("GRAPHITE_HOME");
@@ -47,9 +54,10 @@ RC TPCCWorkload::init() {
 	path += "TPCC_full_schema.txt";
 #endif
 	cout << "reading schema file: " << path << endl;
-	delivering = new bool * [g_num_wh + 1];
-	for (UInt32 wid = 1; wid <= g_num_wh; wid ++)
-		delivering[wid] = (bool *) mem_allocator.alloc(CL_SIZE);
+	uint64_t dist_cnt = distKey(g_dist_per_wh, g_num_wh) + 1;
+	no_o_id_hint = new uint64_t [dist_cnt];
+	for (uint64_t i = 0; i < dist_cnt; i++)
+		no_o_id_hint[i] = first_new_order();
 	
   printf("Initializing schema... ");
   fflush(stdout);
@@ -57,7 +65,10 @@ RC TPCCWorkload::init() {
   printf("Done\n");
   printf("Initializing table... ");
   fflush(stdout);
-	init_table();
+	if (checkpointer.load_tables(this) != RCOK) {
+		init_table();
+		checkpointer.save_snapshot(this);
+	}
   printf("Done\n");
   fflush(stdout);
 	return RCOK;
@@ -81,8 +92,10 @@ RC TPCCWorkload::init_schema(const char * schema_file) {
 	i_customer_id = indexes["CUSTOMER_ID_IDX"];
 	i_customer_last = indexes["CUSTOMER_LAST_IDX"];
 	i_stock = indexes["STOCK_IDX"];
-//	i_order = indexes["ORDER_IDX"];
-//	i_orderline = indexes["ORDER-LINE_IDX"];
+	i_neworder = indexes["NEW-ORDER_IDX"];
+	i_order = indexes["ORDER_IDX"];
+	i_order_cust = indexes["ORDER_CUST_IDX"];
+	i_orderline = indexes["ORDER-LINE_IDX"];
 	return RCOK;
 }
 
@@ -152,7 +165,6 @@ RC TPCCWorkload::init_table() {
   fflush(stdout);
 
   // Order Table
-  /*
 	for (UInt32 i = 0; i < g_init_parallelism - 1; i++) {
     pthread_create(&p_thds[i], NULL, threadInitOrder, &tt[i]);
 	}
@@ -166,7 +178,6 @@ RC TPCCWorkload::init_table() {
   }
   printf("ORDER Done\n");
   fflush(stdout);
-  */
 	threadInitWh(this);
   printf("WAREHOUSE Done\n");
   fflush(stdout);
@@ -307,7 +318,7 @@ void TPCCWorkload::init_tab_dist(uint64_t wid) {
     	double w_ytd=30000.00;
 		row->set_value(D_TAX, tax);
 		row->set_value(D_YTD, w_ytd);
-		row->set_value(D_NEXT_O_ID, 3001);
+		row->set_value(D_NEXT_O_ID, (uint64_t) g_cust_per_dist + 1);
 		
 		index_insert(i_district, distKey(did, wid), row, wh_to_part(wid));
 	}
@@ -417,6 +428,7 @@ void TPCCWorkload::init_tab_cust(int id, uint64_t did, uint64_t wid) {
 		row->set_value(C_BALANCE, -10.0);
 		row->set_value(C_YTD_PAYMENT, 10.0);
 		row->set_value(C_PAYMENT_CNT, 1);
+		row->set_value(C_DELIVERY_CNT, (uint64_t) 0);
 		uint64_t key;
 		key = custNPKey(c_last, did, wid);
 		index_insert(i_customer_last, key, row, wh_to_part(wid));
@@ -445,73 +457,73 @@ void TPCCWorkload::init_tab_hist(uint64_t c_id, uint64_t d_id, uint64_t w_id) {
 
 }
 
-void TPCCWorkload::init_tab_order(int id, uint64_t did, uint64_t wid) {
-	init_permutation(); /* initialize permutation of customer numbers */
-	for (UInt32 oid = id+1; oid <= g_cust_per_dist; oid+=g_init_parallelism) {
+void TPCCWorkload::init_tab_order(uint64_t did, uint64_t wid) {
+	uint64_t * perm_c_id = new uint64_t[g_cust_per_dist];
+	init_permutation(perm_c_id); /* initialize permutation of customer numbers */
+	uint64_t part_id = wh_to_part(wid);
+	for (uint64_t oid = 1; oid <= g_cust_per_dist; oid++) {
 		row_t * row;
 		uint64_t row_id;
 		t_order->get_new_row(row, 0, row_id);
 		row->set_primary_key(oid);
 		uint64_t o_ol_cnt = 1;
-		uint64_t cid = get_permutation();
+		uint64_t cid = perm_c_id[oid - 1];
 		row->set_value(O_ID, oid);
 		row->set_value(O_C_ID, cid);
 		row->set_value(O_D_ID, did);
 		row->set_value(O_W_ID, wid);
 		uint64_t o_entry = 2013;
 		row->set_value(O_ENTRY_D, o_entry);
-		if (oid < 2101)
+		if (oid < first_new_order())
 			row->set_value(O_CARRIER_ID, URand(1, 10));
 		else 
-			row->set_value(O_CARRIER_ID, 0);
+			row->set_value(O_CARRIER_ID, (uint64_t) 0);
 		o_ol_cnt = URand(5, 15);
 		row->set_value(O_OL_CNT, o_ol_cnt);
-		row->set_value(O_ALL_LOCAL, 1);
+		row->set_value(O_ALL_LOCAL, (uint64_t) 1);
 		
 		// Insert to indexes
-//		uint64_t key = custKey(cid, did, wid);
-//		index_insert(i_order_wdc, key, row, wh_to_part(wid));
-
-//		key = orderPrimaryKey(wid, did, oid);
-//		index_insert(i_order_wdo, key, row, wh_to_part(wid));
+		uint64_t key = orderPrimaryKey(wid, did, oid);
+		index_insert(i_order, key, row, part_id);
+		key = custKey(cid, did, wid);
+		index_insert(i_order_cust, key, row, part_id);
 
 		// ORDER-LINE	
-#if !TPCC_SMALL
 		for (uint64_t ol = 1; ol <= o_ol_cnt; ol++) {
 			t_orderline->get_new_row(row, 0, row_id);
 			row->set_value(OL_O_ID, oid);
 			row->set_value(OL_D_ID, did);
 			row->set_value(OL_W_ID, wid);
 			row->set_value(OL_NUMBER, ol);
-			row->set_value(OL_I_ID, URand(1, 100000));
+			row->set_value(OL_I_ID, URand(1, g_max_items));
 			row->set_value(OL_SUPPLY_W_ID, wid);
-			if (oid < 2101) {
+			if (oid < first_new_order()) {
 				row->set_value(OL_DELIVERY_D, o_entry);
-				row->set_value(OL_AMOUNT, 0);
+				row->set_value(OL_AMOUNT, 0.0);
 			} else {
-				row->set_value(OL_DELIVERY_D, 0);
+				row->set_value(OL_DELIVERY_D, (uint64_t) 0);
 				row->set_value(OL_AMOUNT, (double)URand(1, 999999)/100);
 			}
-			row->set_value(OL_QUANTITY, 5);
+			row->set_value(OL_QUANTITY, (uint64_t) 5);
+#if !TPCC_SMALL
 			char ol_dist_info[24];
 	        MakeAlphaString(24, 24, ol_dist_info);
 			row->set_value(OL_DIST_INFO, ol_dist_info);
+#endif
 
-//			uint64_t key = orderlineKey(wid, did, oid);
-//			index_insert(i_orderline, key, row, wh_to_part(wid));
-			
-//			key = distKey(did, wid);
-//			index_insert(i_orderline_wd, key, row, wh_to_part(wid));
+			// lines of an order share its key
+			index_insert(i_orderline, orderlineKey(wid, did, oid), row, part_id);
 		}
-#endif
 		// NEW ORDER
-		if (oid > 2100) {
+		if (oid >= first_new_order()) {
 			t_neworder->get_new_row(row, 0, row_id);
 			row->set_value(NO_O_ID, oid);
 			row->set_value(NO_D_ID, did);
 			row->set_value(NO_W_ID, wid);
+			index_insert(i_neworder, orderPrimaryKey(wid, did, oid), row, part_id);
 		}
 	}
+	delete [] perm_c_id;
 }
 
 /*==================================================================+
@@ -519,10 +531,8 @@ void TPCCWorkload::init_tab_order(int id, uint64_t did, uint64_t wid) {
 | InitPermutation
 +==================================================================*/
 
-void TPCCWorkload::init_permutation() {
+void TPCCWorkload::init_permutation(uint64_t * perm_c_id) {
 	UInt32 i;
-	perm_count = 0;
-	perm_c_id = new uint64_t[g_cust_per_dist];
 	// Init with consecutive values
 	for(i = 0; i < g_cust_per_dist; i++) {
 		perm_c_id[i] = i+1;
@@ -538,20 +548,6 @@ void TPCCWorkload::init_permutation() {
 	return;
 }
 
-
-/*==================================================================+
-| ROUTINE NAME
-| GetPermutation
-+==================================================================*/
-
-uint64_t TPCCWorkload::get_permutation() {
-	if(perm_count >= g_cust_per_dist) {
-		// wrapped around, restart at 0
-		perm_count = 0;
-	}
-	return (uint64_t) perm_c_id[perm_count++];
-}
-
 void * TPCCWorkload::threadInitItem(void * This) {
   TPCCWorkload * wl = ((thr_args*) This)->wl;
   int id = ((thr_args*) This)->id;
@@ -623,8 +619,11 @@ void * TPCCWorkload::threadInitOrder(void * This) {
 	for (uint64_t wid = 1; wid <= g_num_wh; wid ++) {
     if(GET_NODE_ID(wh_to_part(wid)) != g_node_id) 
       continue;
-		for (uint64_t did = 1; did <= g_dist_per_wh; did++)
-			wl->init_tab_order(id,did, wid);
+		// a district is loaded by one thread so its customers are permuted
+		for (uint64_t did = 1; did <= g_dist_per_wh; did++) {
+			if (distKey(did, wid) % g_init_parallelism == (uint64_t) id)
+				wl->init_tab_order(did, wid);
+		}
   }
 	printf("ORDER Done\n");
 	return NULL;
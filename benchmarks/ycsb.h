@@ -21,6 +21,7 @@
 #include "txn.h"
 #include "global.h"
 #include "helper.h"
+#include "array.h"
 
 class YCSBQuery;
 class YCSBQueryMessage;
@@ -59,6 +60,7 @@ class YCSBTxnManager : public TxnManager
 public:
 	void init(uint64_t thd_id, Workload * h_wl);
 	void reset();
+	void release();
 	void partial_reset();
   RC acquire_locks(); 
 	RC run_txn();
@@ -71,6 +73,7 @@ private:
   RC run_ycsb_0(ycsb_request * req,row_t *& row_local);
   RC run_ycsb_1(access_t acctype, row_t * row_local);
   RC run_ycsb();
+  void scan_index(ycsb_request * req, uint64_t part_id);
   bool is_done() ;
   bool is_local_request(uint64_t idx) ;
   RC send_remote_request() ;
@@ -79,6 +82,9 @@ private:
 	YCSBWorkload * _wl;
 	YCSBRemTxnType state;
   uint64_t next_record_id;
+  // rows of the current SCAN request, and the next one to access
+  Array<itemid_t*> scan_items;
+  uint64_t next_scan_id;
 };
 
 #endif
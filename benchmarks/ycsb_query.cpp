@@ -129,7 +129,7 @@ uint64_t YCSBQuery::get_participants(Workload * wl) {
   assert(active_nodes.size()==g_node_cnt);
   for(uint64_t i = 0; i < requests.size(); i++) {
     uint64_t req_nid = GET_NODE_ID(((YCSBWorkload*)wl)->key_to_part(requests[i]->key));
-    if(requests[i]->acctype == RD) {
+    if(requests[i]->acctype == RD || requests[i]->acctype == SCAN) {
       if(participant_nodes[req_nid] == 0)
         ++participant_cnt;
       participant_nodes.set(req_nid,1);
@@ -154,12 +154,12 @@ uint64_t YCSBQuery::participants(bool *& pps,Workload * wl) {
   return n;
 }
 
-std::set<uint64_t> YCSBQuery::participants(Message * msg, Workload * wl) {
-  std::set<uint64_t> participant_set;
+uint64_t YCSBQuery::participants(Message * msg, Workload * wl) {
+  uint64_t participant_set = 0;
   YCSBClientQueryMessage* ycsb_msg = ((YCSBClientQueryMessage*)msg);
   for(uint64_t i = 0; i < ycsb_msg->requests.size(); i++) {
     uint64_t req_nid = GET_NODE_ID(((YCSBWorkload*)wl)->key_to_part(ycsb_msg->requests[i]->key));
-    participant_set.insert(req_nid);
+    participant_set |= 1UL << req_nid;
   }
   return participant_set;
 }
@@ -173,6 +173,24 @@ bool YCSBQuery::readonly() {
   return true;
 }
 
+bool YCSBQueryGenerator::gen_scan(ycsb_request * req, set<uint64_t> & all_keys, uint64_t reqs_left) {
+  // every scanned row takes an access slot in the txn
+  if (g_scan_len == 0 || all_keys.size() + g_scan_len + reqs_left > MAX_ROW_PER_TXN)
+    return false;
+  // the keys of a partition are strided by g_part_cnt
+  if (req->key + (g_scan_len - 1) * g_part_cnt >= g_synth_table_size)
+    return false;
+  for (UInt32 i = 0; i < g_scan_len; i++) {
+    if (all_keys.find(req->key + i * g_part_cnt) != all_keys.end())
+      return false;
+  }
+  for (UInt32 i = 0; i < g_scan_len; i++)
+    all_keys.insert(req->key + i * g_part_cnt);
+  req->acctype = SCAN;
+  req->scan_len = g_scan_len;
+  return true;
+}
+
 // The following algorithm comes from the paper:
 // Quickly generating billion-record synthetic databases
 // However, it seems there is a small bug. 
@@ -265,8 +283,12 @@ BaseQuery * YCSBQueryGenerator::gen_requests_hot(uint64_t home_partition_id, Wor
 		//uint64_t part_id = row_id % g_part_cnt;
 		req->key = primary_key;
 		req->value = mrand->next() % (1<<8);
+		req->scan_len = 0;
+		double r_scan = (double)(mrand->next() % 10000) / 10000;
 		// Make sure a single row is not accessed twice
-		if (all_keys.find(req->key) == all_keys.end()) {
+		if (r_scan < g_scan_perc && gen_scan(req, all_keys, g_req_per_query - rid - 1)) {
+			access_cnt += req->scan_len;
+		} else if (all_keys.find(req->key) == all_keys.end()) {
 			all_keys.insert(req->key);
 			access_cnt ++;
 		} else {
@@ -339,8 +361,12 @@ BaseQuery * YCSBQueryGenerator::gen_requests_zipf(uint64_t home_partition_id, Wo
 
 		req->key = primary_key;
 		req->value = mrand->next() % (1<<8);
+		req->scan_len = 0;
+		double r_scan = (double)(mrand->next() % 10000) / 10000;
 		// Make sure a single row is not accessed twice
-		if (all_keys.find(req->key) == all_keys.end()) {
+		if (r_scan < g_scan_perc && gen_scan(req, all_keys, g_req_per_query - rid - 1)) {
+			access_cnt += req->scan_len;
+		} else if (all_keys.find(req->key) == all_keys.end()) {
 			all_keys.insert(req->key);
 			access_cnt ++;
 		} else {
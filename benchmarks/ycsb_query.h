@@ -35,18 +35,20 @@ class YCSBClientQueryMessage;
 class ycsb_request {
 public:
   ycsb_request() {}
-  ycsb_request(const ycsb_request& req) : acctype(req.acctype), key(req.key), value(req.value) { }
+  ycsb_request(const ycsb_request& req) : acctype(req.acctype), key(req.key), value(req.value), scan_len(req.scan_len) { }
   void copy(ycsb_request * req) {
     this->acctype = req->acctype;
     this->key = req->key;
     this->value = req->value;
+    this->scan_len = req->scan_len;
   }
 //	char table_name[80];
 	access_t acctype; 
 	uint64_t key;
 	char value;
-	// only for (qtype == SCAN)
-	//UInt32 scan_len;
+	// only for (acctype == SCAN): number of rows of key's partition,
+	// starting at key, that are read
+	UInt32 scan_len;
 };
 
 class YCSBQueryGenerator : public QueryGenerator {
@@ -57,6 +59,9 @@ public:
 private:
 	BaseQuery * gen_requests_hot(uint64_t home_partition_id, Workload * h_wl);
 	BaseQuery * gen_requests_zipf(uint64_t home_partition_id, Workload * h_wl);
+	// turns req into a SCAN starting at req->key if the scanned rows exist,
+	// are not in all_keys, and fit in the txn's row budget
+	bool gen_scan(ycsb_request * req, set<uint64_t> & all_keys, uint64_t reqs_left);
 	// for Zipfian distribution
 	double zeta(uint64_t n, double theta);
 	uint64_t zipf(uint64_t n, double theta);
@@ -84,7 +89,8 @@ public:
   void release_requests();
   void reset();
   uint64_t get_participants(Workload * wl); 
-  static std::set<uint64_t> participants(Message * msg, Workload * wl); 
+  // bitmap of the nodes the txn touches
+  static uint64_t participants(Message * msg, Workload * wl); 
   static void copy_request_to_msg(YCSBQuery * ycsb_query, YCSBQueryMessage * msg, uint64_t id); 
   uint64_t participants(bool *& pps,Workload * wl); 
   bool readonly();
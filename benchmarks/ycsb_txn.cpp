@@ -23,6 +23,7 @@
 #include "table.h"
 #include "row.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "index_btree.h"
 #include "catalog.h"
 #include "manager.h"
@@ -37,15 +38,23 @@
 void YCSBTxnManager::init(uint64_t thd_id, Workload * h_wl) {
 	TxnManager::init(thd_id, h_wl);
 	_wl = (YCSBWorkload *) h_wl;
+  scan_items.init(g_scan_len);
   reset();
 }
 
 void YCSBTxnManager::reset() {
   state = YCSB_0;
   next_record_id = 0;
+  next_scan_id = 0;
+  scan_items.clear();
 	TxnManager::reset();
 }
 
+void YCSBTxnManager::release() {
+  scan_items.release();
+  TxnManager::release();
+}
+
 RC YCSBTxnManager::acquire_locks() {
   uint64_t starttime = get_sys_clock();
   assert(CC_ALG == CALVIN);
@@ -61,6 +70,16 @@ RC YCSBTxnManager::acquire_locks() {
     DEBUG("LK Acquire (%ld,%ld) %d,%ld -> %ld\n",get_txn_id(),get_batch_id(),req->acctype,req->key,GET_NODE_ID(part_id));
     if(GET_NODE_ID(part_id) != g_node_id)
       continue;
+    if(req->acctype == SCAN) {
+      scan_index(req, part_id);
+      for(uint64_t i = 0; i < scan_items.size(); i++) {
+        RC rc2 = get_lock((row_t *)scan_items[i]->location,RD);
+        if(rc2 != RCOK) {
+          rc = rc2;
+        }
+      }
+      continue;
+    }
 		INDEX * index = _wl->the_index;
 		itemid_t * item;
 		item = index_read(index, req->key, part_id);
@@ -138,6 +157,13 @@ void YCSBTxnManager::next_ycsb_state() {
       state = YCSB_1;
       break;
     case YCSB_1:
+      // a SCAN goes through YCSB_0/YCSB_1 once per scanned row
+      if(((YCSBQuery*)query)->requests[next_record_id]->acctype == SCAN
+          && ++next_scan_id < scan_items.size()) {
+        state = YCSB_0;
+        break;
+      }
+      next_scan_id = 0;
       next_record_id++;
       if(!IS_LOCAL(txn->txn_id) || !is_done()) {
         state = YCSB_0;
@@ -214,7 +240,16 @@ RC YCSBTxnManager::run_ycsb_0(ycsb_request * req,row_t *& row_local) {
 		access_t type = req->acctype;
 	  itemid_t * m_item;
 
-		m_item = index_read(_wl->the_index, req->key, part_id);
+    if(type == SCAN) {
+      // the range is resolved on its first row; CC is then acquired
+      // on each scanned row as for a read
+      if(next_scan_id == 0)
+        scan_index(req, part_id);
+      m_item = scan_items[next_scan_id];
+      type = RD;
+    } else {
+		  m_item = index_read(_wl->the_index, req->key, part_id);
+    }
 
 		row_t * row = ((row_t *)m_item->location);
 			
@@ -224,6 +259,24 @@ RC YCSBTxnManager::run_ycsb_0(ycsb_request * req,row_t *& row_local) {
 
 }
 
+void YCSBTxnManager::scan_index(ycsb_request * req, uint64_t part_id) {
+  uint64_t starttime = get_sys_clock();
+  INDEX * index = _wl->the_index;
+#if INDEX_STRUCT == IDX_BTREE
+  while(index->index_scan(req->key, req->scan_len, scan_items, part_id) != RCOK) {}
+#else
+  // hash indexes are unordered; a partition's keys are strided by g_part_cnt
+  scan_items.clear();
+  for(uint64_t i = 0; i < req->scan_len; i++) {
+    itemid_t * item;
+    index->index_read(req->key + i * g_part_cnt, item, part_id, get_thd_id());
+    scan_items.add(item);
+  }
+#endif
+  assert(scan_items.size() == req->scan_len);
+  INC_STATS(get_thd_id(),txn_index_time,get_sys_clock() - starttime);
+}
+
 RC YCSBTxnManager::run_ycsb_1(access_t acctype, row_t * row_local) {
   if (acctype == RD || acctype == SCAN) {
     int fid = 0;
@@ -333,7 +386,7 @@ RC YCSBTxnManager::run_ycsb() {
 	  ycsb_request * req = ycsb_query->requests[i];
     if(this->phase == CALVIN_LOC_RD && req->acctype == WR)
       continue;
-    if(this->phase == CALVIN_EXEC_WR && req->acctype == RD)
+    if(this->phase == CALVIN_EXEC_WR && req->acctype != WR)
       continue;
 
 		uint64_t part_id = _wl->key_to_part( req->key );
@@ -342,11 +395,14 @@ RC YCSBTxnManager::run_ycsb() {
     if(!loc)
       continue;
 
-    rc = run_ycsb_0(req,row);
-    assert(rc == RCOK);
+    do {
+      rc = run_ycsb_0(req,row);
+      assert(rc == RCOK);
 
-    rc = run_ycsb_1(req->acctype,row);
-    assert(rc == RCOK);
+      rc = run_ycsb_1(req->acctype,row);
+      assert(rc == RCOK);
+    } while(req->acctype == SCAN && ++next_scan_id < scan_items.size());
+    next_scan_id = 0;
   }
   return rc;
 
@@ -22,7 +22,9 @@
 #include "table.h"
 #include "row.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "index_btree.h"
+#include "checkpoint.h"
 #include "catalog.h"
 #include "manager.h"
 #include "row_lock.h"
@@ -52,7 +54,10 @@ RC YCSBWorkload::init() {
 	
   printf("Initializing table... ");
   fflush(stdout);
-	init_table_parallel();
+	if (checkpointer.load_tables(this) != RCOK) {
+		init_table_parallel();
+		checkpointer.save_snapshot(this);
+	}
   printf("Done\n");
   fflush(stdout);
 //	init_table();
@@ -104,8 +109,9 @@ RC YCSBWorkload::init_table() {
 				new_row->set_value(fid, value);
 			}
             itemid_t * m_item =
-                (itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
+                (itemid_t *) mem_allocator.alloc( sizeof(itemid_t), part_id);
 			assert(m_item != NULL);
+            m_item->init();
             m_item->type = DT_row;
             m_item->location = new_row;
             m_item->valid = true;
@@ -187,8 +193,9 @@ void * YCSBWorkload::init_table_slice() {
 #endif
 
 		itemid_t * m_item =
-			(itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
+			(itemid_t *) mem_allocator.alloc( sizeof(itemid_t), part_id);
 		assert(m_item != NULL);
+		m_item->init();
 		m_item->type = DT_row;
 		m_item->location = new_row;
 		m_item->valid = true;
@@ -0,0 +1,180 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "dl_detect.h"
+#include "txn.h"
+#include "row_lock.h"
+#include "message.h"
+#include "msg_queue.h"
+
+void DL_detect::init() {
+	pthread_mutex_init(&latch, NULL);
+	remote = new std::vector<uint64_t>[g_node_cnt];
+	last_detect_time = 0;
+	sent_empty = true;
+}
+
+void DL_detect::add_dep(TxnManager * txn, Row_lock * row_lock, uint64_t * txnids, int cnt) {
+	pthread_mutex_lock(&latch);
+	std::pair<std::unordered_map<uint64_t, DepEntry>::iterator, bool> ins =
+		local.insert(std::make_pair(txn->get_txn_id(), DepEntry()));
+	DepEntry &entry = ins.first->second;
+	if (ins.second) {
+		entry.ts = txn->get_timestamp();
+		entry.starttime = get_sys_clock();
+		entry.txn = txn;
+		entry.row_lock = row_lock;
+	}
+	entry.waits_for.assign(txnids, txnids + cnt);
+	pthread_mutex_unlock(&latch);
+}
+
+void DL_detect::clear_dep(uint64_t txn_id) {
+	pthread_mutex_lock(&latch);
+	local.erase(txn_id);
+	pthread_mutex_unlock(&latch);
+}
+
+void DL_detect::recv_edges(DLEdgeMessage * msg) {
+	uint64_t node_id = msg->return_node_id;
+	assert(node_id < g_node_cnt);
+	pthread_mutex_lock(&latch);
+	remote[node_id].clear();
+	for (uint64_t i = 0; i < msg->edges.size(); i++)
+		remote[node_id].push_back(msg->edges[i]);
+	pthread_mutex_unlock(&latch);
+}
+
+void DL_detect::process(uint64_t thd_id) {
+	uint64_t starttime = get_sys_clock();
+	if (starttime - last_detect_time < g_dl_detect_intvl)
+		return;
+	last_detect_time = starttime;
+
+	graph_t graph;
+	std::unordered_map<uint64_t, uint64_t> ts;
+	std::vector<uint64_t> edges;
+	pthread_mutex_lock(&latch);
+	for (std::unordered_map<uint64_t, DepEntry>::iterator it = local.begin(); it != local.end(); it++) {
+		for (uint64_t i = 0; i < it->second.waits_for.size(); i++) {
+			edges.push_back(it->first);
+			edges.push_back(it->second.ts);
+			edges.push_back(it->second.waits_for[i]);
+		}
+	}
+	add_edges(graph, ts, edges);
+	for (uint64_t i = 0; i < g_node_cnt; i++) {
+		if (i != g_node_id)
+			add_edges(graph, ts, remote[i]);
+	}
+	pthread_mutex_unlock(&latch);
+	send_edges(thd_id, edges);
+
+	uint64_t victim;
+	while (find_victim(graph, ts, victim)) {
+		// its remaining edges cannot be part of another cycle
+		graph.erase(victim);
+		pthread_mutex_lock(&latch);
+		std::unordered_map<uint64_t, DepEntry>::iterator it = local.find(victim);
+		if (it == local.end()) {
+			// blocked on another node, which aborts it
+			pthread_mutex_unlock(&latch);
+			continue;
+		}
+		TxnManager * txn = it->second.txn;
+		Row_lock * row_lock = it->second.row_lock;
+		uint64_t wait_starttime = it->second.starttime;
+		local.erase(it);
+		pthread_mutex_unlock(&latch);
+		// the row latch is taken without holding ours, since the row lock
+		// calls in with its latch held
+		if (row_lock->abort_waiter(txn, victim, thd_id)) {
+			DEBUG("dl victim %ld\n",victim);
+			INC_STATS(thd_id,dl_victim_cnt,1);
+			INC_STATS(thd_id,dl_victim_wait_time,get_sys_clock() - wait_starttime);
+		}
+	}
+	INC_STATS(thd_id,dl_detect_cnt,1);
+	INC_STATS(thd_id,dl_detect_time,get_sys_clock() - starttime);
+}
+
+void DL_detect::add_edges(graph_t &graph, std::unordered_map<uint64_t, uint64_t> &ts,
+		std::vector<uint64_t> &edges) {
+	assert(edges.size() % 3 == 0);
+	for (uint64_t i = 0; i < edges.size(); i += 3) {
+		graph[edges[i]].push_back(edges[i + 2]);
+		ts[edges[i]] = edges[i + 1];
+	}
+}
+
+bool DL_detect::find_victim(graph_t &graph, std::unordered_map<uint64_t, uint64_t> &ts,
+		uint64_t &victim) {
+	// iterative DFS; 1 marks txns on the current path, 2 finished ones
+	std::unordered_map<uint64_t, int> color;
+	std::vector<uint64_t> path;
+	std::vector<uint64_t> next;
+	for (graph_t::iterator it = graph.begin(); it != graph.end(); it++) {
+		if (color[it->first] != 0)
+			continue;
+		color[it->first] = 1;
+		path.push_back(it->first);
+		next.push_back(0);
+		while (!path.empty()) {
+			graph_t::iterator v = graph.find(path.back());
+			if (v == graph.end() || next.back() == v->second.size()) {
+				color[path.back()] = 2;
+				path.pop_back();
+				next.pop_back();
+				continue;
+			}
+			uint64_t u = v->second[next.back()++];
+			int c = color[u];
+			if (c == 1) {
+				// the cycle is the path from u to its end
+				victim = u;
+				for (uint64_t i = path.size(); path[--i] != u; ) {
+					if (ts[path[i]] > ts[victim])
+						victim = path[i];
+				}
+				return true;
+			}
+			if (c == 0) {
+				color[u] = 1;
+				path.push_back(u);
+				next.push_back(0);
+			}
+		}
+	}
+	return false;
+}
+
+void DL_detect::send_edges(uint64_t thd_id, std::vector<uint64_t> &edges) {
+	// an empty set only needs to be sent once to clear the last one
+	if (edges.empty() && sent_empty)
+		return;
+	sent_empty = edges.empty();
+	for (uint64_t i = 0; i < g_node_cnt; i++) {
+		if (i == g_node_id)
+			continue;
+		DLEdgeMessage * msg = (DLEdgeMessage *) Message::create_message(DL_EDGES);
+		msg->edges.init(edges.size());
+		for (uint64_t j = 0; j < edges.size(); j++)
+			msg->edges.add(edges[j]);
+		msg_queue.enqueue(thd_id,msg,i);
+	}
+}
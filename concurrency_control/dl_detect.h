@@ -0,0 +1,71 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _DL_DETECT_H_
+#define _DL_DETECT_H_
+
+#include "global.h"
+#include <unordered_map>
+#include <vector>
+
+class TxnManager;
+class Row_lock;
+class DLEdgeMessage;
+
+// A txn blocked on a local row lock and the txns it waits for.
+struct DepEntry {
+	uint64_t ts;
+	uint64_t starttime;
+	TxnManager * txn;
+	Row_lock * row_lock;
+	std::vector<uint64_t> waits_for;
+};
+
+// Waits-for graph deadlock detector. Each node keeps the edges of the txns
+// blocked on its own rows. Every DL_DETECT_INTVL the abort thread sends them
+// to the other nodes and searches the local edges plus the ones last
+// received for cycles. The youngest txn of a cycle is the victim, and only
+// the node it is blocked on aborts it.
+class DL_detect {
+public:
+	void init();
+	// txn waits on row_lock for txnids. Called under the row latch when txn
+	// queues, and again whenever the owners change, to replace its edges.
+	void add_dep(TxnManager * txn, Row_lock * row_lock, uint64_t * txnids, int cnt);
+	// txn no longer waits. Called under the row latch.
+	void clear_dep(uint64_t txn_id);
+	// replaces the edges last received from the sender
+	void recv_edges(DLEdgeMessage * msg);
+	void process(uint64_t thd_id);
+private:
+	typedef std::unordered_map<uint64_t, std::vector<uint64_t> > graph_t;
+	// adds (waiter, ts, owner) triples to the graph
+	void add_edges(graph_t &graph, std::unordered_map<uint64_t, uint64_t> &ts,
+			std::vector<uint64_t> &edges);
+	// returns true and the youngest txn of a cycle, if there is one
+	bool find_victim(graph_t &graph, std::unordered_map<uint64_t, uint64_t> &ts,
+			uint64_t &victim);
+	void send_edges(uint64_t thd_id, std::vector<uint64_t> &edges);
+
+	pthread_mutex_t latch;
+	std::unordered_map<uint64_t, DepEntry> local;
+	// flat (waiter, ts, owner) triples last received from each node
+	std::vector<uint64_t> * remote;
+	uint64_t last_detect_time;
+	bool sent_empty;
+};
+
+#endif
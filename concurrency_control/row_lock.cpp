@@ -20,202 +20,183 @@
 #include "mem_alloc.h"
 #include "manager.h"
 #include "helper.h"
+#include "dl_detect.h"
 
 void Row_lock::init(row_t * row) {
     _row = row;
-    owners_size = 1;//1031;
-    owners = NULL;
-    owners = (LockEntry**) mem_allocator.alloc(sizeof(LockEntry*)*owners_size);
-    for(uint64_t i = 0; i < owners_size; i++)
-        owners[i] = NULL;
+    lock_word = 0;
+    blatch = false;
     waiters_head = NULL;
     waiters_tail = NULL;
-    owner_cnt = 0;
-    waiter_cnt = 0;
-    max_owner_ts = 0;
-
-    latch = new pthread_mutex_t;
-    pthread_mutex_init(latch, NULL);
-
-    lock_type = LOCK_NONE;
-    blatch = false;
+#if CC_ALG == DL_DETECT
+    owners = NULL;
+#endif
     own_starttime = 0;
+}
 
+void Row_lock::get_latch(uint64_t thd_id, uint64_t stat_idx) {
+    uint64_t mtx_wait_starttime = get_sys_clock();
+    if (g_central_man)
+        glob_manager.lock_row(_row);
+    else
+        while (!ATOM_CAS(blatch, false, true)) {}
+    INC_STATS(thd_id,mtx[stat_idx],get_sys_clock() - mtx_wait_starttime);
+}
+
+void Row_lock::release_latch() {
+    if (g_central_man)
+        glob_manager.release_row(_row);
+    else
+        ATOM_STORE_REL(blatch, false);
 }
 
 RC Row_lock::lock_get(lock_t type, TxnManager * txn) {
 	uint64_t *txnids = NULL;
 	int txncnt = 0;
-	return lock_get(type, txn, txnids, txncnt);
+	RC rc = lock_get(type, txn, txnids, txncnt);
+	if (txnids)
+		mem_allocator.free(txnids, sizeof(uint64_t) * txncnt);
+	return rc;
 }
 
 RC Row_lock::lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt) {
-    assert (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN);
-    RC rc;
+    assert (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN || CC_ALG == DL_DETECT);
+    RC rc = RCOK;
     uint64_t starttime = get_sys_clock();
+    uint64_t word;
 
-    if (g_central_man) {
-        glob_manager.lock_row(_row);
-    }
-    else {
-        uint64_t mtx_wait_starttime = get_sys_clock();
-        pthread_mutex_lock( latch );
-        INC_STATS(txn->get_thd_id(),mtx[17],get_sys_clock() - mtx_wait_starttime);
-    }
-
-    if(owner_cnt > 0) {
-      INC_STATS(txn->get_thd_id(),twopl_already_owned_cnt,1);
-    }
-	bool conflict = conflict_lock(lock_type, type);
-#if TWOPL_LITE
-	  conflict = owner_cnt > 0;
+    while (true) {
+        word = lock_word;
+        if (use_latch(word)) {
+            rc = lock_get_slow(type, txn, txnids, txncnt);
+            break;
+        }
+        if (conflict_lock(word, type)) {
+#if CC_ALG == NO_WAIT
+            DEBUG("abort %ld,%ld %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),_row->get_primary_key(),(uint64_t)_row);
+            rc = Abort;
+#else
+            rc = lock_get_slow(type, txn, txnids, txncnt);
 #endif
-	if (CC_ALG == WAIT_DIE && !conflict) {
-		if (waiters_head && txn->get_timestamp() < waiters_head->txn->get_timestamp()) {
-			conflict = true;
-		}
-	}
-    if (CC_ALG == CALVIN && !conflict) {
-        if(waiters_head)
-          conflict = true;
+            break;
+        }
+        if (ATOM_CAS(lock_word, word, acquire_word(word, type, txn))) {
+            DEBUG("1lock (%ld,%ld): owners %ld, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt(word),type,_row->get_primary_key(),(uint64_t)_row);
+            if (owner_cnt(word) > 0) {
+                INC_STATS(txn->get_thd_id(),twopl_already_owned_cnt,1);
+                INC_STATS(txn->get_thd_id(),twopl_sh_bypass_cnt,1);
+            } else {
+                own_starttime = get_sys_clock();
+            }
+            break;
+        }
     }
-	
-    if (conflict) {
-    //printf("conflict! rid%ld txnid%ld ",_row->get_primary_key(),txn->get_txn_id());
-        // Cannot be added to the owner list.
-        if (CC_ALG == NO_WAIT) {
-            rc = Abort;
-      DEBUG("abort %ld,%ld %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),_row->get_primary_key(),(uint64_t)_row);
-      //printf("abort %ld %ld %lx\n",txn->get_txn_id(),_row->get_primary_key(),(uint64_t)_row);
-            goto final;
-        } else if (CC_ALG == WAIT_DIE) {
-            ///////////////////////////////////////////////////////////
-            //  - T is the txn currently running
-            //  IF T.ts > min ts of owners
-            //      T can wait
-            //  ELSE
-            //      T should abort
-            //////////////////////////////////////////////////////////
 
-      //bool canwait = txn->get_timestamp() > max_owner_ts;
-            bool canwait = true;
-            LockEntry * en;
-            for(uint64_t i = 0; i < owners_size; i++) {
-              en = owners[i];
-              while (en != NULL) {
-                assert(txn->get_txn_id() != en->txn->get_txn_id());
-                assert(txn->get_timestamp() != en->txn->get_timestamp());
-                if (txn->get_timestamp() > en->txn->get_timestamp()) {
-                  //printf("abort %ld %ld -- %ld -- %f\n",txn->get_txn_id(),en->txn->get_txn_id(),_row->get_primary_key(),(float)(txn->get_timestamp() - en->txn->get_timestamp()) / BILLION);
-                  INC_STATS(txn->get_thd_id(),twopl_diff_time,(txn->get_timestamp() - en->txn->get_timestamp()));
-                  canwait = false;
-                  break;
-                }
-                en = en->next;
-              }
-              if(!canwait)
-                break;
-            }
-            if (canwait) {
-                // insert txn to the right position
-                // the waiter list is always in timestamp order
-                LockEntry * entry = get_entry();
-                entry->start_ts = get_sys_clock();
-                        entry->txn = txn;
-                        entry->type = type;
-                entry->start_ts = get_sys_clock();
-                        entry->txn = txn;
-                        entry->type = type;
-                LockEntry * en;
-                //txn->lock_ready = false;
-                ATOM_CAS(txn->lock_ready,1,0);
-                txn->incr_lr();
-                en = waiters_head;
-                while (en != NULL && txn->get_timestamp() < en->txn->get_timestamp()) {
-                    en = en->next;
-                }
-                if (en) {
-                    LIST_INSERT_BEFORE(en, entry,waiters_head);
-                } else {
-                    LIST_PUT_TAIL(waiters_head, waiters_tail, entry);
-                }
+    uint64_t curr_time = get_sys_clock();
+    uint64_t timespan = curr_time - starttime;
+    if (rc == WAIT && txn->twopl_wait_start == 0) {
+        txn->twopl_wait_start = curr_time;
+    }
+    txn->txn_stats.cc_time += timespan;
+    txn->txn_stats.cc_time_short += timespan;
+    INC_STATS(txn->get_thd_id(),twopl_getlock_time,timespan);
+    INC_STATS(txn->get_thd_id(),twopl_getlock_cnt,1);
+	return rc;
+}
 
-                waiter_cnt ++;
-                DEBUG("lk_wait (%ld,%ld): owners %d, own type %d, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt,lock_type,type,_row->get_primary_key(),(uint64_t)_row);
-                //txn->twopl_wait_start = get_sys_clock();
-                rc = WAIT;
-                //txn->wait_starttime = get_sys_clock();
+// Called on conflict for WAIT_DIE and CALVIN, whenever the lock has waiters,
+// and always for DL_DETECT. Waiters are only added and granted under the latch.
+RC Row_lock::lock_get_slow(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt) {
+    RC rc;
+    INC_STATS(txn->get_thd_id(),twopl_slow_path_cnt,1);
+    get_latch(txn->get_thd_id(), 17);
+    while (true) {
+        uint64_t word = lock_word;
+        if (owner_cnt(word) > 0) {
+            INC_STATS(txn->get_thd_id(),twopl_already_owned_cnt,1);
+        }
+        bool conflict = conflict_lock(word, type);
+        if (!conflict && waiters_head) {
+#if CC_ALG == WAIT_DIE
+            conflict = txn->get_timestamp() < waiters_head->txn->get_timestamp();
+#elif CC_ALG == CALVIN || CC_ALG == DL_DETECT
+            conflict = true;
+#endif
+        }
+        if (!conflict) {
+            if (!ATOM_CAS(lock_word, word, acquire_word(word, type, txn)))
+                continue;
+            DEBUG("1lock (%ld,%ld): owners %ld, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt(word),type,_row->get_primary_key(),(uint64_t)_row);
+            if (owner_cnt(word) > 0) {
+                assert(type == LOCK_SH);
+                INC_STATS(txn->get_thd_id(),twopl_sh_bypass_cnt,1);
             } else {
-              DEBUG("abort (%ld,%ld): owners %d, own type %d, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt,lock_type,type,_row->get_primary_key(),(uint64_t)_row);
-              rc = Abort;
+                own_starttime = get_sys_clock();
             }
-        } else if (CC_ALG == CALVIN){
+#if CC_ALG == DL_DETECT
             LockEntry * entry = get_entry();
+            entry->type = type;
             entry->start_ts = get_sys_clock();
             entry->txn = txn;
-            entry->type = type;
-            DEBUG("lk_wait (%ld,%ld): owners %d, own type %d, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt,lock_type,type,_row->get_primary_key(),(uint64_t)_row);
-            LIST_PUT_TAIL(waiters_head, waiters_tail, entry);
-            waiter_cnt ++;
-            /*
-            if (txn->twopl_wait_start == 0) {
-                txn->twopl_wait_start = get_sys_clock();
-            }
-            */
-            //txn->lock_ready = false;
-            ATOM_CAS(txn->lock_ready,true,false);
-            txn->incr_lr();
-            rc = WAIT;
-            //txn->wait_starttime = get_sys_clock();
+            STACK_PUSH(owners, entry);
+#endif
+            rc = RCOK;
+            break;
+        }
+#if CC_ALG == WAIT_DIE
+        ///////////////////////////////////////////////////////////
+        //  - T is the txn currently running
+        //  IF T.ts > min ts of owners
+        //      T should abort
+        //  ELSE
+        //      T can wait
+        //  The owner ts in the word is coarsened, so T only waits if it is
+        //  strictly older.
+        //////////////////////////////////////////////////////////
+        if (owner_cnt(word) > 0 && owner_ts(txn->get_timestamp()) >= (word & LOCK_TS_MASK)) {
+            INC_STATS(txn->get_thd_id(),twopl_diff_time,
+                (owner_ts(txn->get_timestamp()) - (word & LOCK_TS_MASK)) << LOCK_TS_SHIFT);
+            DEBUG("abort (%ld,%ld): owners %ld, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt(word),type,_row->get_primary_key(),(uint64_t)_row);
+            rc = Abort;
+            break;
         }
-    } else {
-        DEBUG("1lock (%ld,%ld): owners %d, own type %d, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt,lock_type,type,_row->get_primary_key(),(uint64_t)_row);
-#if DEBUG_TIMELINE
-        printf("LOCK %ld %ld\n",entry->txn->get_txn_id(),entry->start_ts);
 #endif
-#if CC_ALG != NO_WAIT
+        // the WAITER bit must be set in the same word that was seen to
+        // conflict, so the owners cannot leave without seeing it
+        if (!(word & LOCK_WAITER_BIT) && !ATOM_CAS(lock_word, word, word | LOCK_WAITER_BIT))
+            continue;
         LockEntry * entry = get_entry();
-        entry->type = type;
         entry->start_ts = get_sys_clock();
         entry->txn = txn;
-        STACK_PUSH(owners[hash(txn->get_txn_id())], entry);
-#endif
-        if(owner_cnt > 0) {
-          assert(type == LOCK_SH);
-          INC_STATS(txn->get_thd_id(),twopl_sh_bypass_cnt,1);
-        }
-        if(txn->get_timestamp() > max_owner_ts) {
-          max_owner_ts = txn->get_timestamp();
+        entry->type = type;
+        ATOM_CAS(txn->lock_ready,true,false);
+        txn->incr_lr();
+#if CC_ALG == WAIT_DIE
+        // insert txn to the right position
+        // the waiter list is always in timestamp order
+        LockEntry * en = waiters_head;
+        while (en != NULL && txn->get_timestamp() < en->txn->get_timestamp()) {
+            en = en->next;
         }
-        owner_cnt ++;
-        if(lock_type == LOCK_NONE) {
-          own_starttime = get_sys_clock();
+        if (en) {
+            LIST_INSERT_BEFORE(en, entry,waiters_head);
+        } else {
+            LIST_PUT_TAIL(waiters_head, waiters_tail, entry);
         }
-        lock_type = type;
-        rc = RCOK;
-
-    }
-final:
-    uint64_t curr_time = get_sys_clock();
-    uint64_t timespan = curr_time - starttime;
-    if (rc == WAIT && txn->twopl_wait_start == 0) {
-        txn->twopl_wait_start = curr_time;
+#else
+        LIST_PUT_TAIL(waiters_head, waiters_tail, entry);
+#endif
+#if CC_ALG == DL_DETECT
+        add_dep(entry, txnids, txncnt);
+#endif
+        DEBUG("lk_wait (%ld,%ld): owners %ld, req type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt(word),type,_row->get_primary_key(),(uint64_t)_row);
+        rc = WAIT;
+        break;
     }
-    txn->txn_stats.cc_time += timespan;
-    txn->txn_stats.cc_time_short += timespan;
-INC_STATS(txn->get_thd_id(),twopl_getlock_time,timespan);
-INC_STATS(txn->get_thd_id(),twopl_getlock_cnt,1);
-	
-    if (g_central_man)
-        glob_manager.release_row(_row);
-    else
-        pthread_mutex_unlock( latch );
-
-
-	return rc;
+    release_latch();
+    return rc;
 }
 
-
 RC Row_lock::lock_release(TxnManager * txn) {	
 
 #if CC_ALG == CALVIN
@@ -224,160 +205,223 @@ RC Row_lock::lock_release(TxnManager * txn) {
     }
 #endif
     uint64_t starttime = get_sys_clock();
-      if (g_central_man)
-          glob_manager.lock_row(_row);
-      else {
-      uint64_t mtx_wait_starttime = get_sys_clock();
-          pthread_mutex_lock( latch );
-      INC_STATS(txn->get_thd_id(),mtx[18],get_sys_clock() - mtx_wait_starttime);
-    }
-
-
-      DEBUG("unlock (%ld,%ld): owners %d, own type %d, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt,lock_type,_row->get_primary_key(),(uint64_t)_row);
-
-      // If CC is NO_WAIT or WAIT_DIE, txn should own this lock
-      // What about Calvin?
-#if CC_ALG == NO_WAIT
-      assert(owner_cnt > 0);
-      owner_cnt--;
-      if (owner_cnt == 0) {
-        INC_STATS(txn->get_thd_id(),twopl_owned_cnt,1);
-        uint64_t endtime = get_sys_clock();
-        INC_STATS(txn->get_thd_id(),twopl_owned_time,endtime - own_starttime);
-        if(lock_type == LOCK_SH) {
-          INC_STATS(txn->get_thd_id(),twopl_sh_owned_time,endtime - own_starttime);
-          INC_STATS(txn->get_thd_id(),twopl_sh_owned_cnt,1);
-        }
-        else {
-          INC_STATS(txn->get_thd_id(),twopl_ex_owned_time,endtime - own_starttime);
-          INC_STATS(txn->get_thd_id(),twopl_ex_owned_cnt,1);
-        }
-        lock_type = LOCK_NONE;
-      }
-
-#else
 
-      // Try to find the entry in the owners
-      LockEntry * en = owners[hash(txn->get_txn_id())];
-      LockEntry * prev = NULL;
-
-      while (en != NULL && en->txn != txn) {
-          prev = en;
-          en = en->next;
-      }
-
-      if (en) { // find the entry in the owner list
-          if (prev) prev->next = en->next;
-          else owners[hash(txn->get_txn_id())] = en->next;
-          return_entry(en);
-          owner_cnt --;
-      if (owner_cnt == 0) {
-        INC_STATS(txn->get_thd_id(),twopl_owned_cnt,1);
-        uint64_t endtime = get_sys_clock();
-        INC_STATS(txn->get_thd_id(),twopl_owned_time,endtime - own_starttime);
-        if(lock_type == LOCK_SH) {
-          INC_STATS(txn->get_thd_id(),twopl_sh_owned_time,endtime - own_starttime);
-          INC_STATS(txn->get_thd_id(),twopl_sh_owned_cnt,1);
+    while (true) {
+        uint64_t word = lock_word;
+        assert(owner_cnt(word) > 0);
+        if (use_latch(word)) {
+            if (lock_release_slow(txn))
+                break;
+            continue;
         }
-        else {
-          INC_STATS(txn->get_thd_id(),twopl_ex_owned_time,endtime - own_starttime);
-          INC_STATS(txn->get_thd_id(),twopl_ex_owned_cnt,1);
+        if (ATOM_CAS(lock_word, word, release_word(word))) {
+            DEBUG("unlock (%ld,%ld): owners %ld, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt(word),_row->get_primary_key(),(uint64_t)_row);
+            release_stats(word, txn);
+            break;
         }
-        lock_type = LOCK_NONE;
-      }
+    }
 
-    } else {
-      assert(false);
-          en = waiters_head;
-          while (en != NULL && en->txn != txn)
-              en = en->next;
-          ASSERT(en);
+    uint64_t timespan = get_sys_clock() - starttime;
+    txn->txn_stats.cc_time += timespan;
+    txn->txn_stats.cc_time_short += timespan;
+    INC_STATS(txn->get_thd_id(),twopl_release_time,timespan);
+    INC_STATS(txn->get_thd_id(),twopl_release_cnt,1);
+    return RCOK;
+}
 
-          LIST_REMOVE(en);
-          if (en == waiters_head)
-              waiters_head = en->next;
-          if (en == waiters_tail)
-              waiters_tail = en->prev;
-          return_entry(en);
-          waiter_cnt --;
-      }
+bool Row_lock::lock_release_slow(TxnManager * txn) {
+    get_latch(txn->get_thd_id(), 18);
+    // the WAITER bit is only cleared under the latch, so while it is set
+    // nobody else changes the word
+    uint64_t word = lock_word;
+    if (!use_latch(word)) {
+        release_latch();
+        return false;
+    }
+    DEBUG("unlock (%ld,%ld): owners %ld, key %ld %lx\n",txn->get_txn_id(),txn->get_batch_id(),owner_cnt(word),_row->get_primary_key(),(uint64_t)_row);
+    release_stats(word, txn);
+    word = release_word(word);
+#if CC_ALG == DL_DETECT
+    LockEntry * en = owners;
+    LockEntry * prev = NULL;
+    while (en != NULL && en->txn != txn) {
+        prev = en;
+        en = en->next;
+    }
+    assert(en);
+    if (prev) prev->next = en->next;
+    else owners = en->next;
+    return_entry(en);
 #endif
 
-      if (owner_cnt == 0)
-          ASSERT(lock_type == LOCK_NONE);
 #if DEBUG_ASSERT && CC_ALG == WAIT_DIE 
-      for (en = waiters_head; en != NULL && en->next != NULL; en = en->next)
-        assert(en->next->txn->get_timestamp() < en->txn->get_timestamp());
-      for (en = waiters_head; en != NULL && en->next != NULL; en = en->next)
-        assert(en->txn->get_txn_id() !=txn->get_txn_id());
+    for (LockEntry * en = waiters_head; en != NULL && en->next != NULL; en = en->next)
+      assert(en->next->txn->get_timestamp() < en->txn->get_timestamp());
+    for (LockEntry * en = waiters_head; en != NULL && en->next != NULL; en = en->next)
+      assert(en->txn->get_txn_id() !=txn->get_txn_id());
 #endif
 
-      LockEntry * entry;
-      // If any waiter can join the owners, just do it!
-      while (waiters_head && !conflict_lock(lock_type, waiters_head->type)) {
-          LIST_GET_HEAD(waiters_head, waiters_tail, entry);
+    word = grant_waiters(word, txn->get_thd_id());
+    ATOM_STORE_REL(lock_word, word);
+    release_latch();
+    return true;
+}
+
+bool Row_lock::abort_waiter(TxnManager * txn, uint64_t txn_id, uint64_t thd_id) {
+    get_latch(thd_id, 18);
+    LockEntry * en = waiters_head;
+    while (en != NULL && (en->txn != txn || txn->get_txn_id() != txn_id))
+        en = en->next;
+    if (en == NULL) {
+        release_latch();
+        return false;
+    }
+    DEBUG("lk_abort (%ld,%ld): key %ld %lx\n",txn_id,txn->get_batch_id(),_row->get_primary_key(),(uint64_t)_row);
+    LIST_REMOVE_HT(en, waiters_head, waiters_tail);
+    return_entry(en);
+    txn->dl_victim = true;
+    txn->twopl_wait_start = 0;
+    if(txn->decr_lr() == 0) {
+        if(ATOM_CAS(txn->lock_ready,false,true))
+            txn_table.restart_txn(thd_id,txn_id,txn->get_batch_id());
+    }
+    // a refresh of the waiters' edges may have put it back after the
+    // detector dropped it
+    dl_detector.clear_dep(txn_id);
+    // the victim may have held back the waiters behind it
+    ATOM_STORE_REL(lock_word, grant_waiters(lock_word, thd_id));
+    release_latch();
+    return true;
+}
+
+uint64_t Row_lock::grant_waiters(uint64_t word, uint64_t thd_id) {
+    LockEntry * entry;
+    // If any waiter can join the owners, just do it!
+    while (waiters_head && !conflict_lock(word, waiters_head->type)) {
+        LIST_GET_HEAD(waiters_head, waiters_tail, entry);
 #if DEBUG_TIMELINE
-          printf("LOCK %ld %ld\n",entry->txn->get_txn_id(),get_sys_clock());
+        printf("LOCK %ld %ld\n",entry->txn->get_txn_id(),get_sys_clock());
 #endif
-          DEBUG("2lock (%ld,%ld): owners %d, own type %d, req type %d, key %ld %lx\n",entry->txn->get_txn_id(),entry->txn->get_batch_id(),owner_cnt,lock_type,entry->type,_row->get_primary_key(),(uint64_t)_row);
-          uint64_t timespan = get_sys_clock() - entry->txn->twopl_wait_start;
-          entry->txn->twopl_wait_start = 0;
+        DEBUG("2lock (%ld,%ld): owners %ld, req type %d, key %ld %lx\n",entry->txn->get_txn_id(),entry->txn->get_batch_id(),owner_cnt(word),entry->type,_row->get_primary_key(),(uint64_t)_row);
+        uint64_t timespan = get_sys_clock() - entry->txn->twopl_wait_start;
+        entry->txn->twopl_wait_start = 0;
 #if CC_ALG != CALVIN
-          entry->txn->txn_stats.cc_block_time += timespan;
-          entry->txn->txn_stats.cc_block_time_short += timespan;
+        entry->txn->txn_stats.cc_block_time += timespan;
+        entry->txn->txn_stats.cc_block_time_short += timespan;
 #endif
-          INC_STATS(txn->get_thd_id(),twopl_wait_time,timespan);
-
-#if CC_ALG != NO_WAIT
-          STACK_PUSH(owners[hash(entry->txn->get_txn_id())], entry);
-#endif 
-          owner_cnt ++;
-          waiter_cnt --;
-          if(entry->txn->get_timestamp() > max_owner_ts) {
-              max_owner_ts = entry->txn->get_timestamp();
-          }
-          ASSERT(entry->txn->lock_ready == false);
-      //if(entry->txn->decr_lr() == 0 && entry->txn->locking_done) {
-          if(entry->txn->decr_lr() == 0) {
-              if(ATOM_CAS(entry->txn->lock_ready,false,true)) {
+        INC_STATS(thd_id,twopl_wait_time,timespan);
+        if (owner_cnt(word) == 0) {
+            own_starttime = get_sys_clock();
+        }
+        word = acquire_word(word, entry->type, entry->txn);
+        ASSERT(entry->txn->lock_ready == false);
+        if(entry->txn->decr_lr() == 0) {
+            if(ATOM_CAS(entry->txn->lock_ready,false,true)) {
 #if CC_ALG == CALVIN
-                  entry->txn->txn_stats.cc_block_time += timespan;
-                  entry->txn->txn_stats.cc_block_time_short += timespan;
+                entry->txn->txn_stats.cc_block_time += timespan;
+                entry->txn->txn_stats.cc_block_time_short += timespan;
 #endif
-                  txn_table.restart_txn(txn->get_thd_id(),entry->txn->get_txn_id(),entry->txn->get_batch_id());
-              }
-          }
-          if(lock_type == LOCK_NONE) {
-              own_starttime = get_sys_clock();
-          }
-          lock_type = entry->type;
-#if CC_AlG == NO_WAIT
-          return_entry(entry);
+                txn_table.restart_txn(thd_id,entry->txn->get_txn_id(),entry->txn->get_batch_id());
+            }
+        }
+#if CC_ALG == DL_DETECT
+        dl_detector.clear_dep(entry->txn->get_txn_id());
+        STACK_PUSH(owners, entry);
+#else
+        return_entry(entry);
+#endif
+    }
+    if (!waiters_head) {
+        word &= ~LOCK_WAITER_BIT;
+    }
+#if CC_ALG == DL_DETECT
+    // The owners changed, so the edges the waiters got when they queued are
+    // stale. Restarted txns keep their txn_id, so a stale edge to a txn that
+    // left and came back could close a false cycle.
+    for (entry = waiters_head; entry != NULL; entry = entry->next) {
+        uint64_t * txnids;
+        int txncnt;
+        add_dep(entry, txnids, txncnt);
+        mem_allocator.free(txnids, sizeof(uint64_t) * txncnt);
+    }
 #endif
-      }
+    return word;
+}
 
-      uint64_t timespan = get_sys_clock() - starttime;
-      txn->txn_stats.cc_time += timespan;
-      txn->txn_stats.cc_time_short += timespan;
-      INC_STATS(txn->get_thd_id(),twopl_release_time,timespan);
-      INC_STATS(txn->get_thd_id(),twopl_release_cnt,1);
+#if CC_ALG == DL_DETECT
+void Row_lock::add_dep(LockEntry * entry, uint64_t* &txnids, int &txncnt) {
+    // txn waits for the owners and, being granted in order, for the
+    // waiters ahead of it
+    txncnt = 0;
+    for (LockEntry * en = owners; en != NULL; en = en->next)
+        txncnt ++;
+    for (LockEntry * en = waiters_head; en != entry; en = en->next)
+        txncnt ++;
+    txnids = (uint64_t *) mem_allocator.alloc(sizeof(uint64_t) * txncnt);
+    int cnt = 0;
+    for (LockEntry * en = owners; en != NULL; en = en->next)
+        txnids[cnt++] = en->txn->get_txn_id();
+    for (LockEntry * en = waiters_head; en != entry; en = en->next)
+        txnids[cnt++] = en->txn->get_txn_id();
+    dl_detector.add_dep(entry->txn, this, txnids, txncnt);
+}
+#endif
 
-      if (g_central_man)
-          glob_manager.release_row(_row);
-      else
-          pthread_mutex_unlock( latch );
+uint64_t Row_lock::acquire_word(uint64_t word, lock_t type, TxnManager * txn) {
+    uint64_t ts = 0;
+#if CC_ALG == WAIT_DIE
+    ts = owner_ts(txn->get_timestamp());
+    if (owner_cnt(word) > 0 && (word & LOCK_TS_MASK) < ts)
+        ts = word & LOCK_TS_MASK;
+#endif
+    assert(owner_cnt(word) + 1 < (LOCK_CNT_MASK >> LOCK_CNT_SHIFT));
+    word = ((word & ~LOCK_TS_MASK) | ts) + LOCK_CNT_ONE;
+    if (type == LOCK_EX)
+        word |= LOCK_EX_BIT;
+    return word;
+}
 
+uint64_t Row_lock::owner_ts(uint64_t ts) {
+    uint64_t base = glob_manager.get_ts_base();
+    if (ts < base)
+        return 0;
+    uint64_t t = (ts - base) >> LOCK_TS_SHIFT;
+    return t < LOCK_TS_MASK ? t : LOCK_TS_MASK;
+}
 
-    return RCOK;
+uint64_t Row_lock::release_word(uint64_t word) {
+    word -= LOCK_CNT_ONE;
+    if (owner_cnt(word) == 0) {
+        // the ts of a remaining sharer may be newer than the one kept; it is
+        // only reset when the lock is free, which errs towards dying
+        word &= LOCK_WAITER_BIT;
+    }
+    return word;
 }
 
-bool Row_lock::conflict_lock(lock_t l1, lock_t l2) {
-    if (l1 == LOCK_NONE || l2 == LOCK_NONE)
-        return false;
-    else if (l1 == LOCK_EX || l2 == LOCK_EX)
-        return true;
-    else
+void Row_lock::release_stats(uint64_t word, TxnManager * txn) {
+    if (owner_cnt(word) != 1)
+        return;
+    INC_STATS(txn->get_thd_id(),twopl_owned_cnt,1);
+    uint64_t endtime = get_sys_clock();
+    INC_STATS(txn->get_thd_id(),twopl_owned_time,endtime - own_starttime);
+    if(!(word & LOCK_EX_BIT)) {
+      INC_STATS(txn->get_thd_id(),twopl_sh_owned_time,endtime - own_starttime);
+      INC_STATS(txn->get_thd_id(),twopl_sh_owned_cnt,1);
+    }
+    else {
+      INC_STATS(txn->get_thd_id(),twopl_ex_owned_time,endtime - own_starttime);
+      INC_STATS(txn->get_thd_id(),twopl_ex_owned_cnt,1);
+    }
+}
+
+bool Row_lock::conflict_lock(uint64_t word, lock_t type) {
+    if (owner_cnt(word) == 0 || type == LOCK_NONE)
         return false;
+#if TWOPL_LITE
+    return true;
+#endif
+    return (word & LOCK_EX_BIT) || type == LOCK_EX;
 }
 
 LockEntry * Row_lock::get_entry() {
@@ -392,4 +436,3 @@ void Row_lock::return_entry(LockEntry * entry) {
     //DEBUG_M("row_lock::return_entry free %lx\n",(uint64_t)entry);
     mem_allocator.free(entry, sizeof(LockEntry));
 }
-
@@ -17,6 +17,20 @@
 #ifndef ROW_LOCK_H
 #define ROW_LOCK_H
 
+// Lock word layout: [EX:1][WAITER:1][owner count:14][oldest owner ts:48].
+// Requests that do not conflict and find no waiters acquire and release the
+// lock with a single CAS on the word. The latch and the waiter list are only
+// touched on conflict, and while WAITER is set every request goes through them.
+#define LOCK_EX_BIT 		(1UL << 63)
+#define LOCK_WAITER_BIT 	(1UL << 62)
+#define LOCK_CNT_SHIFT 		48
+#define LOCK_CNT_ONE 		(1UL << LOCK_CNT_SHIFT)
+#define LOCK_CNT_MASK 		(0x3FFFUL << LOCK_CNT_SHIFT)
+#define LOCK_TS_MASK 		((1UL << LOCK_CNT_SHIFT) - 1)
+// [WAIT_DIE] owner timestamps are kept relative to the manager's ts base;
+// clock timestamps are coarsened so a run fits in the field
+#define LOCK_TS_SHIFT 		(TS_ALLOC == TS_CLOCK ? 4 : 0)
+
 struct LockEntry {
     lock_t type;
     ts_t   start_ts;
@@ -32,29 +46,52 @@ public:
     RC lock_get(lock_t type, TxnManager * txn);
     RC lock_get(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt);
     RC lock_release(TxnManager * txn);
+	// [DL_DETECT] drops the queued request of a deadlock victim and restarts
+	// it so it aborts. Returns false if the request was granted meanwhile.
+	bool abort_waiter(TxnManager * txn, uint64_t txn_id, uint64_t thd_id);
 	
 private:
-    pthread_mutex_t * latch;
-	bool blatch;
-	
-	bool 		conflict_lock(lock_t l1, lock_t l2);
+	volatile uint64_t lock_word;
+	volatile bool blatch;
+
+	void 		get_latch(uint64_t thd_id, uint64_t stat_idx);
+	void 		release_latch();
+	RC 			lock_get_slow(lock_t type, TxnManager * txn, uint64_t* &txnids, int &txncnt);
+	// returns false if the waiters left before the latch was taken
+	bool 		lock_release_slow(TxnManager * txn);
+	// grants the waiters at the head that do not conflict with word, under
+	// the latch; returns the new word
+	uint64_t 	grant_waiters(uint64_t word, uint64_t thd_id);
+#if CC_ALG == DL_DETECT
+	// sets the edges of a queued request from the current owners and the
+	// waiters ahead of it; txnids is allocated for the caller to free
+	void 		add_dep(LockEntry * entry, uint64_t* &txnids, int &txncnt);
+#endif
+	bool 		use_latch(uint64_t word) { return CC_ALG == DL_DETECT || (word & LOCK_WAITER_BIT); }
+	// returns the word after type is granted to txn
+	uint64_t 	acquire_word(uint64_t word, lock_t type, TxnManager * txn);
+	// returns the word after one owner leaves
+	uint64_t 	release_word(uint64_t word);
+	// records the owned time if the release of word freed the lock
+	void 		release_stats(uint64_t word, TxnManager * txn);
+	uint64_t 	owner_cnt(uint64_t word) { return (word & LOCK_CNT_MASK) >> LOCK_CNT_SHIFT; }
+	// Older timestamps map to smaller values. Values that do not fit
+	// saturate, which only makes WAIT_DIE abort more.
+	uint64_t 	owner_ts(uint64_t ts);
+	bool 		conflict_lock(uint64_t word, lock_t type);
 	LockEntry * get_entry();
 	void 		return_entry(LockEntry * entry);
 	row_t * _row;
-  uint64_t hash(uint64_t id) {return id % owners_size;};
-    lock_t lock_type;
-    UInt32 owner_cnt;
-    UInt32 waiter_cnt;
 	
-	// owners is a hash table
-	// waiters is a double linked list 
-	// [waiters] head is the oldest txn, tail is the youngest txn. 
-	//   So new txns are inserted into the tail.
-	LockEntry ** owners;	
-  uint64_t owners_size;
+	// [waiters] is a double linked list, only accessed under the latch.
+	//   WAIT_DIE keeps it in timestamp order, CALVIN and DL_DETECT in
+	//   arrival order.
 	LockEntry * waiters_head;
 	LockEntry * waiters_tail;
-  uint64_t max_owner_ts;
+#if CC_ALG == DL_DETECT
+	// the waits-for edges need the owners, so every request takes the latch
+	LockEntry * owners;
+#endif
   uint64_t own_starttime;
 };
 
@@ -20,9 +20,11 @@
 #include "manager.h"
 #include "row_mvcc.h"
 #include "mem_alloc.h"
+#include "pool.h"
 
 void Row_mvcc::init(row_t * row) {
 	_row = row;
+	_row_ts = 0;
 	readreq_mvcc = NULL;
 	prereq_mvcc = NULL;
 	readhis = NULL;
@@ -39,7 +41,7 @@ void Row_mvcc::init(row_t * row) {
 	preq_len = 0;
 }
 
-row_t * Row_mvcc::clear_history(TsType type, ts_t ts) {
+row_t * Row_mvcc::clear_history(TsType type, ts_t ts, uint64_t thd_id) {
 	MVHisEntry ** queue;
 	MVHisEntry ** tail;
     switch (type) {
@@ -54,12 +56,14 @@ row_t * Row_mvcc::clear_history(TsType type, ts_t ts) {
 		prev = his->prev;
 		assert(prev->ts >= his->ts);
 		if (row != NULL) {
-			row->free_row();
-			mem_allocator.free(row, sizeof(row_t));
+			version_pool.put(thd_id, row);
+			INC_STATS(thd_id,mvcc_gc_version_cnt,1);
 		}
 		row = his->row;
+		if (type == W_REQ)
+			_row_ts = his->ts;
 		his->row = NULL;
-		return_his_entry(his);
+		return_his_entry(his, thd_id);
 		his = prev;
 		if (type == R_REQ) rhis_len --;
 		else whis_len --;
@@ -84,11 +88,9 @@ MVHisEntry * Row_mvcc::get_his_entry() {
 	return (MVHisEntry *) mem_allocator.alloc(sizeof(MVHisEntry));
 }
 
-void Row_mvcc::return_his_entry(MVHisEntry * entry) {
-	if (entry->row != NULL) {
-		entry->row->free_row();
-		mem_allocator.free(entry->row, sizeof(row_t));
-	}
+void Row_mvcc::return_his_entry(MVHisEntry * entry, uint64_t thd_id) {
+	if (entry->row != NULL)
+		version_pool.put(thd_id, entry->row);
 	mem_allocator.free(entry, sizeof(MVHisEntry));
 }
 
@@ -248,7 +250,18 @@ RC Row_mvcc::access(TxnManager * txn, TsType type, row_t * row) {
 		glob_manager.lock_row(_row);
 	else
 		pthread_mutex_lock( latch );
-  if (type == R_REQ) {
+  if (type == R_REQ && ts < glob_manager.get_min_ts(txn->get_thd_id())) {
+		// Snapshot read: every txn with a pending prewrite, and every txn that
+		// may write later, has a larger ts. So this read cannot conflict and
+		// does not need to be remembered.
+		MVHisEntry * whis = writehis;
+		while (whis != NULL && whis->ts > ts) 
+			whis = whis->next;
+		// the version below ts must not have been collected
+		assert(whis != NULL || _row_ts <= ts);
+		txn->cur_row = (whis == NULL)? _row : whis->row;
+		INC_STATS(txn->get_thd_id(),mvcc_snapshot_read_cnt,1);
+	} else if (type == R_REQ) {
 		// figure out if ts is in interval(prewrite(x))
 		bool conf = conflict(type, ts);
 		if ( conf && rreq_len < g_max_read_req) {
@@ -304,7 +317,7 @@ RC Row_mvcc::access(TxnManager * txn, TsType type, row_t * row) {
 		if (whis_len > g_his_recycle_len || rhis_len > g_his_recycle_len) {
 			ts_t t_th = glob_manager.get_min_ts(txn->get_thd_id());
 			if (readhistail && readhistail->ts < t_th)
-				clear_history(R_REQ, t_th);
+				clear_history(R_REQ, t_th, txn->get_thd_id());
 			// Here is a tricky bug. The oldest transaction might be 
 			// reading an even older version whose timestamp < t_th.
 			// But we cannot recycle that version because it is still being used.
@@ -312,10 +325,12 @@ RC Row_mvcc::access(TxnManager * txn, TsType type, row_t * row) {
 			// t_th not be recycled.
 			if (whis_len > 1 && 
 				writehistail->prev->ts < t_th) {
-				row_t * latest_row = clear_history(W_REQ, t_th);
+				row_t * latest_row = clear_history(W_REQ, t_th, txn->get_thd_id());
 				if (latest_row != NULL) {
 					assert(_row != latest_row);
 					_row->copy(latest_row);
+					version_pool.put(txn->get_thd_id(), latest_row);
+					INC_STATS(txn->get_thd_id(),mvcc_gc_version_cnt,1);
 				}
 			}
 		}
@@ -48,10 +48,12 @@ private:
 	bool blatch;
 
 	row_t * _row;
+	// ts of the version _row holds; 0 until history is folded into it
+	ts_t _row_ts;
 	MVReqEntry * get_req_entry();
 	void return_req_entry(MVReqEntry * entry);
 	MVHisEntry * get_his_entry();
-	void return_his_entry(MVHisEntry * entry);
+	void return_his_entry(MVHisEntry * entry, uint64_t thd_id);
 
 	bool conflict(TsType type, ts_t ts);
 	void buffer_req(TsType type, TxnManager * txn);
@@ -59,11 +61,15 @@ private:
 	void update_buffer(TxnManager * txn);
 	void insert_history( ts_t ts, row_t * row);
 
-	row_t * clear_history(TsType type, ts_t ts); 
+	// drops the history older than ts, but keeps the newest entry below ts.
+	// returns the newest dropped version, which the caller owns; for
+	// W_REQ its ts is left in _row_ts.
+	row_t * clear_history(TsType type, ts_t ts, uint64_t thd_id);
 
 	MVReqEntry * readreq_mvcc;
     MVReqEntry * prereq_mvcc;
     MVHisEntry * readhis;
+    // committed versions, newest first. _row holds the version older than all of them.
     MVHisEntry * writehis;
 	MVHisEntry * readhistail;
 	MVHisEntry * writehistail;
@@ -0,0 +1,74 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "txn.h"
+#include "row.h"
+#include "row_silo.h"
+#include "mem_alloc.h"
+
+void 
+Row_silo::init(row_t * row) {
+	_row = row;
+	_tid_word = 0;
+}
+
+RC
+Row_silo::access(TxnManager * txn, row_t * local_row, uint64_t & tid) {
+	while (true) {
+		uint64_t v = ATOM_LOAD_ACQ(_tid_word);
+		if (v & SILO_LOCK_BIT) {
+			// the lock is held until the writer's 2PC finishes; do not wait for it
+			INC_STATS(txn->get_thd_id(),silo_lock_abort_cnt,1);
+			return Abort;
+		}
+		local_row->copy(_row);
+		__sync_synchronize();
+		if (_tid_word == v) {
+			tid = v;
+			return RCOK;
+		}
+	}
+}
+
+bool
+Row_silo::try_lock() {
+	uint64_t v = _tid_word;
+	if (v & SILO_LOCK_BIT)
+		return false;
+	return ATOM_CAS(_tid_word, v, v | SILO_LOCK_BIT);
+}
+
+bool
+Row_silo::validate(uint64_t tid, bool locked_by_me) {
+	uint64_t v = _tid_word;
+	if ((v & SILO_LOCK_BIT) && !locked_by_me)
+		return false;
+	return (v & ~SILO_LOCK_BIT) == tid;
+}
+
+void
+Row_silo::write(row_t * data, uint64_t tid) {
+	assert(_tid_word & SILO_LOCK_BIT);
+	assert(tid > (_tid_word & ~SILO_LOCK_BIT));
+	_row->copy(data);
+	ATOM_STORE_REL(_tid_word, tid);
+}
+
+void
+Row_silo::release() {
+	assert(_tid_word & SILO_LOCK_BIT);
+	ATOM_STORE_REL(_tid_word, _tid_word & ~SILO_LOCK_BIT);
+}
@@ -0,0 +1,45 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ROW_SILO_H
+#define ROW_SILO_H
+
+class table_t;
+class Catalog;
+class TxnManager;
+
+// the top bit of a TID word is the row's write lock
+#define SILO_LOCK_BIT (1UL << 63)
+
+class Row_silo {
+public:
+	void 				init(row_t * row);
+	// copy a consistent version of the row into local_row; returns the TID
+	// of that version in tid. Aborts if a committing txn holds the row.
+	RC 					access(TxnManager * txn, row_t * local_row, uint64_t & tid);
+	bool				try_lock();
+	// true if the row still carries tid. A row locked by someone else fails.
+	bool				validate(uint64_t tid, bool locked_by_me);
+	uint64_t			get_tid() { return _tid_word & ~SILO_LOCK_BIT; }
+	// install data and tid, which also releases the lock
+	void				write(row_t * data, uint64_t tid);
+	void 				release();
+private:
+	row_t * 			_row;
+	volatile uint64_t 	_tid_word;
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "txn.h"
+#include "row.h"
+#include "row_tictoc.h"
+#include "mem_alloc.h"
+
+void 
+Row_tictoc::init(row_t * row) {
+	_row = row;
+	_ts_word = 0;
+}
+
+RC
+Row_tictoc::access(TxnManager * txn, row_t * local_row, uint64_t & wts, uint64_t & rts) {
+	while (true) {
+		uint64_t v = ATOM_LOAD_ACQ(_ts_word);
+		if (v & TICTOC_LOCK_BIT) {
+			// the lock is held until the writer's 2PC finishes; do not wait for it
+			INC_STATS(txn->get_thd_id(),tictoc_lock_abort_cnt,1);
+			return Abort;
+		}
+		local_row->copy(_row);
+		__sync_synchronize();
+		// an rts extension alone does not change the data
+		if (get_wts(_ts_word) == get_wts(v) && !(_ts_word & TICTOC_LOCK_BIT)) {
+			wts = get_wts(v);
+			rts = get_rts(v);
+			return RCOK;
+		}
+	}
+}
+
+bool
+Row_tictoc::try_lock() {
+	uint64_t v = _ts_word;
+	if (v & TICTOC_LOCK_BIT)
+		return false;
+	return ATOM_CAS(_ts_word, v, v | TICTOC_LOCK_BIT);
+}
+
+bool
+Row_tictoc::extend(uint64_t wts, uint64_t ts) {
+	while (true) {
+		uint64_t v = _ts_word;
+		if (get_wts(v) != wts)
+			return false;
+		// valid long enough already; a writer holding the lock installs
+		// its version after the rts
+		if (get_rts(v) >= ts)
+			return true;
+		if (v & TICTOC_LOCK_BIT)
+			return false;
+		// if the delta does not fit, move wts up; readers of the old
+		// version then fail validation, which is safe
+		uint64_t new_wts = wts;
+		if (ts - wts > TICTOC_DELTA_MAX)
+			new_wts = ts - TICTOC_DELTA_MAX;
+		uint64_t nv = ((ts - new_wts) << TICTOC_WTS_BITS) | new_wts;
+		if (ATOM_CAS(_ts_word, v, nv))
+			return true;
+	}
+}
+
+void
+Row_tictoc::write(row_t * data, uint64_t ts) {
+	assert(_ts_word & TICTOC_LOCK_BIT);
+	assert(ts > get_rts(_ts_word));
+	assert(ts <= TICTOC_WTS_MASK);
+	_row->copy(data);
+	ATOM_STORE_REL(_ts_word, ts);
+}
+
+void
+Row_tictoc::release() {
+	assert(_ts_word & TICTOC_LOCK_BIT);
+	ATOM_STORE_REL(_ts_word, _ts_word & ~TICTOC_LOCK_BIT);
+}
@@ -0,0 +1,57 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef ROW_TICTOC_H
+#define ROW_TICTOC_H
+
+class table_t;
+class Catalog;
+class TxnManager;
+
+// A row's timestamp word packs, from the top bit down: the write lock,
+// rts - wts (TICTOC_DELTA_BITS) and wts (TICTOC_WTS_BITS). Keeping all of it
+// in one word lets a reader extend rts with a single CAS that also checks
+// the lock and wts.
+#define TICTOC_LOCK_BIT (1UL << 63)
+#define TICTOC_WTS_BITS 48
+#define TICTOC_DELTA_BITS 15
+#define TICTOC_WTS_MASK ((1UL << TICTOC_WTS_BITS) - 1)
+#define TICTOC_DELTA_MAX ((1UL << TICTOC_DELTA_BITS) - 1)
+
+class Row_tictoc {
+public:
+	void 				init(row_t * row);
+	// copy a consistent version of the row into local_row along with its
+	// wts and rts. Aborts if a committing txn holds the row.
+	RC 					access(TxnManager * txn, row_t * local_row, uint64_t & wts, uint64_t & rts);
+	bool				try_lock();
+	uint64_t			get_wts() { return get_wts(_ts_word); }
+	uint64_t			get_rts() { return get_rts(_ts_word); }
+	// make the version written at wts valid until at least ts. Fails if the
+	// row was overwritten, or is locked by another txn and has to be extended.
+	bool				extend(uint64_t wts, uint64_t ts);
+	// install data as the version valid at ts, which also releases the lock
+	void				write(row_t * data, uint64_t ts);
+	void 				release();
+private:
+	static uint64_t		get_wts(uint64_t v) { return v & TICTOC_WTS_MASK; }
+	static uint64_t		get_rts(uint64_t v) { return get_wts(v) + ((v & ~TICTOC_LOCK_BIT) >> TICTOC_WTS_BITS); }
+
+	row_t * 			_row;
+	volatile uint64_t 	_ts_word;
+};
+
+#endif
@@ -66,7 +66,7 @@ void Row_ts::buffer_req(TsType type, TxnManager * txn, row_t * row)
 	TsReqEntry * req_entry = get_req_entry();
 	assert(req_entry != NULL);
 	req_entry->txn = txn;
-	req_entry->row = row;
+	req_entry->row = NULL;
 	req_entry->ts = txn->get_timestamp();
 	req_entry->starttime = get_sys_clock();
 	if (type == R_REQ) {
@@ -76,6 +76,11 @@ void Row_ts::buffer_req(TsType type, TxnManager * txn, row_t * row)
 			min_rts = req_entry->ts;
 	} else if (type == W_REQ) {
 		assert(row != NULL);
+		// row lives in the txn's arena, which may be rewound before the
+		// write is applied, so the buffered write keeps its own copy
+		req_entry->row = (row_t *) mem_allocator.alloc(sizeof(row_t));
+		req_entry->row->init(_row->get_table(), _row->get_part_id());
+		req_entry->row->copy(row);
 		req_entry->next = writereq;
 		writereq = req_entry;
 		if (req_entry->ts < min_wts)
@@ -216,8 +221,6 @@ RC Row_ts::access(TxnManager * txn, TsType type, row_t * row) {
 			assert(req != NULL);
 			update_buffer(txn->get_thd_id());
 			return_req_entry(req);
-			row->free_row();
-			mem_allocator.free(row, sizeof(row_t));
 			goto final;
 		}
 #else
@@ -228,7 +231,6 @@ RC Row_ts::access(TxnManager * txn, TsType type, row_t * row) {
 		}
 #endif
 		if (ts > min_rts) { // write should happen after older reads are processed
-			row = txn->cur_row;
       //printf("Buffer W_REQ %ld\n",txn->txn_id);
 			buffer_req(W_REQ, txn, row);
             goto final;
@@ -242,9 +244,6 @@ RC Row_ts::access(TxnManager * txn, TsType type, row_t * row) {
 			assert(req != NULL);
 			update_buffer(txn->get_thd_id());
 			return_req_entry(req);
-			// the "row" is freed after hard copy to "_row"
-			row->free_row();
-			mem_allocator.free(row, sizeof(row_t));
 		}
 	} else if (type == XP_REQ) {
 		TsReqEntry * req = debuffer_req(P_REQ, txn);
@@ -0,0 +1,114 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "txn.h"
+#include "silo.h"
+#include "mem_alloc.h"
+#include "row_silo.h"
+
+#define SILO_TID_STRIDE (CL_SIZE / sizeof(uint64_t))
+
+void Silo::init() {
+	_epoch = 1;
+	_epoch_starttime = get_sys_clock();
+	_last_tid = (uint64_t *) mem_allocator.align_alloc(sizeof(uint64_t) * SILO_TID_STRIDE * g_total_thread_cnt);
+	for (uint64_t i = 0; i < g_total_thread_cnt; i++)
+		_last_tid[i * SILO_TID_STRIDE] = 0;
+}
+
+uint64_t Silo::get_epoch() {
+	// whoever first sees the interval expire advances the epoch
+	uint64_t now = get_sys_clock();
+	uint64_t start = _epoch_starttime;
+	if (now > start + g_silo_epoch_intvl && ATOM_CAS(_epoch_starttime, start, now))
+		ATOM_ADD(_epoch, 1);
+	return _epoch;
+}
+
+RC Silo::validate(TxnManager * txn) {
+#if CC_ALG == SILO
+	uint64_t starttime = get_sys_clock();
+	uint64_t cnt = txn->get_access_cnt();
+	txn->set_end_timestamp(UINT64_MAX);
+	txn->mark_write_set();
+
+	// Phase 1: lock the write set. Remote participants hold these locks
+	// across the 2PC round trip, so a busy lock aborts instead of waiting.
+	for (uint64_t i = 0; i < cnt; i++) {
+		if (!txn->txn->accesses[i]->first_write)
+			continue;
+		if (!txn->get_access_original_row(i)->manager->try_lock()) {
+			txn->unlock_write_set(i);
+			INC_STATS(txn->get_thd_id(),silo_lock_abort_cnt,1);
+			INC_STATS(txn->get_thd_id(),silo_validate_time,get_sys_clock() - starttime);
+			return Abort;
+		}
+	}
+
+	// Phase 2: the epoch must be read after all locks are taken
+	__sync_synchronize();
+	uint64_t epoch = get_epoch();
+
+	// Phase 3: every row must still be at the version we read
+	uint64_t max_tid = 0;
+	for (uint64_t i = 0; i < cnt; i++) {
+		row_t * row = txn->get_access_original_row(i);
+		uint64_t tid = txn->txn->accesses[i]->tid;
+		if (!row->manager->validate(tid, txn->txn->accesses[i]->row_written)) {
+			txn->unlock_write_set(cnt);
+			INC_STATS(txn->get_thd_id(),silo_validate_abort_cnt,1);
+			INC_STATS(txn->get_thd_id(),silo_validate_time,get_sys_clock() - starttime);
+			return Abort;
+		}
+		if (tid > max_tid)
+			max_tid = tid;
+	}
+
+	// the commit TID is larger than any TID read or overwritten, larger than
+	// this thread's last TID and within the current epoch
+	uint64_t & last_tid = _last_tid[txn->get_thd_id() * SILO_TID_STRIDE];
+	uint64_t commit_tid = max(max_tid, last_tid) + 1;
+	if (commit_tid < (epoch << SILO_EPOCH_SHIFT))
+		commit_tid = epoch << SILO_EPOCH_SHIFT;
+	last_tid = commit_tid;
+	txn->set_end_timestamp(commit_tid);
+
+	INC_STATS(txn->get_thd_id(),silo_validate_time,get_sys_clock() - starttime);
+#endif
+	return RCOK;
+}
+
+void Silo::finish(RC rc, TxnManager * txn) {
+#if CC_ALG == SILO
+	// only a validated txn holds its write locks
+	uint64_t commit_tid = txn->get_end_timestamp();
+	if (commit_tid == UINT64_MAX)
+		return;
+	uint64_t cnt = txn->get_access_cnt();
+	if (rc == Abort) {
+		txn->unlock_write_set(cnt);
+	} else {
+		// if a row was written twice, the last access holds its final image
+		for (uint64_t i = 0; i < cnt; i++) {
+			if (txn->txn->accesses[i]->last_write)
+				txn->get_access_original_row(i)->manager->write(txn->txn->accesses[i]->data, commit_tid);
+		}
+	}
+	txn->set_end_timestamp(UINT64_MAX);
+#endif
+}
@@ -0,0 +1,46 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _SILO_H_
+#define _SILO_H_
+
+#include "row.h"
+
+class TxnManager;
+
+// A TID is (epoch << SILO_EPOCH_SHIFT | seq). TIDs only ever grow on a row,
+// so validation just checks that a row still carries the TID it was read at.
+#define SILO_EPOCH_SHIFT 32
+
+// Silo-style OCC. Commit locks the write set, reads the current epoch,
+// validates the read set against the row TID words and picks a TID larger
+// than anything it observed. No central critical section or history.
+class Silo {
+public:
+	void init();
+	RC validate(TxnManager * txn);
+	// install or drop the writes of a validated txn and release its locks
+	void finish(RC rc, TxnManager * txn);
+private:
+	uint64_t get_epoch();
+
+	volatile uint64_t _epoch;
+	volatile uint64_t _epoch_starttime;
+	// last TID handed out by each thread, one cache line apart
+	uint64_t * _last_tid;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "txn.h"
+#include "tictoc.h"
+#include "row_tictoc.h"
+
+RC TicToc::validate(TxnManager * txn) {
+#if CC_ALG == TICTOC
+	uint64_t starttime = get_sys_clock();
+	uint64_t cnt = txn->get_access_cnt();
+	RC rc = RCOK;
+	txn->set_end_timestamp(UINT64_MAX);
+	txn->mark_write_set();
+	// once RPREPARE is out, every partition must commit at the same timestamp
+	bool fixed_ts = !IS_LOCAL(txn->get_txn_id()) || txn->is_multi_part();
+	uint64_t commit_ts = txn->get_commit_timestamp();
+
+	// Phase 1: lock the write set without waiting, as remote participants
+	// hold these locks across the 2PC round trip
+	uint64_t locked = 0;
+	for (; locked < cnt; locked++) {
+		if (!txn->txn->accesses[locked]->first_write)
+			continue;
+		if (!txn->get_access_original_row(locked)->manager->try_lock()) {
+			INC_STATS(txn->get_thd_id(),tictoc_lock_abort_cnt,1);
+			rc = Abort;
+			break;
+		}
+	}
+
+	// Phase 2: the commit timestamp must be past the rts of every row written
+	for (uint64_t i = 0; i < cnt && rc == RCOK; i++) {
+		if (txn->get_access_type(i) != WR)
+			continue;
+		Row_tictoc * man = txn->get_access_original_row(i)->manager;
+		if (man->get_wts() != txn->txn->accesses[i]->wts) {
+			rc = Abort;
+		} else if (man->get_rts() >= commit_ts) {
+			if (fixed_ts)
+				rc = Abort;
+			else
+				commit_ts = man->get_rts() + 1;
+		}
+	}
+
+	// Phase 3: every read must stay valid up to the commit timestamp
+	for (uint64_t i = 0; i < cnt && rc == RCOK; i++) {
+		row_t * row = txn->get_access_original_row(i);
+		if (txn->get_access_type(i) == WR)
+			continue;
+		uint64_t wts = txn->txn->accesses[i]->wts;
+		// a row we also write is locked by us and is overwritten at commit.
+		// A version read as valid through commit_ts needs no extension.
+		if (txn->txn->accesses[i]->row_written) {
+			if (row->manager->get_wts() != wts)
+				rc = Abort;
+		} else if (txn->txn->accesses[i]->rts < commit_ts
+				&& !row->manager->extend(wts, commit_ts)) {
+			rc = Abort;
+		}
+	}
+
+	if (rc == Abort) {
+		txn->unlock_write_set(locked);
+		if (locked == cnt)
+			INC_STATS(txn->get_thd_id(),tictoc_validate_abort_cnt,1);
+	} else {
+		txn->set_commit_timestamp(commit_ts);
+		txn->set_end_timestamp(commit_ts);
+	}
+	INC_STATS(txn->get_thd_id(),tictoc_validate_time,get_sys_clock() - starttime);
+	return rc;
+#else
+	return RCOK;
+#endif
+}
+
+void TicToc::finish(RC rc, TxnManager * txn) {
+#if CC_ALG == TICTOC
+	// only a validated txn holds its write locks
+	uint64_t commit_ts = txn->get_end_timestamp();
+	if (commit_ts == UINT64_MAX)
+		return;
+	uint64_t cnt = txn->get_access_cnt();
+	if (rc == Abort) {
+		txn->unlock_write_set(cnt);
+	} else {
+		// if a row was written twice, the last access holds its final image
+		for (uint64_t i = 0; i < cnt; i++) {
+			if (txn->txn->accesses[i]->last_write)
+				txn->get_access_original_row(i)->manager->write(txn->txn->accesses[i]->data, commit_ts);
+		}
+	}
+	txn->set_end_timestamp(UINT64_MAX);
+#endif
+}
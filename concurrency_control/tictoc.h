@@ -0,0 +1,38 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _TICTOC_H_
+#define _TICTOC_H_
+
+#include "row.h"
+
+class TxnManager;
+
+// TicToc: the commit timestamp is computed from the wts/rts of the rows a
+// txn touched instead of being allocated up front. During execution
+// txn->commit_timestamp collects the lower bound (max read wts, max write
+// rts + 1), including the bounds reported by remote partitions. Validation
+// locks the write set and extends the rts of every read up to the commit
+// timestamp. A multi-partition txn ships its commit timestamp in RPREPARE,
+// and from then on no partition may move it.
+class TicToc {
+public:
+	RC validate(TxnManager * txn);
+	// install or drop the writes of a validated txn and release its locks
+	void finish(RC rc, TxnManager * txn);
+};
+
+#endif
@@ -20,6 +20,13 @@
 
 #define LOAD_METHOD LOAD_MAX
 #define LOAD_PER_SERVER 100
+// [LOAD_OPEN] arrival process; sends follow their schedule whatever the
+// response times, and latency is measured from the scheduled send time
+#define ARRIVAL_DIST ARRIVAL_POISSON
+// [ARRIVAL_BURSTY] arrivals only come in the on periods, at the rate that
+// keeps the average at LOAD_PER_SERVER
+#define BURST_ON_TIME 100 * MILLION
+#define BURST_OFF_TIME 400 * MILLION
 
 // Replication
 #define REPLICA_CNT 0
@@ -64,6 +71,25 @@
 #define THREAD_ARENA_SIZE     (1UL << 22) 
 #define MEM_PAD           true
 
+// [TXN_ARENA]
+// row copies and access records of a txn are bump-allocated from its arena,
+// which is rewound when the txn resets. Requests above TXN_ARENA_MAX_ALLOC
+// fall back to mem_allocator.
+#define TXN_ARENA_SIZE        (1UL << 16)
+#define TXN_ARENA_MAX_ALLOC   (TXN_ARENA_SIZE / 4)
+
+// [NUMA]
+// NUMA_PLACEMENT pins every thread by NUMA node (c.f. numa.h), gives each
+// thread a jemalloc arena on its node and allocates each partition's rows,
+// row managers and index entries on the node that serves it. It replaces
+// SET_AFFINITY.
+#define NUMA_PLACEMENT        false
+// node of the worker threads; -1 spreads them over all nodes
+#define NUMA_WORKER_NODE      -1
+#define NUMA_IO_NODE          0
+// node of the log, checkpoint, abort and Calvin threads
+#define NUMA_AUX_NODE         0
+
 // [PART_ALLOC] 
 #define PART_ALLOC          false
 #define MEM_SIZE          (1UL << 30) 
@@ -90,14 +116,22 @@
 #define MAX_QUEUE_LEN NODE_CNT * 2
 
 #define PRIORITY_WORK_QUEUE false
+// PRIORITY_FCFS, PRIORITY_ACTIVE, PRIORITY_HOME, PRIORITY_TS
 #define PRIORITY PRIORITY_ACTIVE
 #define MSG_SIZE_MAX 4096
 #define MSG_TIME_LIMIT 0
+// max messages a send thread takes off its queue per pass
+#define MSG_DEQUEUE_MAX 16
+// idle threads spin for IDLE_SPIN_CNT empty polls, then sleep until new work
+// arrives or IDLE_PARK_TIMEOUT passes
+#define IDLE_PARK false
+#define IDLE_SPIN_CNT 1000
+#define IDLE_PARK_TIMEOUT 1000000UL // in ns
 
 /***********************************************/
 // Concurrency Control
 /***********************************************/
-// WAIT_DIE, NO_WAIT, TIMESTAMP, MVCC, CALVIN, MAAT
+// WAIT_DIE, NO_WAIT, DL_DETECT, TIMESTAMP, MVCC, CALVIN, MAAT, SILO, TICTOC
 #define CC_ALG TIMESTAMP
 #define ISOLATION_LEVEL SERIALIZABLE
 #define YCSB_ABORT_MODE false
@@ -114,11 +148,18 @@
 #define BACKOFF true
 // [ INDEX ]
 #define ENABLE_LATCH        false
+// index_btree: optimistic lock coupling with per-node versions; readers
+// never write shared memory. Takes over from ENABLE_LATCH when true.
+#define BTREE_OLC           true
 #define CENTRAL_INDEX       false
 #define CENTRAL_MANAGER       false
+// IDX_HASH, IDX_BTREE, IDX_OPEN_HASH
 #define INDEX_STRUCT        IDX_HASH
 #define BTREE_ORDER         16
 
+// [DL_DETECT]
+// how often the waits-for edges are exchanged and searched for cycles
+#define DL_DETECT_INTVL     1 * 1000000UL // in ns
 // [TIMESTAMP]
 #define TS_TWR            false
 #define TS_ALLOC          TS_CLOCK
@@ -131,13 +172,26 @@
 #define MAX_PRE_REQ         MAX_TXN_IN_FLIGHT * NODE_CNT//1024
 #define MAX_READ_REQ        MAX_TXN_IN_FLIGHT * NODE_CNT//1024
 #define MIN_TS_INTVL        10 * 1000000UL // 10ms
+// read-only txns read a snapshot just below the oldest active txn, so they
+// never register their reads, wait or abort
+#define MVCC_SNAPSHOT_READ    true
+// versions each thread keeps around for reuse
+#define MVCC_VERSION_POOL_SIZE  1024
 // [OCC]
 #define MAX_WRITE_SET       10
 #define PER_ROW_VALID       false
+// [SILO]
+#define SILO_EPOCH_INTVL    40 * 1000000UL // in ns
 // [VLL] 
 #define TXN_QUEUE_SIZE_LIMIT    THREAD_CNT
 // [CALVIN]
-#define SEQ_THREAD_CNT 4 
+// sequencer threads; each fills its own sub-batch of the epoch
+#define SEQ_THREAD_CNT 1
+// epochs that can be filling or executing at once
+#define SEQ_EPOCH_WINDOW 64
+// lock threads; each one acquires the locks of one slice of the rows.
+// Lock thread 0 still resolves the rows of every txn.
+#define CALVIN_LOCK_THREAD_CNT 1
 
 /***********************************************/
 // Logging
@@ -145,14 +199,35 @@
 #define LOG_COMMAND         false
 #define LOG_REDO          false
 #define LOGGING false
-#define LOG_BUF_MAX 10
+// replay logfile.log into the freshly loaded tables before starting
+#define LOG_RECOVER false
+// group commit: a group is written and fdatasync'ed once it holds
+// LOG_BUF_MAX bytes or LOG_BUF_TIMEOUT has passed since the last flush
+#define LOG_BUF_MAX (256 * 1024)
 #define LOG_BUF_TIMEOUT 10 * 1000000UL // 10ms
+// per-thread log buffer size, in bytes and in txns waiting for a flush
+#define LOG_THD_BUF_SIZE (1024 * 1024)
+#define LOG_THD_NOTIFY_CNT 4096
+
+/***********************************************/
+// Checkpointing
+/***********************************************/
+// a background thread writes a fuzzy image of all rows to
+// checkpoint_<node>.ckpt every CKPT_INTERVAL
+#define CHECKPOINT false
+#define CKPT_INTERVAL 10 * 1000000000UL // 10s
+// build the tables from the checkpoint, if there is one, instead of
+// generating them; LOG_RECOVER then replays the log from its lsn
+#define CKPT_LOAD false
+// load the tables from snapshot_<node>_<config key>.img, or generate them
+// and save that snapshot if there is none
+#define SNAPSHOT_LOAD false
 
 /***********************************************/
 // Benchmark
 /***********************************************/
 // max number of rows touched per transaction
-#define MAX_ROW_PER_TXN       64
+#define MAX_ROW_PER_TXN       512
 #define QUERY_INTVL         1UL
 #define MAX_TXN_PER_PART 500000
 #define FIRST_PART_LOCAL      true
@@ -187,6 +262,9 @@
 #define MAX_ITEMS_NORM 100000
 #define CUST_PER_DIST_NORM 3000
 #define MAX_ITEMS_PER_TXN 15
+// orders NewOrder may insert per district over a run; the open hash
+// indexes cannot grow, so the order tables are sized for them up front
+#define TPCC_INSERTS_PER_DIST 30000
 // Some of the transactions read the data but never use them. 
 // If TPCC_ACCESS_ALL == fales, then these parts of the transactions
 // are not modeled.
@@ -215,7 +293,13 @@ enum TPCCTxnType {TPCC_ALL,
 extern TPCCTxnType          g_tpcc_txn_type;
 
 //#define TXN_TYPE          TPCC_ALL
-#define PERC_PAYMENT 0.0
+// the rest of the mix is NewOrder
+#define PERC_PAYMENT 0.43
+#define PERC_ORDER_STATUS 0.04
+#define PERC_DELIVERY 0.04
+#define PERC_STOCK_LEVEL 0.04
+// Stock-Level reads the order lines of this many recent orders
+#define STOCK_LEVEL_ORDERS 20
 #define FIRSTNAME_MINLEN      8
 #define FIRSTNAME_LEN         16
 #define LASTNAME_LEN        16
@@ -287,6 +371,7 @@ enum PPSTxnType {PPS_ALL = 0,
 // INDEX_STRUCT
 #define IDX_HASH          1
 #define IDX_BTREE         2
+#define IDX_OPEN_HASH     3
 // WORKLOAD
 #define YCSB            1
 #define TPCC            2
@@ -305,6 +390,8 @@ enum PPSTxnType {PPS_ALL = 0,
 #define CALVIN      10
 #define MAAT      11
 #define WDL           12
+#define SILO          13
+#define TICTOC        14
 // TIMESTAMP allocation method.
 #define TS_MUTEX          1
 #define TS_CAS            2
@@ -324,12 +411,17 @@ enum PPSTxnType {PPS_ALL = 0,
 #define PRIORITY_FCFS 1
 #define PRIORITY_ACTIVE 2
 #define PRIORITY_HOME 3
+#define PRIORITY_TS 4
 // Replication
 #define AA 1
 #define AP 2
 // Load
 #define LOAD_MAX 1
 #define LOAD_RATE 2
+#define LOAD_OPEN 3
+#define ARRIVAL_FIXED 1
+#define ARRIVAL_POISSON 2
+#define ARRIVAL_BURSTY 3
 // Transport
 #define TCP 1
 #define IPC 2
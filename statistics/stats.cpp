@@ -21,6 +21,7 @@
 #include "client_txn.h"
 #include "work_queue.h"
 #include "stats_array.h"
+#include "sim_manager.h"
 #include <time.h>
 #include <sys/times.h>
 #include <sys/vtimes.h>
@@ -36,6 +37,11 @@ void Stats_thd::init(uint64_t thd_id) {
   worker_process_time_by_type= (double *) mem_allocator.align_alloc(sizeof(double) * NO_MSG);
   DEBUG_M("Stats_thd::init mtx alloc\n");
   mtx= (double *) mem_allocator.align_alloc(sizeof(double) * 40);
+  cl_sec_cnt = (g_warmup_timer + g_done_timer) / BILLION + 1;
+  cl_sec_sent_cnt = (uint64_t *) mem_allocator.align_alloc(sizeof(uint64_t) * cl_sec_cnt);
+  cl_sec_txn_cnt = (uint64_t *) mem_allocator.align_alloc(sizeof(uint64_t) * cl_sec_cnt);
+  cl_sec_lat = (double *) mem_allocator.align_alloc(sizeof(double) * cl_sec_cnt);
+  cl_sec_lat_max = (double *) mem_allocator.align_alloc(sizeof(double) * cl_sec_cnt);
 
 	//all_lat.init(g_max_txn_per_part,ArrIncr);
 
@@ -80,6 +86,8 @@ void Stats_thd::clear() {
   txn_index_time=0;
   txn_validate_time=0;
   txn_cleanup_time=0;
+  txn_index_insert_time=0;
+  txn_index_insert_cnt=0;
 
   // Transaction stats
   txn_total_process_time=0;
@@ -94,6 +102,13 @@ void Stats_thd::clear() {
   // Client
   txn_sent_cnt=0;
   cl_send_intv=0;
+  cl_send_lag=0;
+  for(uint64_t i = 0; i < cl_sec_cnt; i++) {
+    cl_sec_sent_cnt[i]=0;
+    cl_sec_txn_cnt[i]=0;
+    cl_sec_lat[i]=0;
+    cl_sec_lat_max[i]=0;
+  }
 
   // Abort queue
   abort_queue_enqueue_cnt=0;
@@ -115,9 +130,14 @@ void Stats_thd::clear() {
   work_queue_enqueue_time=0;
   work_queue_dequeue_time=0;
   work_queue_conflict_cnt=0;
+  work_queue_steal_cnt=0;
 
   // Worker thread
   worker_idle_time=0;
+  idle_park_cnt=0;
+  idle_park_time=0;
+  idle_wakeup_cnt=0;
+  idle_wakeup_time=0;
   worker_activate_txn_time=0;
   worker_deactivate_txn_time=0;
   worker_release_msg_time=0;
@@ -157,6 +177,7 @@ void Stats_thd::clear() {
   twopl_sh_owned_cnt=0;
   twopl_ex_owned_cnt=0;
   twopl_sh_bypass_cnt=0;
+  twopl_slow_path_cnt=0;
   twopl_owned_time=0;
   twopl_sh_owned_time=0;
   twopl_ex_owned_time=0;
@@ -189,6 +210,8 @@ void Stats_thd::clear() {
   sched_queue_enqueue_time=0;
   sched_queue_dequeue_time=0;
   calvin_sched_time=0;
+  calvin_resolve_time=0;
+  calvin_slice_time=0;
   sched_idle_time=0;
   sched_txn_table_time=0;
   sched_epoch_cnt=0;
@@ -208,6 +231,25 @@ void Stats_thd::clear() {
   occ_ts_abort_cnt=0;
   occ_finish_time=0;
 
+  // MVCC
+  mvcc_snapshot_read_cnt=0;
+  mvcc_gc_version_cnt=0;
+  mvcc_version_reuse_cnt=0;
+
+  // SILO
+  silo_validate_time=0;
+  silo_lock_abort_cnt=0;
+  silo_validate_abort_cnt=0;
+
+  // TICTOC
+  tictoc_validate_time=0;
+  tictoc_lock_abort_cnt=0;
+  tictoc_validate_abort_cnt=0;
+  dl_detect_cnt=0;
+  dl_detect_time=0;
+  dl_victim_cnt=0;
+  dl_victim_wait_time=0;
+
   // MAAT
   maat_validate_cnt=0;
   maat_validate_time=0;
@@ -225,9 +267,14 @@ void Stats_thd::clear() {
   log_write_cnt=0;
   log_write_time=0;
   log_flush_cnt=0;
+  log_flush_txn_cnt=0;
   log_flush_time=0;
   log_process_time=0;
 
+  ckpt_cnt=0;
+  ckpt_size=0;
+  ckpt_time=0;
+
   // Transaction Table
   txn_table_new_cnt=0;
   txn_table_get_cnt=0;
@@ -295,10 +342,13 @@ void Stats_thd::clear() {
 void Stats_thd::print_client(FILE * outf, bool prog) {
   double txn_run_avg_time = 0;
   double tput = 0;
+  double cl_send_lag_avg = 0;
   if(txn_cnt > 0)
     txn_run_avg_time = txn_run_time / txn_cnt;
   if(total_runtime > 0) 
     tput = txn_cnt / (total_runtime / BILLION);
+  if(txn_sent_cnt > 0)
+    cl_send_lag_avg = cl_send_lag / txn_sent_cnt;
   fprintf(outf,
       "total_runtime=%f"
       ",tput=%f"
@@ -307,6 +357,8 @@ void Stats_thd::print_client(FILE * outf, bool prog) {
       ",txn_run_time=%f"
       ",txn_run_avg_time=%f"
       ",cl_send_intv=%f"
+      ",cl_send_lag=%f"
+      ",cl_send_lag_avg=%f"
       ,total_runtime/BILLION
       ,tput
       ,txn_cnt
@@ -314,6 +366,8 @@ void Stats_thd::print_client(FILE * outf, bool prog) {
       ,txn_run_time / BILLION
       ,txn_run_avg_time / BILLION
       ,cl_send_intv / BILLION
+      ,cl_send_lag / BILLION
+      ,cl_send_lag_avg / BILLION
   );
   // IO
   double mbuf_send_intv_time_avg = 0;
@@ -422,6 +476,39 @@ void Stats_thd::print_client(FILE * outf, bool prog) {
 
 }
 
+uint64_t Stats_thd::sec_idx(uint64_t time) {
+  uint64_t idx = 0;
+  if(time > simulation->run_starttime)
+    idx = (time - simulation->run_starttime) / BILLION;
+  if(idx >= cl_sec_cnt)
+    idx = cl_sec_cnt - 1;
+  return idx;
+}
+
+// one line per second after the warmup: the load offered, the txns that
+// completed and their latency
+void Stats_thd::print_client_series(FILE * outf) {
+  for(uint64_t i = g_warmup_timer / BILLION; i < cl_sec_cnt; i++) {
+    if(cl_sec_sent_cnt[i] == 0 && cl_sec_txn_cnt[i] == 0)
+      continue;
+    double lat_avg = 0;
+    if(cl_sec_txn_cnt[i] > 0)
+      lat_avg = cl_sec_lat[i] / cl_sec_txn_cnt[i];
+    fprintf(outf,
+        "[series] sec=%ld"
+        ",txn_sent_cnt=%ld"
+        ",txn_cnt=%ld"
+        ",lat_avg=%f"
+        ",lat_max=%f\n"
+        ,i - g_warmup_timer / BILLION
+        ,cl_sec_sent_cnt[i]
+        ,cl_sec_txn_cnt[i]
+        ,lat_avg / BILLION
+        ,cl_sec_lat_max[i] / BILLION
+    );
+  }
+}
+
 void Stats_thd::print(FILE * outf, bool prog) {
   fprintf(outf,
       "total_runtime=%f"
@@ -502,12 +589,16 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ",txn_index_time=%f"
   ",txn_validate_time=%f"
   ",txn_cleanup_time=%f"
+  ",txn_index_insert_time=%f"
+  ",txn_index_insert_cnt=%ld"
   ,ts_alloc_time / BILLION
   ,abort_time / BILLION
   ,txn_manager_time / BILLION
   ,txn_index_time / BILLION
   ,txn_validate_time / BILLION
   ,txn_cleanup_time / BILLION
+  ,txn_index_insert_time / BILLION
+  ,txn_index_insert_cnt
   );
 
   // Transaction stats
@@ -621,6 +712,7 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ",work_queue_enqueue_time=%f"
   ",work_queue_dequeue_time=%f"
   ",work_queue_conflict_cnt=%ld"
+  ",work_queue_steal_cnt=%ld"
   ,work_queue_wait_time / BILLION
   ,work_queue_cnt
   ,work_queue_enq_cnt
@@ -636,6 +728,7 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ,work_queue_enqueue_time / BILLION
   ,work_queue_dequeue_time / BILLION
   ,work_queue_conflict_cnt
+  ,work_queue_steal_cnt
   );
 
 
@@ -670,6 +763,23 @@ void Stats_thd::print(FILE * outf, bool prog) {
     );
   }
 
+  // Idle parking
+  double idle_wakeup_avg_time = 0;
+  if(idle_wakeup_cnt > 0)
+    idle_wakeup_avg_time = idle_wakeup_time / idle_wakeup_cnt;
+  fprintf(outf,
+    ",idle_park_cnt=%ld"
+    ",idle_park_time=%f"
+    ",idle_wakeup_cnt=%ld"
+    ",idle_wakeup_time=%f"
+    ",idle_wakeup_avg_time=%f"
+    ,idle_park_cnt
+    ,idle_park_time / BILLION
+    ,idle_wakeup_cnt
+    ,idle_wakeup_time / BILLION
+    ,idle_wakeup_avg_time / BILLION
+  );
+
   // IO
   double mbuf_send_intv_time_avg = 0;
   double msg_unpack_time_avg = 0;
@@ -764,6 +874,7 @@ void Stats_thd::print(FILE * outf, bool prog) {
     ",twopl_sh_owned_cnt=%ld"
     ",twopl_ex_owned_cnt=%ld"
     ",twopl_sh_bypass_cnt=%ld"
+    ",twopl_slow_path_cnt=%ld"
     ",twopl_owned_time=%f"
     ",twopl_sh_owned_time=%f"
     ",twopl_ex_owned_time=%f"
@@ -780,6 +891,7 @@ void Stats_thd::print(FILE * outf, bool prog) {
     ,twopl_sh_owned_cnt
     ,twopl_ex_owned_cnt
     ,twopl_sh_bypass_cnt
+    ,twopl_slow_path_cnt
     ,twopl_owned_time / BILLION
     ,twopl_sh_owned_time / BILLION
     ,twopl_ex_owned_time / BILLION
@@ -824,6 +936,8 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ",sched_queue_enqueue_time=%f"
   ",sched_queue_dequeue_time=%f"
   ",calvin_sched_time=%f"
+  ",calvin_resolve_time=%f"
+  ",calvin_slice_time=%f"
   ",sched_idle_time=%f"
   ",sched_txn_table_time=%f"
   ",sched_epoch_cnt=%ld"
@@ -851,6 +965,8 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ,sched_queue_enqueue_time /BILLION
   ,sched_queue_dequeue_time /BILLION
   ,calvin_sched_time /BILLION
+  ,calvin_resolve_time /BILLION
+  ,calvin_slice_time /BILLION
   ,sched_idle_time /BILLION
   ,sched_txn_table_time /BILLION
   ,sched_epoch_cnt
@@ -882,6 +998,53 @@ void Stats_thd::print(FILE * outf, bool prog) {
   ,occ_finish_time / BILLION
   );
 
+  //MVCC
+  fprintf(outf,
+  ",mvcc_snapshot_read_cnt=%ld"
+  ",mvcc_gc_version_cnt=%ld"
+  ",mvcc_version_reuse_cnt=%ld"
+  ,mvcc_snapshot_read_cnt
+  ,mvcc_gc_version_cnt
+  ,mvcc_version_reuse_cnt
+  );
+
+  //SILO
+  fprintf(outf,
+  ",silo_validate_time=%f"
+  ",silo_lock_abort_cnt=%ld"
+  ",silo_validate_abort_cnt=%ld"
+  ,silo_validate_time / BILLION
+  ,silo_lock_abort_cnt
+  ,silo_validate_abort_cnt
+  );
+
+  //TICTOC
+  fprintf(outf,
+  ",tictoc_validate_time=%f"
+  ",tictoc_lock_abort_cnt=%ld"
+  ",tictoc_validate_abort_cnt=%ld"
+  ,tictoc_validate_time / BILLION
+  ,tictoc_lock_abort_cnt
+  ,tictoc_validate_abort_cnt
+  );
+
+  //DL_DETECT
+  double dl_victim_avg_wait_time = 0;
+  if(dl_victim_cnt > 0)
+    dl_victim_avg_wait_time = dl_victim_wait_time / dl_victim_cnt;
+  fprintf(outf,
+  ",dl_detect_cnt=%ld"
+  ",dl_detect_time=%f"
+  ",dl_victim_cnt=%ld"
+  ",dl_victim_wait_time=%f"
+  ",dl_victim_avg_wait_time=%f"
+  ,dl_detect_cnt
+  ,dl_detect_time / BILLION
+  ,dl_victim_cnt
+  ,dl_victim_wait_time / BILLION
+  ,dl_victim_avg_wait_time / BILLION
+  );
+
   //MAAT
   double maat_range_avg = 0;
   double maat_validate_avg = 0;
@@ -933,6 +1096,9 @@ void Stats_thd::print(FILE * outf, bool prog) {
   double log_flush_avg_time = 0;
   if(log_flush_cnt > 0)
     log_flush_avg_time = log_flush_time / log_flush_cnt;
+  double log_flush_avg_txn_cnt = 0;
+  if(log_flush_cnt > 0)
+    log_flush_avg_txn_cnt = (double)log_flush_txn_cnt / log_flush_cnt;
   fprintf(outf,
     ",log_write_cnt=%ld"
     ",log_write_time=%f"
@@ -940,6 +1106,8 @@ void Stats_thd::print(FILE * outf, bool prog) {
     ",log_flush_cnt=%ld"
     ",log_flush_time=%f"
     ",log_flush_avg_time=%f"
+    ",log_flush_txn_cnt=%ld"
+    ",log_flush_avg_txn_cnt=%f"
     ",log_process_time=%f"
     ,log_write_cnt
     ,log_write_time / BILLION
@@ -947,9 +1115,26 @@ void Stats_thd::print(FILE * outf, bool prog) {
     ,log_flush_cnt
     ,log_flush_time / BILLION
     ,log_flush_avg_time / BILLION
+    ,log_flush_txn_cnt
+    ,log_flush_avg_txn_cnt
     ,log_process_time / BILLION
   );
 
+  // Checkpointing
+  double ckpt_avg_time = 0;
+  if(ckpt_cnt > 0)
+    ckpt_avg_time = ckpt_time / ckpt_cnt;
+  fprintf(outf,
+    ",ckpt_cnt=%ld"
+    ",ckpt_size=%ld"
+    ",ckpt_time=%f"
+    ",ckpt_avg_time=%f"
+    ,ckpt_cnt
+    ,ckpt_size
+    ,ckpt_time / BILLION
+    ,ckpt_avg_time / BILLION
+  );
+
   // Transaction Table
   double txn_table_get_avg_time = 0;
   if(txn_table_get_cnt > 0)
@@ -1221,6 +1406,8 @@ void Stats_thd::combine(Stats_thd * stats) {
   txn_index_time+=stats->txn_index_time;
   txn_validate_time+=stats->txn_validate_time;
   txn_cleanup_time+=stats->txn_cleanup_time;
+  txn_index_insert_time+=stats->txn_index_insert_time;
+  txn_index_insert_cnt+=stats->txn_index_insert_cnt;
 
   // Transaction stats
   txn_total_process_time+=stats->txn_total_process_time;
@@ -1235,6 +1422,14 @@ void Stats_thd::combine(Stats_thd * stats) {
   // Client
   txn_sent_cnt+=stats->txn_sent_cnt;
   cl_send_intv+=stats->cl_send_intv;
+  cl_send_lag+=stats->cl_send_lag;
+  for(uint64_t i = 0; i < cl_sec_cnt; i++) {
+    cl_sec_sent_cnt[i]+=stats->cl_sec_sent_cnt[i];
+    cl_sec_txn_cnt[i]+=stats->cl_sec_txn_cnt[i];
+    cl_sec_lat[i]+=stats->cl_sec_lat[i];
+    if(stats->cl_sec_lat_max[i] > cl_sec_lat_max[i])
+      cl_sec_lat_max[i]=stats->cl_sec_lat_max[i];
+  }
 
   // Abort queue
   abort_queue_enqueue_cnt+=stats->abort_queue_enqueue_cnt;
@@ -1256,9 +1451,14 @@ void Stats_thd::combine(Stats_thd * stats) {
   work_queue_enqueue_time+=stats->work_queue_enqueue_time;
   work_queue_dequeue_time+=stats->work_queue_dequeue_time;
   work_queue_conflict_cnt+=stats->work_queue_conflict_cnt;
+  work_queue_steal_cnt+=stats->work_queue_steal_cnt;
 
   // Worker thread
   worker_idle_time+=stats->worker_idle_time;
+  idle_park_cnt+=stats->idle_park_cnt;
+  idle_park_time+=stats->idle_park_time;
+  idle_wakeup_cnt+=stats->idle_wakeup_cnt;
+  idle_wakeup_time+=stats->idle_wakeup_time;
   worker_activate_txn_time+=stats->worker_activate_txn_time;
   worker_deactivate_txn_time+=stats->worker_deactivate_txn_time;
   worker_release_msg_time+=stats->worker_release_msg_time;
@@ -1298,6 +1498,7 @@ void Stats_thd::combine(Stats_thd * stats) {
   twopl_sh_owned_cnt+=stats->twopl_sh_owned_cnt;
   twopl_ex_owned_cnt+=stats->twopl_ex_owned_cnt;
   twopl_sh_bypass_cnt+=stats->twopl_sh_bypass_cnt;
+  twopl_slow_path_cnt+=stats->twopl_slow_path_cnt;
   twopl_owned_time+=stats->twopl_owned_time;
   twopl_sh_owned_time+=stats->twopl_sh_owned_time;
   twopl_ex_owned_time+=stats->twopl_ex_owned_time;
@@ -1330,6 +1531,8 @@ void Stats_thd::combine(Stats_thd * stats) {
   sched_queue_enqueue_time+=stats->sched_queue_enqueue_time;
   sched_queue_dequeue_time+=stats->sched_queue_dequeue_time;
   calvin_sched_time+=stats->calvin_sched_time;
+  calvin_resolve_time+=stats->calvin_resolve_time;
+  calvin_slice_time+=stats->calvin_slice_time;
   sched_idle_time+=stats->sched_idle_time;
   sched_txn_table_time+=stats->sched_txn_table_time;
   sched_epoch_cnt+=stats->sched_epoch_cnt;
@@ -1346,6 +1549,23 @@ void Stats_thd::combine(Stats_thd * stats) {
   occ_abort_check_cnt+=stats->occ_abort_check_cnt;
   occ_ts_abort_cnt+=stats->occ_ts_abort_cnt;
   occ_finish_time+=stats->occ_finish_time;
+  // MVCC
+  mvcc_snapshot_read_cnt+=stats->mvcc_snapshot_read_cnt;
+  mvcc_gc_version_cnt+=stats->mvcc_gc_version_cnt;
+  mvcc_version_reuse_cnt+=stats->mvcc_version_reuse_cnt;
+  // SILO
+  silo_validate_time+=stats->silo_validate_time;
+  silo_lock_abort_cnt+=stats->silo_lock_abort_cnt;
+  silo_validate_abort_cnt+=stats->silo_validate_abort_cnt;
+  // TICTOC
+  tictoc_validate_time+=stats->tictoc_validate_time;
+  tictoc_lock_abort_cnt+=stats->tictoc_lock_abort_cnt;
+  tictoc_validate_abort_cnt+=stats->tictoc_validate_abort_cnt;
+  // DL_DETECT
+  dl_detect_cnt+=stats->dl_detect_cnt;
+  dl_detect_time+=stats->dl_detect_time;
+  dl_victim_cnt+=stats->dl_victim_cnt;
+  dl_victim_wait_time+=stats->dl_victim_wait_time;
 
   // MAAT
   maat_validate_cnt+=stats->maat_validate_cnt;
@@ -1363,9 +1583,14 @@ void Stats_thd::combine(Stats_thd * stats) {
   log_write_cnt+=stats->log_write_cnt;
   log_write_time+=stats->log_write_time;
   log_flush_cnt+=stats->log_flush_cnt;
+  log_flush_txn_cnt+=stats->log_flush_txn_cnt;
   log_flush_time+=stats->log_flush_time;
   log_process_time+=stats->log_process_time;
 
+  ckpt_cnt+=stats->ckpt_cnt;
+  ckpt_size+=stats->ckpt_size;
+  ckpt_time+=stats->ckpt_time;
+
   // Transaction Table
   txn_table_new_cnt+=stats->txn_table_new_cnt;
   txn_table_get_cnt+=stats->txn_table_get_cnt;
@@ -1482,6 +1707,8 @@ void Stats::print_client(bool prog) {
       }
       printf("\n");
     } else {
+      fprintf(outf,"\n");
+      totals->print_client_series(outf);
 
       /*
       uint64_t tid = 0;
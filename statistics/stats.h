@@ -38,7 +38,10 @@ public:
 	void combine(Stats_thd * stats);
 	void print(FILE * outf, bool prog);
 	void print_client(FILE * outf, bool prog);
+	void print_client_series(FILE * outf);
 	void clear();
+	// index of the second of the run that time falls in
+	uint64_t sec_idx(uint64_t time);
 
 	char _pad2[CL_SIZE];
   
@@ -82,6 +85,14 @@ public:
   // Client
   uint64_t txn_sent_cnt;
   double cl_send_intv;
+  // [LOAD_OPEN] time sends went out after their scheduled time
+  double cl_send_lag;
+  // per-second series of the run
+  uint64_t cl_sec_cnt;
+  uint64_t * cl_sec_sent_cnt;
+  uint64_t * cl_sec_txn_cnt;
+  double * cl_sec_lat;
+  double * cl_sec_lat_max;
 
   // Breakdown
   double ts_alloc_time;
@@ -90,6 +101,8 @@ public:
   double txn_index_time;
   double txn_validate_time;
   double txn_cleanup_time;
+  double txn_index_insert_time;
+  uint64_t txn_index_insert_cnt;
 
   // Work queue
   double work_queue_wait_time;
@@ -103,6 +116,7 @@ public:
   double work_queue_enqueue_time;
   double work_queue_dequeue_time;
   uint64_t work_queue_conflict_cnt;
+  uint64_t work_queue_steal_cnt;
 
   // Abort queue
   uint64_t abort_queue_enqueue_cnt;
@@ -122,6 +136,12 @@ public:
   uint64_t * worker_process_cnt_by_type;
   double * worker_process_time_by_type;
 
+  // Idle parking
+  uint64_t idle_park_cnt;
+  double idle_park_time;
+  uint64_t idle_wakeup_cnt;
+  double idle_wakeup_time;
+
   // IO
   double msg_queue_delay_time;
   uint64_t msg_queue_cnt;
@@ -152,6 +172,7 @@ public:
   uint64_t twopl_ex_owned_cnt;
   uint64_t twopl_get_cnt;
   uint64_t twopl_sh_bypass_cnt;
+  uint64_t twopl_slow_path_cnt;
   double twopl_owned_time;
   double twopl_sh_owned_time;
   double twopl_ex_owned_time;
@@ -184,6 +205,10 @@ public:
   double sched_queue_enqueue_time;
   double sched_queue_dequeue_time;
   double calvin_sched_time;
+  // lock thread 0 resolving rows and taking its slice's locks, and the
+  // other lock threads taking theirs
+  double calvin_resolve_time;
+  double calvin_slice_time;
   double sched_idle_time;
   double sched_txn_table_time;
   uint64_t sched_epoch_cnt;
@@ -202,6 +227,28 @@ public:
   uint64_t occ_ts_abort_cnt;
   double occ_finish_time;
 
+  // MVCC
+  uint64_t mvcc_snapshot_read_cnt;
+  uint64_t mvcc_gc_version_cnt;
+  uint64_t mvcc_version_reuse_cnt;
+
+  // SILO
+  double silo_validate_time;
+  uint64_t silo_lock_abort_cnt;
+  uint64_t silo_validate_abort_cnt;
+
+  // TICTOC
+  double tictoc_validate_time;
+  uint64_t tictoc_lock_abort_cnt;
+  uint64_t tictoc_validate_abort_cnt;
+
+  // DL_DETECT
+  uint64_t dl_detect_cnt;
+  double dl_detect_time;
+  uint64_t dl_victim_cnt;
+  // from the victim blocking until it was picked
+  double dl_victim_wait_time;
+
   // MAAT
   uint64_t maat_validate_cnt;
   double maat_validate_time;
@@ -218,9 +265,15 @@ public:
   uint64_t log_write_cnt;
   double log_write_time;
   uint64_t log_flush_cnt;
+  uint64_t log_flush_txn_cnt;
   double log_flush_time;
   double log_process_time;
 
+  // Checkpointing
+  uint64_t ckpt_cnt;
+  uint64_t ckpt_size;
+  double ckpt_time;
+
   // Transaction Table
   uint64_t txn_table_new_cnt;
   uint64_t txn_table_get_cnt;
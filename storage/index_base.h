@@ -21,6 +21,9 @@
 
 class table_t;
 
+// called once per (key, item chain) stored in an index
+typedef void (*index_visit_t)(idx_key_t key, itemid_t * item, int part_id, void * arg);
+
 class index_base {
 public:
 	virtual RC 			init() { return RCOK; };
@@ -47,9 +50,19 @@ public:
 
 	// TODO implement index_remove
 	virtual RC 			index_remove(idx_key_t key) { return RCOK; };
+
+	// calls visit for every entry, without blocking concurrent inserts,
+	// which may or may not be seen. Entries with the same key are visited
+	// in the order they were inserted; part_id is -1 for unpartitioned
+	// indexes.
+	virtual void 		index_visit(index_visit_t visit, void * arg)=0;
 	
 	// the index in on "table". The key is the merged key of "fields"
 	table_t * 			table;
+	// position in the schema file; identifies the index in log records
+	uint32_t 			index_id;
+	// rows were added with index_insert_nonunique
+	bool 				nonunique;
 };
 
 #endif
@@ -95,17 +95,48 @@ index_btree::index_read(idx_key_t key,
 	itemid_t *& item, 
 	int part_id) {
 	
-	return index_read(key, item, 0, part_id);
+	return index_read(key, item, part_id, 0);
+}
+
+RC index_btree::index_read(idx_key_t key, int count, itemid_t *& item, int part_id) {
+	glob_param params;
+	assert(part_id != -1);
+	params.part_id = part_id;
+	bt_node * leaf;
+	int idx;
+	if (BTREE_OLC) {
+		item = read_olc(part_id, key, leaf, idx);
+	} else {
+		item = NULL;
+		if (find_leaf(params, key, INDEX_READ, leaf) != RCOK)
+			return Abort;
+		idx = leaf_has_key(leaf, key);
+		if (idx >= 0)
+			item = (itemid_t *)leaf->pointers[idx];
+		release_latch(leaf);
+	}
+	// items of the same key are chained, newest first
+	for (int i = 0; i < count && item != NULL; i++)
+		item = item->next;
+	return RCOK;
 }
 
 RC index_btree::index_read(idx_key_t key, itemid_t *& item, 
-	uint64_t thd_id, int64_t part_id) 
+	int part_id, int thd_id) 
 {
 	RC rc = Abort;
 	glob_param params;
 	assert(part_id != -1);
 	params.part_id = part_id;
 	bt_node * leaf;
+	if (BTREE_OLC) {
+		int idx;
+		item = read_olc(part_id, key, leaf, idx);
+		M_ASSERT_V(item != NULL, "the key does not exist! %ld\n", key);
+		(*cur_leaf_per_thd[thd_id]) = leaf;
+		*cur_idx_per_thd[thd_id] = idx;
+		return RCOK;
+	}
 	find_leaf(params, key, INDEX_READ, leaf);
 	if (leaf == NULL)
 		M_ASSERT(false, "the leaf does not exist!");
@@ -124,11 +155,53 @@ RC index_btree::index_read(idx_key_t key, itemid_t *& item,
 	return rc;
 }
 
+RC index_btree::index_scan(idx_key_t key, uint64_t count, Array<itemid_t *> & items, 
+	int part_id) 
+{
+	glob_param params;
+	assert(part_id != -1);
+	params.part_id = part_id;
+	bt_node * leaf;
+	items.clear();
+	if (BTREE_OLC) {
+		scan_olc(part_id, key, count, items);
+		return RCOK;
+	}
+	if (find_leaf(params, key, INDEX_READ, leaf) != RCOK)
+		return Abort;
+	UInt32 i = 0;
+	while (i < leaf->num_keys && leaf->keys[i] < key)
+		i++;
+	while (items.size() < count) {
+		if (i < leaf->num_keys) {
+			items.add((itemid_t *)leaf->pointers[i++]);
+			continue;
+		}
+		bt_node * next = leaf->next;
+		if (next == NULL)
+			break;
+		// latch the next leaf before letting go of the current one so that
+		// a concurrent split cannot move keys behind the scan
+		if (!latch_node(next, LATCH_SH)) {
+			release_latch(leaf);
+			items.clear();
+			return Abort;
+		}
+		release_latch(leaf);
+		leaf = next;
+		i = 0;
+	}
+	release_latch(leaf);
+	return RCOK;
+}
+
 RC index_btree::index_insert(idx_key_t key, itemid_t * item, int part_id) {
 	glob_param params;
 	if (WORKLOAD == TPCC) assert(part_id != -1);
 	assert(part_id != -1);
 	params.part_id = part_id;
+	if (BTREE_OLC)
+		return insert_olc(params, key, item);
 	// create a tree if there does not exist one already
 	RC rc = RCOK;
 	bt_node * root = find_root(params.part_id);
@@ -174,6 +247,11 @@ RC index_btree::index_insert(idx_key_t key, itemid_t * item, int part_id) {
 	return rc;
 }
 
+RC index_btree::index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id) {
+	// a leaf holds each key once; duplicates are chained off its item
+	return index_insert(key, item, part_id);
+}
+
 RC index_btree::make_lf(uint64_t part_id, bt_node *& node) {
 	RC rc = make_node(part_id, node);
 	if (rc != RCOK) return rc;
@@ -190,11 +268,11 @@ RC index_btree::make_nl(uint64_t part_id, bt_node *& node) {
 
 RC index_btree::make_node(uint64_t part_id, bt_node *& node) {	
 //	printf("make_node(). part_id=%lld\n", part_id);
-	bt_node * new_node = (bt_node *) mem_allocator.alloc(sizeof(bt_node));
+	bt_node * new_node = (bt_node *) mem_allocator.alloc(sizeof(bt_node), part_id);
 	assert (new_node != NULL);
 	new_node->pointers = NULL;
-	new_node->keys = (idx_key_t *) mem_allocator.alloc((order - 1) * sizeof(idx_key_t));
-	new_node->pointers = (void **) mem_allocator.alloc(order * sizeof(void *));
+	new_node->keys = (idx_key_t *) mem_allocator.alloc((order - 1) * sizeof(idx_key_t), part_id);
+	new_node->pointers = (void **) mem_allocator.alloc(order * sizeof(void *), part_id);
 	assert (new_node->keys != NULL && new_node->pointers != NULL);
 	new_node->is_leaf = false;
 	new_node->num_keys = 0;
@@ -203,6 +281,7 @@ RC index_btree::make_node(uint64_t part_id, bt_node *& node) {
 //	new_node->locked = false;
 	new_node->latch = false;
 	new_node->latch_type = LATCH_NONE;
+	new_node->version = 0;
 
 	node = new_node;
 	return RCOK;
@@ -315,6 +394,220 @@ RC index_btree::cleanup(bt_node * node, bt_node * last_ex) {
 	return RCOK;
 }
 
+uint64_t index_btree::read_begin(bt_node * node) {
+	uint64_t v;
+	// an odd version means a writer is modifying the node
+	while ((v = ATOM_LOAD_ACQ(node->version)) & 1) {}
+	return v;
+}
+
+bool index_btree::read_validate(bt_node * node, uint64_t version) {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return node->version == version;
+}
+
+bool index_btree::upgrade_write_lock(bt_node * node, uint64_t version) {
+	return ATOM_CAS(node->version, version, version + 1);
+}
+
+void index_btree::write_lock(bt_node * node) {
+	uint64_t version = node->version;
+	while ((version & 1) || !ATOM_CAS(node->version, version, version + 1))
+		version = node->version;
+}
+
+void index_btree::write_unlock(bt_node * node) {
+	assert(node->version & 1);
+	ATOM_STORE_REL(node->version, node->version + 1);
+}
+
+bt_node * index_btree::lock_parent(bt_node * node) {
+	// node is write locked, so only the holder of its parent's lock can
+	// move it to another parent (split_nl_insert)
+	while (true) {
+		bt_node * parent = node->parent;
+		if (parent == NULL)
+			return NULL;
+		write_lock(parent);
+		if (node->parent == parent)
+			return parent;
+		write_unlock(parent);
+	}
+}
+
+RC index_btree::find_leaf_olc(uint64_t part_id, idx_key_t key, bt_node *& leaf, uint64_t & version) {
+	bt_node * c = ATOM_LOAD_ACQ(roots[part_id]);
+	uint64_t v = read_begin(c);
+	// a root split may have pushed c down before its version was read
+	if (c != ATOM_LOAD_ACQ(roots[part_id]))
+		return Abort;
+	while (!c->is_leaf) {
+		UInt32 i;
+		for (i = 0; i < c->num_keys; i++) {
+			if (key < c->keys[i])
+				break;
+		}
+		bt_node * child = (bt_node *)c->pointers[i];
+		if (!read_validate(c, v))
+			return Abort;
+		uint64_t child_v = read_begin(child);
+		// c must not have changed while the child version was read
+		if (!read_validate(c, v))
+			return Abort;
+		c = child;
+		v = child_v;
+	}
+	leaf = c;
+	version = v;
+	return RCOK;
+}
+
+itemid_t * index_btree::read_olc(uint64_t part_id, idx_key_t key, bt_node *& leaf, int & idx) {
+	while (true) {
+		uint64_t v;
+		if (find_leaf_olc(part_id, key, leaf, v) != RCOK)
+			continue;
+		idx = leaf_has_key(leaf, key);
+		itemid_t * item = idx >= 0 ? (itemid_t *)leaf->pointers[idx] : NULL;
+		if (read_validate(leaf, v))
+			return item;
+	}
+}
+
+void index_btree::scan_olc(uint64_t part_id, idx_key_t key, uint64_t count, Array<itemid_t *> & items) {
+	while (true) {
+		items.clear();
+		bt_node * leaf;
+		uint64_t v;
+		if (find_leaf_olc(part_id, key, leaf, v) != RCOK)
+			continue;
+		UInt32 i = 0;
+		while (i < leaf->num_keys && leaf->keys[i] < key)
+			i++;
+		while (items.size() < count) {
+			if (i < leaf->num_keys) {
+				items.add((itemid_t *)leaf->pointers[i++]);
+				continue;
+			}
+			bt_node * next = leaf->next;
+			// validating the leaf also validates the items taken from it
+			if (next == NULL || !read_validate(leaf, v))
+				break;
+			leaf = next;
+			v = read_begin(leaf);
+			i = 0;
+		}
+		if (read_validate(leaf, v))
+			return;
+	}
+}
+
+void index_btree::index_visit(index_visit_t visit, void * arg) {
+	for (uint64_t part_id = 0; part_id < part_cnt; part_id ++) {
+		if (BTREE_OLC)
+			visit_olc(part_id, visit, arg);
+		else
+			visit_latched(part_id, visit, arg);
+	}
+}
+
+void index_btree::visit_latched(uint64_t part_id, index_visit_t visit, void * arg) {
+	glob_param params;
+	params.part_id = part_id;
+	// the smallest key not visited yet
+	idx_key_t key = 0;
+	bt_node * leaf;
+	while (true) {
+		if (find_leaf(params, key, INDEX_READ, leaf) != RCOK)
+			continue;
+		while (true) {
+			for (UInt32 i = 0; i < leaf->num_keys; i++) {
+				if (leaf->keys[i] < key)
+					continue;
+				visit(leaf->keys[i], (itemid_t *)leaf->pointers[i], part_id, arg);
+				key = leaf->keys[i] + 1;
+			}
+			bt_node * next = leaf->next;
+			if (next == NULL) {
+				release_latch(leaf);
+				return;
+			}
+			// waiting for next while holding leaf could deadlock with a
+			// split; start over from key instead
+			if (!latch_node(next, LATCH_SH))
+				break;
+			release_latch(leaf);
+			leaf = next;
+		}
+		release_latch(leaf);
+	}
+}
+
+void index_btree::visit_olc(uint64_t part_id, index_visit_t visit, void * arg) {
+	idx_key_t * keys = (idx_key_t *) mem_allocator.alloc(order * sizeof(idx_key_t));
+	itemid_t ** items = (itemid_t **) mem_allocator.alloc(order * sizeof(itemid_t *));
+	bt_node * leaf;
+	uint64_t v;
+	while (find_leaf_olc(part_id, 0, leaf, v) != RCOK) {}
+	while (leaf != NULL) {
+		UInt32 cnt = leaf->num_keys;
+		if (cnt >= order)
+			cnt = 0;
+		for (UInt32 i = 0; i < cnt; i++) {
+			keys[i] = leaf->keys[i];
+			items[i] = (itemid_t *)leaf->pointers[i];
+		}
+		bt_node * next = leaf->next;
+		uint64_t next_v = next != NULL ? read_begin(next) : 0;
+		// leaf must not have split before next's version was read, or the
+		// keys it moved to a new sibling would be skipped
+		if (!read_validate(leaf, v)) {
+			v = read_begin(leaf);
+			continue;
+		}
+		for (UInt32 i = 0; i < cnt; i++)
+			visit(keys[i], items[i], part_id, arg);
+		leaf = next;
+		v = next_v;
+	}
+	mem_allocator.free(keys, order * sizeof(idx_key_t));
+	mem_allocator.free(items, order * sizeof(itemid_t *));
+}
+
+RC index_btree::insert_olc(glob_param params, idx_key_t key, itemid_t * item) {
+	bt_node * leaf;
+	uint64_t v;
+	while (true) {
+		if (find_leaf_olc(params.part_id, key, leaf, v) != RCOK)
+			continue;
+		if (upgrade_write_lock(leaf, v))
+			break;
+	}
+	if (leaf->num_keys < order - 1 || leaf_has_key(leaf, key) >= 0) {
+		insert_into_leaf(params, leaf, key, item);
+		write_unlock(leaf);
+		return RCOK;
+	}
+	// the split goes up through every full ancestor. Lock them bottom-up
+	// (writers never wait on a lower node than one they hold) and keep
+	// them locked until the whole split is visible.
+	bt_node * ex_list[100];
+	int depth = 0;
+	ex_list[depth++] = leaf;
+	bt_node * node = leaf;
+	while (node->num_keys == order - 1) {
+		node = lock_parent(node);
+		if (node == NULL)
+			break;
+		ex_list[depth++] = node;
+		assert(depth < 100);
+	}
+	RC rc = split_lf_insert(params, leaf, key, item);
+	for (int i = depth - 1; i >= 0; i--)
+		write_unlock(ex_list[i]);
+	return rc;
+}
+
 RC index_btree::find_leaf(glob_param params, idx_key_t key, idx_acc_t access_type, bt_node *& leaf) {
 	bt_node * last_ex = NULL;
 	assert(access_type != INDEX_INSERT);
@@ -503,13 +796,13 @@ RC index_btree::insert_into_parent(
         return insert_into_new_root(params, left, key, right);
     
 	UInt32 insert_idx = 0;
-	while (parent->keys[insert_idx] < key && insert_idx < parent->num_keys)
+	while (insert_idx < parent->num_keys && parent->keys[insert_idx] < key)
 		insert_idx ++;
 	// the parent has enough space, just insert into it
     if (parent->num_keys < order - 1) {
-		for (UInt32 i = parent->num_keys-1; i >= insert_idx; i--) {
-			parent->keys[i + 1] = parent->keys[i];
-			parent->pointers[i+2] = parent->pointers[i+1];
+		for (UInt32 i = parent->num_keys; i > insert_idx; i--) {
+			parent->keys[i] = parent->keys[i - 1];
+			parent->pointers[i+1] = parent->pointers[i];
 		}
 		parent->num_keys ++;
 		parent->keys[insert_idx] = key;
@@ -544,7 +837,8 @@ RC index_btree::insert_into_new_root(
     right->parent = new_root;
 	left->next = right;
 
-	this->roots[part_id] = new_root;	
+	// readers may pick up the new root at once: publish it after it is built
+	ATOM_STORE_REL(this->roots[part_id], new_root);
 	// TODO this new root is not latched, at this point, other threads
 	// may start to access this new root. Is this ok?
     return RCOK;
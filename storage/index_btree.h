@@ -20,6 +20,7 @@
 #include "global.h"
 #include "helper.h"
 #include "index_base.h"
+#include "array.h"
 
 
 typedef struct bt_node {
@@ -34,6 +35,8 @@ typedef struct bt_node {
 	pthread_mutex_t locked;
 	latch_t latch_type;
 	UInt32 share_cnt;
+	// BTREE_OLC: even when unlocked, odd while a writer modifies the node
+	volatile uint64_t version;
 } bt_node;
 
 struct glob_param {
@@ -46,12 +49,22 @@ public:
 	RC			init(uint64_t part_cnt, table_t * table);
 	bool 		index_exist(idx_key_t key); // check if the key exist. 
 	RC 			index_insert(idx_key_t key, itemid_t * item, int part_id = -1);
-	RC 			index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id = -1) { return RCOK;}
+	RC 			index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id = -1);
 	RC	 		index_read(idx_key_t key, itemid_t * &item, 
-					uint64_t thd_id, int64_t part_id = -1);
+					int part_id = -1, int thd_id = 0);
 	RC	 		index_read(idx_key_t key, itemid_t * &item, int part_id = -1);
+	// returns the count-th item inserted under key, or NULL
+	RC	 		index_read(idx_key_t key, int count, itemid_t * &item, int part_id = -1);
 	RC	 		index_read(idx_key_t key, itemid_t * &item);
 	RC 			index_next(uint64_t thd_id, itemid_t * &item, bool samekey = false);
+	// range scan: fills items with the items of the first count keys >= key,
+	// in key order. Leaves are SH latched hand-over-hand along bt_node::next
+	// (validated by version under BTREE_OLC, which restarts instead).
+	// Returns Abort (with items empty) if a latch could not be taken.
+	RC 			index_scan(idx_key_t key, uint64_t count, Array<itemid_t *> & items,
+					int part_id = -1);
+	// visits the leaves of each partition's tree in key order
+	void 		index_visit(index_visit_t visit, void * arg);
 
 private:
 	// index structures may have part_cnt = 1 or PART_CNT.
@@ -83,6 +96,24 @@ private:
 	// clean up all the LATCH_EX up tp last_ex
 	RC 			cleanup(bt_node * node, bt_node * last_ex);
 
+	// optimistic lock coupling (BTREE_OLC). Readers only read versions and
+	// restart if a node they went through changed; writers lock the leaf
+	// and, for a split, the ancestors it propagates to.
+	uint64_t	read_begin(bt_node * node);
+	bool		read_validate(bt_node * node, uint64_t version);
+	bool		upgrade_write_lock(bt_node * node, uint64_t version);
+	void		write_lock(bt_node * node);
+	void		write_unlock(bt_node * node);
+	// write locks and returns the parent of the write locked node, or NULL
+	bt_node *	lock_parent(bt_node * node);
+	// returns Abort if the traversal has to restart
+	RC			find_leaf_olc(uint64_t part_id, idx_key_t key, bt_node *& leaf, uint64_t & version);
+	itemid_t *	read_olc(uint64_t part_id, idx_key_t key, bt_node *& leaf, int & idx);
+	void		scan_olc(uint64_t part_id, idx_key_t key, uint64_t count, Array<itemid_t *> & items);
+	void		visit_latched(uint64_t part_id, index_visit_t visit, void * arg);
+	void		visit_olc(uint64_t part_id, index_visit_t visit, void * arg);
+	RC			insert_olc(glob_param params, idx_key_t key, itemid_t * item);
+
 	// the leaf and the idx within the leaf that the thread last accessed.
 	bt_node *** cur_leaf_per_thd;
 	UInt32 ** 		cur_idx_per_thd;
@@ -18,6 +18,7 @@
 #include "index_hash.h"
 #include "mem_alloc.h"
 #include "row.h"
+#include "numa.h"
 	
 RC IndexHash::init(uint64_t bucket_cnt) {
 	_bucket_cnt = bucket_cnt;
@@ -26,6 +27,10 @@ RC IndexHash::init(uint64_t bucket_cnt) {
 	//_buckets = new BucketHeader * [g_part_cnt];
 	_buckets = new BucketHeader * [1];
   _buckets[0] = (BucketHeader *) mem_allocator.alloc(sizeof(BucketHeader) * _bucket_cnt_per_part);
+#if NUMA_PLACEMENT
+  // the buckets are shared by all partitions; their nodes are placed by partition
+  numa_map.interleave(_buckets[0], sizeof(BucketHeader) * _bucket_cnt_per_part);
+#endif
   uint64_t buckets_init_cnt = 0;
   for (UInt32 n = 0; n < _bucket_cnt_per_part; n ++) {
 			_buckets[0][n].init();
@@ -56,15 +61,25 @@ bool IndexHash::index_exist(idx_key_t key) {
 
 void 
 IndexHash::get_latch(BucketHeader * bucket) {
-	while (!ATOM_CAS(bucket->locked, false, true)) {}
+	uint64_t version = bucket->version;
+	while ((version & 1) || !ATOM_CAS(bucket->version, version, version + 1))
+		version = bucket->version;
 }
 
 void 
 IndexHash::release_latch(BucketHeader * bucket) {
-	bool ok = ATOM_CAS(bucket->locked, true, false);
-	assert(ok);
+	assert(bucket->version & 1);
+	ATOM_STORE_REL(bucket->version, bucket->version + 1);
 }
 
+void
+IndexHash::read_item(BucketHeader * bucket, idx_key_t key, uint32_t count, itemid_t * &item) {
+	uint64_t version;
+	do {
+		version = bucket->read_begin();
+		bucket->read_item(key, count, item);
+	} while (!bucket->read_validate(version));
+}
 	
 RC IndexHash::index_insert(idx_key_t key, itemid_t * item, int part_id) {
 	RC rc = RCOK;
@@ -105,13 +120,9 @@ RC IndexHash::index_read(idx_key_t key, itemid_t * &item, int part_id) {
 	//BucketHeader * cur_bkt = &_buckets[part_id][bkt_idx];
 	BucketHeader * cur_bkt = &_buckets[0][bkt_idx];
 	RC rc = RCOK;
-	// 1. get the sh latch
-//	get_latch(cur_bkt);
 
-	cur_bkt->read_item(key, item);
-	
-	// 3. release the latch
-//	release_latch(cur_bkt);
+	read_item(cur_bkt, key, 0, item);
+	M_ASSERT_V(item != NULL, "Key does not exist! %ld\n",key);
 	return rc;
 
 }
@@ -122,13 +133,8 @@ RC IndexHash::index_read(idx_key_t key, int count, itemid_t * &item, int part_id
 	//BucketHeader * cur_bkt = &_buckets[part_id][bkt_idx];
 	BucketHeader * cur_bkt = &_buckets[0][bkt_idx];
 	RC rc = RCOK;
-	// 1. get the sh latch
-//	get_latch(cur_bkt);
 
-	cur_bkt->read_item(key, count, item);
-	
-	// 3. release the latch
-//	release_latch(cur_bkt);
+	read_item(cur_bkt, key, count, item);
 	return rc;
 
 }
@@ -141,23 +147,34 @@ RC IndexHash::index_read(idx_key_t key, itemid_t * &item,
 	//BucketHeader * cur_bkt = &_buckets[part_id][bkt_idx];
 	BucketHeader * cur_bkt = &_buckets[0][bkt_idx];
 	RC rc = RCOK;
-	// 1. get the sh latch
-//	get_latch(cur_bkt);
 
-	
-	cur_bkt->read_item(key, item);
-	
-	// 3. release the latch
-//	release_latch(cur_bkt);
+	read_item(cur_bkt, key, 0, item);
+	M_ASSERT_V(item != NULL, "Key does not exist! %ld\n",key);
 	return rc;
 }
 
+void IndexHash::index_visit(index_visit_t visit, void * arg) {
+	vector<BucketNode *> nodes;
+	for (uint64_t i = 0; i < _bucket_cnt_per_part; i++) {
+		// nodes are never unlinked, so the list can be walked unlatched
+		nodes.clear();
+		BucketNode * cur_node = ATOM_LOAD_ACQ(_buckets[0][i].first_node);
+		while (cur_node != NULL) {
+			nodes.push_back(cur_node);
+			cur_node = ATOM_LOAD_ACQ(cur_node->next);
+		}
+		// nonunique inserts add their node at the front
+		for (uint64_t n = nodes.size(); n > 0; n--)
+			visit(nodes[n - 1]->key, ATOM_LOAD_ACQ(nodes[n - 1]->items), -1, arg);
+	}
+}
+
 /************** BucketHeader Operations ******************/
 
 void BucketHeader::init() {
 	node_cnt = 0;
 	first_node = NULL;
-	locked = false;
+	version = 0;
 }
 
 void BucketHeader::delete_bucket() {
@@ -168,7 +185,20 @@ void BucketHeader::delete_bucket() {
 	}
 }
 
+uint64_t BucketHeader::read_begin() {
+	uint64_t v;
+	// an odd version means an insert is in progress
+	while ((v = ATOM_LOAD_ACQ(version)) & 1) {}
+	return v;
+}
 
+bool BucketHeader::read_validate(uint64_t v) {
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return version == v;
+}
+
+// The caller holds the bucket latch. Every pointer a reader can follow is
+// published with a release store after the object it points to is built.
 void BucketHeader::insert_item(idx_key_t key, 
 		itemid_t * item, 
 		int part_id) 
@@ -184,19 +214,20 @@ void BucketHeader::insert_item(idx_key_t key,
 	}
 	if (cur_node == NULL) {		
 		BucketNode * new_node = (BucketNode *) 
-			mem_allocator.alloc(sizeof(BucketNode));		
+			mem_allocator.alloc(sizeof(BucketNode), part_id);		
 		new_node->init(key);
 		new_node->items = item;
 		if (prev_node != NULL) {
 			new_node->next = prev_node->next;
-			prev_node->next = new_node;
+			ATOM_STORE_REL(prev_node->next, new_node);
 		} else {
 			new_node->next = first_node;
-			first_node = new_node;
+			ATOM_STORE_REL(first_node, new_node);
 		}
+		node_cnt ++;
 	} else {
 		item->next = cur_node->items;
-		cur_node->items = item;
+		ATOM_STORE_REL(cur_node->items, item);
 	}
 }
 
@@ -207,32 +238,17 @@ void BucketHeader::insert_item_nonunique(idx_key_t key,
 {
 
   BucketNode * new_node = (BucketNode *) 
-    mem_allocator.alloc(sizeof(BucketNode));		
+    mem_allocator.alloc(sizeof(BucketNode), part_id);		
   new_node->init(key);
   new_node->items = item;
   new_node->next = first_node;
-  first_node = new_node;
-}
-
-void BucketHeader::read_item(idx_key_t key, itemid_t * &item) 
-{
-	BucketNode * cur_node = first_node;
-	while (cur_node != NULL) {
-		if (cur_node->key == key)
-			break;
-		cur_node = cur_node->next;
-	}
-	M_ASSERT_V(cur_node != NULL, "Key does not exist! %ld\n",key);
-	//M_ASSERT(cur_node != NULL, "Key does not exist!");
-	//M_ASSERT(cur_node->key == key, "Key does not exist!");
-  //assert(cur_node != NULL);
-  assert(cur_node->key == key);
-	item = cur_node->items;
+  ATOM_STORE_REL(first_node, new_node);
+  node_cnt ++;
 }
 
 void BucketHeader::read_item(idx_key_t key, uint32_t count, itemid_t * &item) 
 {
-    BucketNode * cur_node = first_node;
+    BucketNode * cur_node = ATOM_LOAD_ACQ(first_node);
     uint32_t ctr = 0;
     while (cur_node != NULL) {
         if (cur_node->key == key) {
@@ -241,13 +257,11 @@ void BucketHeader::read_item(idx_key_t key, uint32_t count, itemid_t * &item)
             }
             ++ctr;
         }
-		cur_node = cur_node->next;
+		cur_node = ATOM_LOAD_ACQ(cur_node->next);
     }
     if (cur_node == NULL) {
         item = NULL;
         return;
     }
-    M_ASSERT_V(cur_node != NULL, "Key does not exist! %ld\n",key);
-    assert(cur_node->key == key);
-	item = cur_node->items;
+	item = ATOM_LOAD_ACQ(cur_node->items);
 }
@@ -37,20 +37,24 @@ public:
 	itemid_t * 		items;
 };
 
-// BucketHeader does concurrency control of Hash
+// BucketHeader does concurrency control of Hash.
+// The version is a seqlock: inserters make it odd while they modify the
+// bucket, readers never write it and retry if it changed under them.
+// Nodes and items are fully built before they are linked in, so a reader
+// racing with an inserter always walks a well-formed list.
 class BucketHeader {
 public:
 	void init();
 	void delete_bucket();
 	void insert_item(idx_key_t key, itemid_t * item, int part_id);
 	void insert_item_nonunique(idx_key_t key, itemid_t * item, int part_id);
-	void read_item(idx_key_t key, itemid_t * &item);
+	// returns the count-th node with this key, or NULL
 	void read_item(idx_key_t key, uint32_t count, itemid_t * &item);
+	uint64_t read_begin();
+	bool read_validate(uint64_t version);
 	BucketNode * 	first_node;
 	uint64_t 		node_cnt;
-	bool 			locked;
-//	latch_t latch_type;
-//	uint32_t share_cnt;
+	volatile uint64_t version;
 };
 
 // TODO Hash index does not support partition yet.
@@ -70,6 +74,7 @@ public:
 	RC	 		index_read(idx_key_t key, int count, itemid_t * &item, int part_id=-1);	
 	RC	 		index_read(idx_key_t key, itemid_t * &item,
 							int part_id=-1, int thd_id=0);
+	void 		index_visit(index_visit_t visit, void * arg);
 
 	// the following call returns a list of items
 //	RC 			index_read(idx_key_t key, Link_Item * &li, uint64_t &item_cnt);
@@ -78,10 +83,10 @@ public:
 //	RC 			index_remove(idx_key_t key);
 
 private:
-//	bool get_latch(BucketHeader * bucket, latch_t latch_type);
-//	bool release_latch(BucketHeader * bucket, latch_t latch_type);
 	void get_latch(BucketHeader * bucket);
 	void release_latch(BucketHeader * bucket);
+	// consistent snapshot read of a bucket, retried on a concurrent insert
+	void read_item(BucketHeader * bucket, idx_key_t key, uint32_t count, itemid_t * &item);
 	// TODO implement more complex hash function
 	uint64_t hash(idx_key_t key) {	
 #if WORKLOAD == YCSB
@@ -0,0 +1,221 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "index_open_hash.h"
+#include "mem_alloc.h"
+#include "row.h"
+#include "numa.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+RC IndexOpenHash::init(uint64_t key_cnt) {
+	assert(sizeof(OpenHashBucket) == CL_SIZE);
+	// keep the load factor at or below 1/2 so probe sequences stay short
+	uint64_t slot_cnt = key_cnt * 2;
+	_bucket_cnt = 16;
+	_hash_shift = 64 - 4;
+	while (_bucket_cnt * OPEN_HASH_SLOTS < slot_cnt) {
+		_bucket_cnt *= 2;
+		_hash_shift --;
+	}
+	_bucket_mask = _bucket_cnt - 1;
+	_parts_per_node = (g_part_cnt + g_node_cnt - 1) / g_node_cnt;
+
+	uint64_t size = sizeof(OpenHashBucket) * _bucket_cnt;
+	_buckets_alloc = mem_allocator.alloc(size + CL_SIZE);
+	_buckets = (OpenHashBucket *) (((uint64_t)_buckets_alloc + CL_SIZE - 1) & ~((uint64_t)CL_SIZE - 1));
+	_latches = (volatile bool *) mem_allocator.alloc(sizeof(bool) * _bucket_cnt);
+#if NUMA_PLACEMENT
+	// keys of all partitions share the buckets
+	numa_map.interleave(_buckets, size);
+	numa_map.interleave((void *)_latches, sizeof(bool) * _bucket_cnt);
+#endif
+	memset(_buckets, 0, size);
+	memset((void *)_latches, 0, sizeof(bool) * _bucket_cnt);
+	printf("Open hash index init with %ld buckets (%ld slots)\n",
+			_bucket_cnt, _bucket_cnt * OPEN_HASH_SLOTS);
+	return RCOK;
+}
+
+RC
+IndexOpenHash::init(int part_cnt, table_t * table, uint64_t key_cnt) {
+	init(key_cnt);
+	this->table = table;
+	return RCOK;
+}
+
+void IndexOpenHash::index_delete() {
+	for (uint64_t n = 0; n < _bucket_cnt; n ++) {
+		for (UInt32 i = 0; i < OPEN_HASH_SLOTS; i ++) {
+			itemid_t * item = _buckets[n].items[i];
+			if (item != NULL && item != OPEN_HASH_BUSY)
+				((row_t *)item->location)->free_row();
+		}
+	}
+	mem_allocator.free(_buckets_alloc, sizeof(OpenHashBucket) * _bucket_cnt + CL_SIZE);
+	mem_allocator.free((void *)_latches, sizeof(bool) * _bucket_cnt);
+}
+
+bool IndexOpenHash::index_exist(idx_key_t key) {
+	return find(key, 0) != NULL;
+}
+
+void
+IndexOpenHash::get_latch(uint64_t bkt_idx) {
+	while (!ATOM_CAS(_latches[bkt_idx], false, true)) {}
+}
+
+void
+IndexOpenHash::release_latch(uint64_t bkt_idx) {
+	bool ok = ATOM_CAS(_latches[bkt_idx], true, false);
+	assert(ok);
+}
+
+uint32_t IndexOpenHash::match_keys(OpenHashBucket * bucket, idx_key_t key) {
+#ifdef __SSE2__
+	// SSE2 has no 64-bit compare: compare 32-bit halves and AND each pair
+	__m128i k = _mm_set1_epi64x(key);
+	__m128i lo = _mm_cmpeq_epi32(_mm_load_si128((__m128i *) &bucket->keys[0]), k);
+	__m128i hi = _mm_cmpeq_epi32(_mm_load_si128((__m128i *) &bucket->keys[2]), k);
+	lo = _mm_and_si128(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(2, 3, 0, 1)));
+	hi = _mm_and_si128(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_movemask_pd(_mm_castsi128_pd(lo))
+		| (_mm_movemask_pd(_mm_castsi128_pd(hi)) << 2);
+#else
+	uint32_t mask = 0;
+	for (UInt32 i = 0; i < OPEN_HASH_SLOTS; i ++)
+		if (bucket->keys[i] == key)
+			mask |= 1 << i;
+	return mask;
+#endif
+}
+
+itemid_t * IndexOpenHash::find(idx_key_t key, uint32_t count) {
+	uint64_t bkt_idx = hash(key);
+	for (uint64_t n = 0; n < _bucket_cnt; n ++) {
+		OpenHashBucket * cur_bkt = &_buckets[(bkt_idx + n) & _bucket_mask];
+		uint32_t mask = match_keys(cur_bkt, key);
+		while (mask != 0) {
+			uint32_t i = __builtin_ctz(mask);
+			mask &= mask - 1;
+			// the item is published after the key, so re-check the key once
+			// the item is visible
+			itemid_t * item = ATOM_LOAD_ACQ(cur_bkt->items[i]);
+			if (item == NULL || item == OPEN_HASH_BUSY || cur_bkt->keys[i] != key)
+				continue;
+			if (count == 0)
+				return item;
+			count --;
+		}
+		for (UInt32 i = 0; i < OPEN_HASH_SLOTS; i ++)
+			if (cur_bkt->items[i] == NULL)
+				return NULL;
+	}
+	return NULL;
+}
+
+void IndexOpenHash::insert_slot(uint64_t bkt_idx, idx_key_t key, itemid_t * item) {
+	for (uint64_t n = 0; n < _bucket_cnt; n ++) {
+		OpenHashBucket * cur_bkt = &_buckets[(bkt_idx + n) & _bucket_mask];
+		for (UInt32 i = 0; i < OPEN_HASH_SLOTS; i ++) {
+			if (cur_bkt->items[i] != NULL)
+				continue;
+			// inserters from other home buckets may race for the same slot
+			if (!ATOM_CAS(cur_bkt->items[i], (itemid_t *) NULL, OPEN_HASH_BUSY))
+				continue;
+			cur_bkt->keys[i] = key;
+			ATOM_STORE_REL(cur_bkt->items[i], item);
+			return;
+		}
+	}
+	M_ASSERT(false, "open hash index is full!");
+}
+
+RC IndexOpenHash::index_insert(idx_key_t key, itemid_t * item, int part_id) {
+	uint64_t bkt_idx = hash(key);
+	// all inserts of a key share its home bucket, which makes the
+	// lookup-then-insert below atomic
+	get_latch(bkt_idx);
+	for (uint64_t n = 0; n < _bucket_cnt; n ++) {
+		OpenHashBucket * cur_bkt = &_buckets[(bkt_idx + n) & _bucket_mask];
+		uint32_t mask = match_keys(cur_bkt, key);
+		bool has_empty = false;
+		for (UInt32 i = 0; i < OPEN_HASH_SLOTS; i ++) {
+			itemid_t * old_item = ATOM_LOAD_ACQ(cur_bkt->items[i]);
+			if (old_item == NULL) {
+				has_empty = true;
+			} else if ((mask & (1 << i)) && old_item != OPEN_HASH_BUSY
+					&& cur_bkt->keys[i] == key) {
+				// the key exists: chain the new item in front of the old ones
+				item->next = old_item;
+				ATOM_STORE_REL(cur_bkt->items[i], item);
+				release_latch(bkt_idx);
+				return RCOK;
+			}
+		}
+		if (has_empty)
+			break;
+	}
+	insert_slot(bkt_idx, key, item);
+	release_latch(bkt_idx);
+	return RCOK;
+}
+
+RC IndexOpenHash::index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id) {
+	insert_slot(hash(key), key, item);
+	return RCOK;
+}
+
+RC IndexOpenHash::index_read(idx_key_t key, itemid_t * &item, int part_id) {
+	item = find(key, 0);
+	M_ASSERT_V(item != NULL, "Key does not exist! %ld\n",key);
+	return RCOK;
+}
+
+RC IndexOpenHash::index_read(idx_key_t key, int count, itemid_t * &item, int part_id) {
+	item = find(key, count);
+	return RCOK;
+}
+
+RC IndexOpenHash::index_read(idx_key_t key, itemid_t * &item,
+						int part_id, int thd_id) {
+	item = find(key, 0);
+	M_ASSERT_V(item != NULL, "Key does not exist! %ld\n",key);
+	return RCOK;
+}
+
+void IndexOpenHash::index_visit(index_visit_t visit, void * arg) {
+	// start right after a bucket with an empty slot: no probe sequence
+	// wraps around past it, so slots of a key are met in probe order
+	uint64_t start = 0;
+	for (uint64_t n = 0; n < _bucket_cnt; n ++) {
+		if (_buckets[n].items[OPEN_HASH_SLOTS - 1] == NULL) {
+			start = n + 1;
+			break;
+		}
+	}
+	for (uint64_t n = 0; n < _bucket_cnt; n ++) {
+		OpenHashBucket * cur_bkt = &_buckets[(start + n) & _bucket_mask];
+		for (UInt32 i = 0; i < OPEN_HASH_SLOTS; i ++) {
+			itemid_t * item = ATOM_LOAD_ACQ(cur_bkt->items[i]);
+			if (item == NULL || item == OPEN_HASH_BUSY)
+				continue;
+			visit(cur_bkt->keys[i], item, -1, arg);
+		}
+	}
+}
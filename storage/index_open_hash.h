@@ -0,0 +1,96 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _INDEX_OPEN_HASH_H_
+#define _INDEX_OPEN_HASH_H_
+
+#include "global.h"
+#include "helper.h"
+#include "index_base.h"
+
+// number of (key, item) slots that fit in one cache line
+#define OPEN_HASH_SLOTS 4
+// marks a slot that has been claimed by an inserter but not yet published
+#define OPEN_HASH_BUSY ((itemid_t *) 1)
+
+// Each OpenHashBucket stores its keys and items inline in a single cache line,
+// so a lookup that hits its home bucket costs one cache miss. A slot is empty
+// iff its item is NULL. Slots are never freed, so a reader may stop probing
+// at the first bucket that has an empty slot.
+class OpenHashBucket {
+public:
+	idx_key_t 		keys[OPEN_HASH_SLOTS];
+	itemid_t * 		items[OPEN_HASH_SLOTS];
+} __attribute__ ((aligned(CL_SIZE)));
+
+// Open addressing hash index with linear probing over cache-line buckets.
+// Readers never write shared memory. Unique inserts are serialized per home
+// bucket (so a key is only added once); slots are claimed with a CAS.
+class IndexOpenHash : public index_base
+{
+public:
+	RC 			init(uint64_t key_cnt);
+	RC 			init(int part_cnt,
+					table_t * table,
+					uint64_t key_cnt);
+	void 		index_delete();
+	bool 		index_exist(idx_key_t key); // check if the key exist.
+	RC 			index_insert(idx_key_t key, itemid_t * item, int part_id=-1);
+	RC 			index_insert_nonunique(idx_key_t key, itemid_t * item, int part_id=-1);
+	// the following call returns a single item
+	RC	 		index_read(idx_key_t key, itemid_t * &item, int part_id=-1);
+	// returns the count-th item inserted with index_insert_nonunique, or NULL
+	RC	 		index_read(idx_key_t key, int count, itemid_t * &item, int part_id=-1);
+	RC	 		index_read(idx_key_t key, itemid_t * &item,
+							int part_id=-1, int thd_id=0);
+	// visits the slots in probe order
+	void 		index_visit(index_visit_t visit, void * arg);
+
+private:
+	void 		get_latch(uint64_t bkt_idx);
+	void 		release_latch(uint64_t bkt_idx);
+	// insert into the first free slot on the probe sequence of key
+	void 		insert_slot(uint64_t bkt_idx, idx_key_t key, itemid_t * item);
+	// returns the count-th published item with this key, or NULL
+	itemid_t * 	find(idx_key_t key, uint32_t count);
+	// bitmask of the slots in bucket whose key equals key
+	uint32_t 	match_keys(OpenHashBucket * bucket, idx_key_t key);
+	uint64_t 	hash(idx_key_t key) {
+#if WORKLOAD == YCSB
+		// The keys of this node are dense once numbered by their row within
+		// the partition and by the partition among the node's own ones, so
+		// consecutive numbers get consecutive buckets. Numbering by the row
+		// alone would put the same row of every local partition in one bucket.
+		uint64_t part = key % g_part_cnt;
+		return ((key / g_part_cnt) * _parts_per_node + part / g_node_cnt) & _bucket_mask;
+#else
+		// Fibonacci hashing breaks up the structured TPCC/PPS keys
+		return (key * 0x9E3779B97F4A7C15UL) >> _hash_shift;
+#endif
+	}
+
+	OpenHashBucket * 	_buckets;
+	void * 				_buckets_alloc;
+	// latches live apart from the buckets so readers never share a line with them
+	volatile bool * 	_latches;
+	uint64_t	 		_bucket_cnt;
+	uint64_t 			_bucket_mask;
+	uint32_t 			_hash_shift;
+	// [YCSB] most partitions any node holds
+	uint64_t 			_parts_per_node;
+};
+
+#endif
@@ -24,8 +24,11 @@
 #include "row_mvcc.h"
 #include "row_occ.h"
 #include "row_maat.h"
+#include "row_silo.h"
+#include "row_tictoc.h"
 #include "mem_alloc.h"
 #include "manager.h"
+#include "pool.h"
 
 #define SIM_FULL_ROW true
 
@@ -38,13 +41,24 @@ row_t::init(table_t * host_table, uint64_t part_id, uint64_t row_id) {
 	Catalog * schema = host_table->get_schema();
 	tuple_size = schema->get_tuple_size();
 #if SIM_FULL_ROW
-	data = (char *) mem_allocator.alloc(sizeof(char) * tuple_size);
+	data = (char *) mem_allocator.alloc(sizeof(char) * tuple_size, part_id);
 #else
-	data = (char *) mem_allocator.alloc(sizeof(uint64_t) * 1);
+	data = (char *) mem_allocator.alloc(sizeof(uint64_t) * 1, part_id);
 #endif
 	return RCOK;
 }
 
+RC 
+row_t::init(table_t * host_table, uint64_t part_id, uint64_t row_id, char * data) {
+	part_info = true;
+	_row_id = row_id;
+	_part_id = part_id;
+	this->table = host_table;
+	tuple_size = host_table->get_schema()->get_tuple_size();
+	this->data = data;
+	return RCOK;
+}
+
 RC 
 row_t::switch_schema(table_t * host_table) {
 	this->table = host_table;
@@ -56,16 +70,20 @@ void row_t::init_manager(row_t * row) {
   return;
 #endif
   DEBUG_M("row_t::init_manager alloc \n");
-#if CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN
-    manager = (Row_lock *) mem_allocator.align_alloc(sizeof(Row_lock));
+#if CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == CALVIN || CC_ALG == DL_DETECT
+    manager = (Row_lock *) mem_allocator.align_alloc(sizeof(Row_lock), get_part_id());
 #elif CC_ALG == TIMESTAMP
-    manager = (Row_ts *) mem_allocator.align_alloc(sizeof(Row_ts));
+    manager = (Row_ts *) mem_allocator.align_alloc(sizeof(Row_ts), get_part_id());
 #elif CC_ALG == MVCC
-    manager = (Row_mvcc *) mem_allocator.align_alloc(sizeof(Row_mvcc));
+    manager = (Row_mvcc *) mem_allocator.align_alloc(sizeof(Row_mvcc), get_part_id());
 #elif CC_ALG == OCC
-    manager = (Row_occ *) mem_allocator.align_alloc(sizeof(Row_occ));
+    manager = (Row_occ *) mem_allocator.align_alloc(sizeof(Row_occ), get_part_id());
 #elif CC_ALG == MAAT 
-    manager = (Row_maat *) mem_allocator.align_alloc(sizeof(Row_maat));
+    manager = (Row_maat *) mem_allocator.align_alloc(sizeof(Row_maat), get_part_id());
+#elif CC_ALG == SILO
+    manager = (Row_silo *) mem_allocator.align_alloc(sizeof(Row_silo), get_part_id());
+#elif CC_ALG == TICTOC
+    manager = (Row_tictoc *) mem_allocator.align_alloc(sizeof(Row_tictoc), get_part_id());
 #endif
 
 #if CC_ALG != HSTORE && CC_ALG != HSTORE_SPEC 
@@ -214,16 +232,14 @@ RC row_t::get_row(access_t type, TxnManager * txn, row_t *& row) {
 */
 #if CC_ALG == MAAT
 
-    DEBUG_M("row_t::get_row MAAT alloc \n");
-	txn->cur_row = (row_t *) mem_allocator.alloc(sizeof(row_t));
-	txn->cur_row->init(get_table(), get_part_id());
+	txn->cur_row = txn->alloc_row(this);
     rc = this->manager->access(type,txn);
     txn->cur_row->copy(this);
 	row = txn->cur_row;
     assert(rc == RCOK);
 	goto end;
 #endif
-#if CC_ALG == WAIT_DIE || CC_ALG == NO_WAIT 
+#if CC_ALG == WAIT_DIE || CC_ALG == NO_WAIT || CC_ALG == DL_DETECT
 	//uint64_t thd_id = txn->get_thd_id();
 	lock_t lt = (type == RD || type == SCAN)? LOCK_SH : LOCK_EX;
 	rc = this->manager->lock_get(lt, txn);
@@ -232,7 +248,7 @@ RC row_t::get_row(access_t type, TxnManager * txn, row_t *& row) {
 		row = this;
 	} else if (rc == Abort) {} 
 	else if (rc == WAIT) {
-		ASSERT(CC_ALG == WAIT_DIE);
+		ASSERT(CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT);
 
 	}
 	goto end;
@@ -244,9 +260,7 @@ RC row_t::get_row(access_t type, TxnManager * txn, row_t *& row) {
 	// row_t * newr = NULL;
 #if CC_ALG == TIMESTAMP
 	// TIMESTAMP makes a whole copy of the row before reading
-  DEBUG_M("row_t::get_row TIMESTAMP alloc \n");
-	txn->cur_row = (row_t *) mem_allocator.alloc(sizeof(row_t));
-	txn->cur_row->init(get_table(), this->get_part_id());
+	txn->cur_row = txn->alloc_row(this);
 #endif
 	
 	if (type == WR) {
@@ -272,28 +286,36 @@ RC row_t::get_row(access_t type, TxnManager * txn, row_t *& row) {
             assert(row->get_table_name() != NULL);
         }
 	}
-	if (rc != Abort && CC_ALG == MVCC && type == WR) {
-	    DEBUG_M("row_t::get_row MVCC alloc \n");
-		row_t * newr = (row_t *) mem_allocator.alloc(sizeof(row_t));
-		newr->init(this->get_table(), get_part_id());
+#if CC_ALG == MVCC
+	if (rc != Abort && type == WR) {
+		// the new version; it is kept in the history once written
+		row_t * newr = version_pool.get(txn->get_thd_id(), this->get_table(), get_part_id());
 		newr->copy(row);
 		row = newr;
 	}
+#endif
 	goto end;
 #elif CC_ALG == OCC
 	// OCC always make a local copy regardless of read or write
-  DEBUG_M("row_t::get_row OCC alloc \n");
-	txn->cur_row = (row_t *) mem_allocator.alloc(sizeof(row_t));
-	txn->cur_row->init(get_table(), get_part_id());
+	txn->cur_row = txn->alloc_row(this);
 	rc = this->manager->access(txn, R_REQ);
 	row = txn->cur_row;
 	goto end;
+#elif CC_ALG == SILO
+	// reads and writes both work on a private copy; writes are installed at commit
+	txn->cur_row = txn->alloc_row(this);
+	rc = this->manager->access(txn, txn->cur_row, txn->cur_tid);
+	row = txn->cur_row;
+	goto end;
+#elif CC_ALG == TICTOC
+	txn->cur_row = txn->alloc_row(this);
+	rc = this->manager->access(txn, txn->cur_row, txn->cur_wts, txn->cur_rts);
+	row = txn->cur_row;
+	goto end;
 #elif CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC || CC_ALG == CALVIN
 #if CC_ALG == HSTORE_SPEC
   if(txn_table.spec_mode) {
-    DEBUG_M("row_t::get_row HSTORE_SPEC alloc \n");
-	  txn->cur_row = (row_t *) mem_allocator.alloc(sizeof(row_t));
-	  txn->cur_row->init(get_table(), get_part_id());
+	  txn->cur_row = txn->alloc_row(this);
 	  rc = this->manager->access(txn, R_REQ);
 	  row = txn->cur_row;
 	  goto end;
@@ -313,8 +335,8 @@ end:
 RC row_t::get_row_post_wait(access_t type, TxnManager * txn, row_t *& row) {
 
   RC rc = RCOK;
-  assert(CC_ALG == WAIT_DIE || CC_ALG == MVCC || CC_ALG == TIMESTAMP);
-#if CC_ALG == WAIT_DIE
+  assert(CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == MVCC || CC_ALG == TIMESTAMP);
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT
   assert(txn->lock_ready);
 	rc = RCOK;
 	//ts_t endtime = get_sys_clock();
@@ -329,25 +351,23 @@ RC row_t::get_row_post_wait(access_t type, TxnManager * txn, row_t *& row) {
 			assert(row->get_table() != NULL);
 			assert(row->get_schema() == this->get_schema());
 			assert(row->get_table_name() != NULL);
-	if (CC_ALG == MVCC && type == WR) {
-    DEBUG_M("row_t::get_row_post_wait MVCC alloc \n");
-		row_t * newr = (row_t *) mem_allocator.alloc(sizeof(row_t));
-		newr->init(this->get_table(), get_part_id());
-
+#if CC_ALG == MVCC
+	if (type == WR) {
+		row_t * newr = version_pool.get(txn->get_thd_id(), this->get_table(), get_part_id());
 		newr->copy(row);
 		row = newr;
 	}
+#endif
 #endif
   return rc;
 }
 
 // the "row" is the row read out in get_row(). For locking based CC_ALG, 
 // the "row" is the same as "this". For timestamp based CC_ALG, the 
-// "row" != "this", and the "row" must be freed.
+// "row" != "this"; it is a copy in the txn's arena and is reclaimed when
+// the txn resets.
 // For MVCC, the row will simply serve as a version. The version will be 
 // delete during history cleanup.
-// For TIMESTAMP, the row will be explicity deleted at the end of access().
-// (c.f. row_ts.cpp)
 void row_t::return_row(RC rc, access_t type, TxnManager * txn, row_t * row) {	
 #if MODE==NOCC_MODE || MODE==QRY_ONLY_MODE
   return;
@@ -362,25 +382,18 @@ void row_t::return_row(RC rc, access_t type, TxnManager * txn, row_t * row) {
   }
 #endif
 */
-#if CC_ALG == WAIT_DIE || CC_ALG == NO_WAIT || CC_ALG == CALVIN
+#if CC_ALG == WAIT_DIE || CC_ALG == NO_WAIT || CC_ALG == CALVIN || CC_ALG == DL_DETECT
 	assert (row == NULL || row == this || type == XP);
 	if (CC_ALG != CALVIN && ROLL_BACK && type == XP) {// recover from previous writes. should not happen w/ Calvin
 		this->copy(row);
 	}
 	this->manager->lock_release(txn);
 #elif CC_ALG == TIMESTAMP || CC_ALG == MVCC 
-	// for RD or SCAN or XP, the row should be deleted.
-	// because all WR should be companied by a RD
-	// for MVCC RD, the row is not copied, so no need to free. 
-	if (CC_ALG == TIMESTAMP && (type == RD || type == SCAN)) {
-		row->free_row();
-    DEBUG_M("row_t::return_row TIMESTAMP free \n");
-		mem_allocator.free(row, sizeof(row_t));
-	}
+	// all WR should be companied by a RD
 	if (type == XP) {
-		row->free_row();
-    DEBUG_M("row_t::return_row XP free \n");
-		mem_allocator.free(row, sizeof(row_t));
+#if CC_ALG == MVCC
+		version_pool.put(txn->get_thd_id(), row);
+#endif
 		this->manager->access(txn, XP_REQ, NULL);
 	} else if (type == WR) {
 		assert (type == WR && row != NULL);
@@ -392,11 +405,12 @@ void row_t::return_row(RC rc, access_t type, TxnManager * txn, row_t * row) {
 	assert (row != NULL);
 	if (type == WR)
 		manager->write( row, txn->get_end_timestamp() );
-	row->free_row();
-  DEBUG_M("row_t::return_row OCC free \n");
-	mem_allocator.free(row, sizeof(row_t));
   manager->release();
 	return;
+#elif CC_ALG == SILO || CC_ALG == TICTOC
+	// the write, if any, was installed by the manager's finish()
+	assert (row != NULL);
+	return;
 #elif CC_ALG == MAAT 
 	assert (row != NULL);
   if (rc == Abort) {
@@ -404,10 +418,6 @@ void row_t::return_row(RC rc, access_t type, TxnManager * txn, row_t * row) {
   } else {
     manager->commit(type,txn,row);
   }
-
-	row->free_row();
-  DEBUG_M("row_t::return_row Maat free \n");
-	mem_allocator.free(row, sizeof(row_t));
 #elif CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC 
 	assert (row != NULL);
 	if (ROLL_BACK && type == XP) {// recover from previous writes.
@@ -52,6 +52,8 @@ class Row_mvcc;
 class Row_ts;
 class Row_occ;
 class Row_maat;
+class Row_silo;
+class Row_tictoc;
 class Row_specex;
 
 class row_t
@@ -59,6 +61,8 @@ class row_t
 public:
 
 	RC init(table_t * host_table, uint64_t part_id, uint64_t row_id = 0);
+	// data is owned by the caller, so free_row() must not be called
+	RC init(table_t * host_table, uint64_t part_id, uint64_t row_id, char * data);
 	RC switch_schema(table_t * host_table);
 	// not every row has a manager
 	void init_manager(row_t * row);
@@ -116,6 +120,10 @@ public:
   	Row_occ * manager;
   #elif CC_ALG == MAAT 
   	Row_maat * manager;
+  #elif CC_ALG == SILO
+  	Row_silo * manager;
+  #elif CC_ALG == TICTOC
+  	Row_tictoc * manager;
   #elif CC_ALG == HSTORE_SPEC
   	Row_specex * manager;
   #elif CC_ALG == AVOID
@@ -19,6 +19,7 @@
 #include "thread.h"
 #include "abort_thread.h"
 #include "abort_queue.h"
+#include "dl_detect.h"
 
 void AbortThread::setup() {
 }
@@ -29,6 +30,9 @@ RC AbortThread::run() {
 	while (!simulation->is_done()) {
     heartbeat();
     abort_queue.process(get_thd_id());
+#if CC_ALG == DL_DETECT
+    dl_detector.process(get_thd_id());
+#endif
   }
   return FINISH;
  
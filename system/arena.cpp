@@ -0,0 +1,81 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "arena.h"
+#include "global.h"
+#include "mem_alloc.h"
+
+void Arena::init() {
+  head = NULL;
+  cur = NULL;
+  large = NULL;
+  ptr = NULL;
+  end = NULL;
+}
+
+void * Arena::alloc(uint64_t size) {
+  size = (size + MEM_ALLIGN - 1) & ~(MEM_ALLIGN - 1);
+  if(size > TXN_ARENA_MAX_ALLOC) {
+    DEBUG_M("Arena::alloc large alloc\n");
+    Block * b = (Block *) mem_allocator.alloc(sizeof(Block) + size);
+    b->next = large;
+    large = b;
+    return b + 1;
+  }
+  if(ptr + size > end)
+    next_block();
+  void * p = ptr;
+  ptr += size;
+  return p;
+}
+
+void Arena::next_block() {
+  Block * b = cur ? cur->next : head;
+  if(!b) {
+    DEBUG_M("Arena::next_block alloc\n");
+    b = (Block *) mem_allocator.alloc(TXN_ARENA_SIZE);
+    b->next = NULL;
+    if(cur)
+      cur->next = b;
+    else
+      head = b;
+  }
+  cur = b;
+  ptr = (char *) (b + 1);
+  end = (char *) b + TXN_ARENA_SIZE;
+}
+
+void Arena::reset() {
+  while(large) {
+    Block * b = large;
+    large = b->next;
+    DEBUG_M("Arena::reset large free\n");
+    mem_allocator.free(b, 0);
+  }
+  cur = NULL;
+  ptr = NULL;
+  end = NULL;
+}
+
+void Arena::release() {
+  reset();
+  while(head) {
+    Block * b = head;
+    head = b->next;
+    DEBUG_M("Arena::release free\n");
+    mem_allocator.free(b, TXN_ARENA_SIZE);
+  }
+}
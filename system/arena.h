@@ -0,0 +1,47 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <stdint.h>
+#include "config.h"
+
+// Bump allocator owned by one TxnManager. Memory is never freed one object
+// at a time: reset() rewinds to the first block and keeps the blocks for
+// the next txn. Requests above TXN_ARENA_MAX_ALLOC get their own allocation,
+// which reset() frees.
+class Arena {
+public:
+  Arena() { init(); }
+  void init();
+  void * alloc(uint64_t size);
+  void reset();
+  // frees all blocks
+  void release();
+private:
+  struct Block {
+    Block * next;
+  };
+  void next_block();
+  Block * head;
+  Block * cur;
+  Block * large;
+  char * ptr;
+  char * end;
+};
+
+#endif
@@ -33,12 +33,16 @@
 #include "logger.h"
 #include "message.h"
 #include "work_queue.h"
+#include "txn_table.h"
+#include "row.h"
 
 void CalvinLockThread::setup() {
 }
 
 RC CalvinLockThread::run() {
     tsetup();
+    if(slice > 0)
+        return run_slice();
 
     RC rc = RCOK;
     TxnManager * txn_man;
@@ -53,8 +57,10 @@ RC CalvinLockThread::run() {
         if(!msg) {
             if(idle_starttime == 0)
                 idle_starttime = get_sys_clock();
+            work_queue.sched_idle(_thd_id);
             continue;
         }
+        work_queue.sched_busy();
         if(idle_starttime > 0) {
             INC_STATS(_thd_id,sched_idle_time,get_sys_clock() - idle_starttime);
             idle_starttime = 0;
@@ -80,9 +86,30 @@ RC CalvinLockThread::run() {
         prof_starttime = get_sys_clock();
 
         rc = RCOK;
+#if LOGGING && LOG_COMMAND
+        // log the inputs in schedule order, so any durable prefix of the
+        // log replays to a state the txns could have produced
+        if (!txn_man->isRecon()) {
+            logger.enqueueRecord(get_thd_id(),logger.createRecord(txn_man));
+        }
+#endif
         // Acquire locks
         if (!txn_man->isRecon()) {
-            rc = txn_man->acquire_locks();
+            // the extra count keeps the txn from running until every
+            // slice has been handed its locks
+            txn_man->incr_lr();
+            uint64_t resolve_starttime = get_sys_clock();
+            txn_man->acquire_locks();
+            INC_STATS(_thd_id,calvin_resolve_time,get_sys_clock() - resolve_starttime);
+            for(uint64_t i = 1; i < g_calvin_lock_thread_cnt; i++) {
+                if(txn_man->calvin_slice_locks[i].size() == 0)
+                    continue;
+                txn_man->incr_lr();
+                work_queue.lock_slice_enqueue(_thd_id,i,txn_man);
+            }
+            rc = WAIT;
+            if(txn_man->decr_lr() == 0 && ATOM_CAS(txn_man->lock_ready,false,true))
+                rc = RCOK;
         }
 
         if(rc == RCOK) {
@@ -99,6 +126,45 @@ RC CalvinLockThread::run() {
     return FINISH;
 }
 
+// Locks the rows of this slice, txn by txn in the order lock thread 0 saw
+// them, so each row still grants its locks in sequence order.
+RC CalvinLockThread::run_slice() {
+    uint64_t prof_starttime;
+    uint64_t idle_starttime = 0;
+
+    while(!simulation->is_done()) {
+        TxnManager * txn_man = work_queue.lock_slice_dequeue(_thd_id,slice);
+
+        if(!txn_man) {
+            if(idle_starttime == 0)
+                idle_starttime = get_sys_clock();
+            work_queue.lock_slice_idle(_thd_id,slice);
+            continue;
+        }
+        work_queue.lock_slice_busy(slice);
+        if(idle_starttime > 0) {
+            INC_STATS(_thd_id,sched_idle_time,get_sys_clock() - idle_starttime);
+            idle_starttime = 0;
+        }
+
+        prof_starttime = get_sys_clock();
+        Array<CalvinLockReq> & reqs = txn_man->calvin_slice_locks[slice];
+        for(uint64_t i = 0; i < reqs.size(); i++) {
+            if(reqs[i].row->get_lock(reqs[i].type,txn_man) == WAIT)
+                INC_STATS(_thd_id,txn_wait_cnt,1);
+        }
+        INC_STATS(_thd_id,calvin_slice_time,get_sys_clock() - prof_starttime);
+        // the txn may run and be released as soon as this count drops
+        uint64_t txn_id = txn_man->get_txn_id();
+        uint64_t batch_id = txn_man->get_batch_id();
+        if(txn_man->decr_lr() == 0 && ATOM_CAS(txn_man->lock_ready,false,true))
+            txn_table.restart_txn(_thd_id,txn_id,batch_id);
+    }
+    printf("FINISH %ld:%ld\n",_node_id,_thd_id);
+    fflush(stdout);
+    return FINISH;
+}
+
 void CalvinSequencerThread::setup() {
 }
 
@@ -118,11 +184,11 @@ RC CalvinSequencerThread::run() {
 
         prof_starttime = get_sys_clock();
 
-        if(is_batch_ready()) {
-          simulation->advance_seq_epoch();
+        if(seq_id == 0 && is_batch_ready()) {
+          seq_man.next_epoch();
           //last_batchtime = get_wall_clock();
-          seq_man.send_next_batch(_thd_id);
         }
+        seq_man.seal_epochs(_thd_id,seq_id);
 
         INC_STATS(_thd_id,mtx[30],get_sys_clock() - prof_starttime);
         prof_starttime = get_sys_clock();
@@ -146,13 +212,13 @@ RC CalvinSequencerThread::run() {
           case CL_QRY:
             // Query from client
             DEBUG("SEQ process_txn\n");
-            seq_man.process_txn(msg,get_thd_id(),0,0,0,0);
+            seq_man.process_txn(msg,get_thd_id(),seq_id,0,0,0,0);
             // Don't free message yet
             break;
           case CALVIN_ACK:
             // Ack from server
             DEBUG("SEQ process_ack (%ld,%ld) from %ld\n",msg->get_txn_id(),msg->get_batch_id(),msg->get_return_id());
-            seq_man.process_ack(msg,get_thd_id());
+            seq_man.process_ack(msg,get_thd_id(),seq_id);
             // Free message here
             msg->release();
             break;
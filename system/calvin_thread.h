@@ -32,18 +32,29 @@ private:
 };
 */
 
+// Lock thread 0 takes txns in sequence order, resolves their rows and locks
+// the rows of its own slice. The rows of other slices are handed, in the same
+// order, to the lock thread that owns the slice.
+// Only the get_lock calls are split: the index lookups, recon reads and
+// Delivery/Stock-Level range resolution all stay on lock thread 0, since a
+// row's slice is only known once it is found. calvin_resolve_time and
+// calvin_slice_time show how the work divides.
 class CalvinLockThread : public Thread {
 public:
     RC run();
     void setup();
+    uint64_t slice;
 private:
+    RC run_slice();
     TxnManager * m_txn;
 };
 
+// Sequencer thread 0 also cuts the epochs
 class CalvinSequencerThread : public Thread {
 public:
     RC run();
     void setup();
+    uint64_t seq_id;
 private:
     bool is_batch_ready();
 	uint64_t last_batchtime;
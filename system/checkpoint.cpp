@@ -0,0 +1,471 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "checkpoint.h"
+#include "logger.h"
+#include "wl.h"
+#include "row.h"
+#include "table.h"
+#include "catalog.h"
+#include "index_hash.h"
+#include "index_open_hash.h"
+#include "index_btree.h"
+#include "mem_alloc.h"
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CKPT_WBUF_SIZE (1024 * 1024)
+
+// what a checkpoint holds, gathered from the indexes before it is written
+struct CkptImage {
+  struct Entry {
+    uint32_t index_id;
+    idx_key_t key;
+    int part_id;
+    uint64_t first_item; // into items
+    uint32_t item_cnt;
+  };
+  // per section (partition)
+  vector<row_t *> * rows;
+  vector<Entry> * entries;
+  vector<row_t *> * items;
+  // row -> its number within its section
+  std::unordered_map<row_t *, uint64_t> row_nums;
+  vector<bool> nonunique;
+  uint32_t index_id;
+};
+
+static uint64_t ckpt_section(row_t * row) {
+  return row->get_part_id() % g_part_cnt;
+}
+
+static uint64_t ckpt_data_size(row_t * row) {
+  // rows always hold their full tuple (SIM_FULL_ROW in row.cpp)
+  return row->get_tuple_size();
+}
+
+static void ckpt_visit(idx_key_t key, itemid_t * item, int part_id, void * arg) {
+  CkptImage * image = (CkptImage *) arg;
+  // the chain is newest first
+  vector<row_t *> chain;
+  for (itemid_t * it = item; it != NULL; it = it->next)
+    chain.push_back((row_t *) it->location);
+  uint64_t section = part_id >= 0 ? part_id % g_part_cnt : ckpt_section(chain[0]);
+  CkptImage::Entry entry;
+  entry.index_id = image->index_id;
+  entry.key = key;
+  entry.part_id = part_id;
+  entry.first_item = image->items[section].size();
+  entry.item_cnt = chain.size();
+  for (uint64_t i = chain.size(); i > 0; i--) {
+    row_t * row = chain[i - 1];
+    if (image->row_nums.find(row) == image->row_nums.end()) {
+      uint64_t row_section = ckpt_section(row);
+      image->row_nums[row] = image->rows[row_section].size();
+      image->rows[row_section].push_back(row);
+    }
+    image->items[section].push_back(row);
+  }
+  image->entries[section].push_back(entry);
+}
+
+void Checkpointer::get_file_name(char * name) {
+  sprintf(name, "checkpoint_%d.ckpt", g_node_id);
+}
+
+void Checkpointer::get_snapshot_name(char * name, Workload * wl) {
+  sprintf(name, "snapshot_%d_%016lx.img", g_node_id, get_config_key(wl));
+}
+
+static uint64_t ckpt_hash(uint64_t hash, uint64_t value) {
+  // FNV-1a over the bytes of value
+  for (int i = 0; i < 8; i++) {
+    hash ^= (value >> (i * 8)) & 0xff;
+    hash *= 0x100000001b3UL;
+  }
+  return hash;
+}
+
+static uint64_t ckpt_hash(uint64_t hash, const char * str) {
+  for (; *str; str++)
+    hash = ckpt_hash(hash, (uint64_t) *str);
+  return hash;
+}
+
+uint64_t Checkpointer::get_config_key(Workload * wl) {
+  uint64_t key = 0xcbf29ce484222325UL;
+  // what decides which rows a node holds and how they are indexed
+  uint64_t values[] = { WORKLOAD, INDEX_STRUCT, CENTRAL_INDEX,
+    g_node_id, g_node_cnt, g_part_cnt, g_synth_table_size, g_field_per_tuple,
+    g_num_wh, g_dist_per_wh, g_cust_per_dist, g_max_items,
+    g_max_part_key, g_max_product_key, g_max_supplier_key };
+  for (uint64_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    key = ckpt_hash(key, values[i]);
+  // and the schema
+  // (lookups of missing names leave NULLs in the maps)
+  for (map<string, table_t *>::iterator it = wl->tables.begin(); it != wl->tables.end(); it++) {
+    if (it->second == NULL)
+      continue;
+    Catalog * schema = it->second->get_schema();
+    key = ckpt_hash(key, it->first.c_str());
+    key = ckpt_hash(key, schema->table_id);
+    for (uint64_t i = 0; i < schema->get_field_cnt(); i++) {
+      key = ckpt_hash(key, schema->get_field_name(i));
+      key = ckpt_hash(key, schema->get_field_size(i));
+    }
+  }
+  for (map<string, INDEX *>::iterator it = wl->indexes.begin(); it != wl->indexes.end(); it++) {
+    if (it->second == NULL)
+      continue;
+    key = ckpt_hash(key, it->first.c_str());
+    key = ckpt_hash(key, it->second->index_id);
+  }
+  return key;
+}
+
+void Checkpointer::append(const void * data, uint64_t size) {
+  const char * src = (const char *) data;
+  while (size > 0) {
+    uint64_t len = CKPT_WBUF_SIZE - wbuf_size;
+    if (len > size)
+      len = size;
+    memcpy(wbuf + wbuf_size, src, len);
+    wbuf_size += len;
+    src += len;
+    size -= len;
+    if (wbuf_size == CKPT_WBUF_SIZE)
+      flush();
+  }
+}
+
+void Checkpointer::flush() {
+  crc = crc32c(crc, wbuf, wbuf_size);
+  for (uint64_t done = 0; done < wbuf_size && !write_failed; ) {
+    ssize_t len = write(ckpt_fd, wbuf + done, wbuf_size - done);
+    if (len <= 0)
+      write_failed = true;
+    else
+      done += len;
+  }
+  wbuf_size = 0;
+}
+
+void Checkpointer::write_section(CkptImage * image, uint64_t part_id, uint64_t row_base) {
+  vector<row_t *> & rows = image->rows[part_id];
+  vector<CkptImage::Entry> & entries = image->entries[part_id];
+  vector<row_t *> & items = image->items[part_id];
+  CkptSection section;
+  section.part_id = part_id;
+  section.row_cnt = rows.size();
+  section.entry_cnt = entries.size();
+  section.size = rows.size() * sizeof(CkptRow) + entries.size() * sizeof(CkptEntry)
+    + items.size() * sizeof(uint64_t);
+  for (uint64_t i = 0; i < rows.size(); i++)
+    section.size += ckpt_data_size(rows[i]);
+  append(&section, sizeof(section));
+
+  for (uint64_t i = 0; i < rows.size(); i++) {
+    row_t * row = rows[i];
+    CkptRow r;
+    r.table_id = row->get_table()->get_table_id();
+    r.data_size = ckpt_data_size(row);
+    r.part_id = row->get_part_id();
+    r.row_id = row->get_row_id();
+    r.primary_key = row->get_primary_key();
+    append(&r, sizeof(r));
+    // unlatched: concurrent writes are repaired by the redo log
+    append(row->get_data(), r.data_size);
+  }
+  for (uint64_t i = 0; i < entries.size(); i++) {
+    CkptEntry e;
+    e.index_id = entries[i].index_id;
+    e.item_cnt = entries[i].item_cnt;
+    e.key = entries[i].key;
+    e.part_id = entries[i].part_id;
+    e.nonunique = image->nonunique[e.index_id];
+    append(&e, sizeof(e));
+    for (uint64_t j = 0; j < e.item_cnt; j++) {
+      row_t * row = items[entries[i].first_item + j];
+      uint64_t row_num = row_base + image->row_nums[row];
+      append(&row_num, sizeof(row_num));
+    }
+  }
+}
+
+uint64_t Checkpointer::write_image(Workload * wl, const char * name, uint64_t lsn) {
+  CkptImage image;
+  image.rows = new vector<row_t *>[g_part_cnt];
+  image.entries = new vector<CkptImage::Entry>[g_part_cnt];
+  image.items = new vector<row_t *>[g_part_cnt];
+  for (uint32_t i = 0; i < wl->indexes_by_id.size(); i++) {
+    image.index_id = i;
+    image.nonunique.push_back(wl->indexes_by_id[i]->nonunique);
+    wl->indexes_by_id[i]->index_visit(ckpt_visit, &image);
+  }
+  // rows are numbered across sections in section order
+  uint64_t * row_bases = new uint64_t[g_part_cnt];
+  uint64_t row_cnt = 0;
+  for (uint64_t i = 0; i < g_part_cnt; i++) {
+    row_bases[i] = row_cnt;
+    row_cnt += image.rows[i].size();
+  }
+
+  char tmp_name[128];
+  sprintf(tmp_name, "%s.tmp", name);
+  ckpt_fd = open(tmp_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  assert(ckpt_fd >= 0);
+  wbuf = (char *) mem_allocator.alloc(CKPT_WBUF_SIZE);
+  wbuf_size = 0;
+  crc = 0;
+  write_failed = false;
+
+  CkptHeader header;
+  header.magic = CKPT_MAGIC;
+  header.version = CKPT_VERSION;
+  header.config_key = get_config_key(wl);
+  header.lsn = lsn;
+  header.part_cnt = g_part_cnt;
+  header.row_cnt = row_cnt;
+  append(&header, sizeof(header));
+  for (uint64_t i = 0; i < g_part_cnt && !simulation->is_done(); i++) {
+    write_section(&image, i, row_bases[i]);
+  }
+  flush();
+  uint32_t checksum = crc;
+  write_failed = write_failed || write(ckpt_fd, &checksum, sizeof(checksum)) != sizeof(checksum);
+  uint64_t size = lseek(ckpt_fd, 0, SEEK_CUR);
+  bool done = !simulation->is_done() && !write_failed && fdatasync(ckpt_fd) == 0;
+  close(ckpt_fd);
+  if (done) {
+    done = rename(tmp_name, name) == 0;
+  } else {
+    unlink(tmp_name);
+  }
+
+  mem_allocator.free(wbuf, CKPT_WBUF_SIZE);
+  delete [] row_bases;
+  delete [] image.rows;
+  delete [] image.entries;
+  delete [] image.items;
+  return done ? size : 0;
+}
+
+void Checkpointer::checkpoint(uint64_t thd_id, Workload * wl) {
+  uint64_t starttime = get_sys_clock();
+  // taken first: a write the copies miss was logged at or after this lsn
+#if LOGGING && !LOG_COMMAND
+  uint64_t lsn = logger.get_applied_lsn();
+#else
+  uint64_t lsn = 0;
+#endif
+  char name[64];
+  get_file_name(name);
+  uint64_t size = write_image(wl, name, lsn);
+  if (size == 0)
+    return;
+  INC_STATS(thd_id, ckpt_cnt, 1);
+  INC_STATS(thd_id, ckpt_size, size);
+  INC_STATS(thd_id, ckpt_time, get_sys_clock() - starttime);
+  DEBUG("Checkpoint at lsn %ld\n", lsn);
+}
+
+static void * run_load(void * arg) {
+  ((Checkpointer *) arg)->load_sections();
+  return NULL;
+}
+
+RC Checkpointer::load(Workload * wl) {
+  load_lsn = 0;
+#if LOG_COMMAND && LOG_RECOVER
+  // command records must be re-executed on the state they ran on, which
+  // a fuzzy checkpoint does not have
+  printf("Checkpoint: not loaded, command log recovery needs a full replay\n");
+  return Abort;
+#endif
+  char name[64];
+  get_file_name(name);
+  return load_image(wl, name);
+}
+
+RC Checkpointer::load_tables(Workload * wl) {
+#if CKPT_LOAD
+  if (load(wl) == RCOK)
+    return RCOK;
+#endif
+#if SNAPSHOT_LOAD
+  char name[64];
+  get_snapshot_name(name, wl);
+  return load_image(wl, name);
+#endif
+  return Abort;
+}
+
+void Checkpointer::save_snapshot(Workload * wl) {
+#if SNAPSHOT_LOAD
+  uint64_t starttime = get_server_clock();
+  char name[64];
+  get_snapshot_name(name, wl);
+  uint64_t size = write_image(wl, name, 0);
+  printf("Saved snapshot %s (%ld bytes) in %f s\n", name, size
+      , (double)(get_server_clock() - starttime) / BILLION);
+#endif
+}
+
+RC Checkpointer::load_image(Workload * wl, const char * name) {
+  uint64_t starttime = get_server_clock();
+  int fd = open(name, O_RDONLY);
+  if (fd < 0) {
+    printf("No %s to load from\n", name);
+    return Abort;
+  }
+  struct stat st;
+  int rc __attribute__ ((unused));
+  rc = fstat(fd, &st);
+  assert(rc == 0);
+  uint64_t file_size = st.st_size;
+  if (file_size < sizeof(CkptHeader) + sizeof(uint32_t)) {
+    printf("Checkpoint: %s is truncated\n", name);
+    close(fd);
+    return Abort;
+  }
+  char * buf = (char *) mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  assert(buf != MAP_FAILED);
+  close(fd);
+  madvise(buf, file_size, MADV_WILLNEED);
+
+  CkptHeader * header = (CkptHeader *) buf;
+  uint64_t data_size = file_size - sizeof(uint32_t);
+  uint32_t checksum = *(uint32_t *) (buf + data_size);
+  if (header->magic != CKPT_MAGIC || crc32c(0, buf, data_size) != checksum) {
+    printf("Checkpoint: %s is corrupt\n", name);
+    munmap(buf, file_size);
+    return Abort;
+  }
+  if (header->version != CKPT_VERSION || header->config_key != get_config_key(wl)
+      || header->part_cnt != g_part_cnt) {
+    printf("Checkpoint: %s was written by another version or config\n", name);
+    munmap(buf, file_size);
+    return Abort;
+  }
+
+  load_wl = wl;
+  load_tables_by_id.clear();
+  for (map<string, table_t *>::iterator it = wl->tables.begin(); it != wl->tables.end(); it++) {
+    if (it->second == NULL)
+      continue;
+    uint32_t table_id = it->second->get_table_id();
+    if (load_tables_by_id.size() <= table_id)
+      load_tables_by_id.resize(table_id + 1, NULL);
+    load_tables_by_id[table_id] = it->second;
+  }
+  load_section_ptrs.clear();
+  load_row_bases.clear();
+  uint64_t pos = sizeof(CkptHeader);
+  uint64_t row_cnt = 0;
+  for (uint64_t i = 0; i < header->part_cnt; i++) {
+    CkptSection * section = (CkptSection *) (buf + pos);
+    load_section_ptrs.push_back(buf + pos);
+    load_row_bases.push_back(row_cnt);
+    row_cnt += section->row_cnt;
+    pos += sizeof(CkptSection) + section->size;
+    assert(pos <= data_size);
+  }
+  assert(row_cnt == header->row_cnt);
+  load_row_ptrs = new row_t * [row_cnt];
+
+  next_row_section = 0;
+  next_entry_section = 0;
+  pthread_barrier_init(&load_bar, NULL, g_init_parallelism);
+  pthread_t * p_thds = new pthread_t[g_init_parallelism - 1];
+  for (uint32_t i = 0; i < g_init_parallelism - 1; i++)
+    pthread_create(&p_thds[i], NULL, run_load, this);
+  run_load(this);
+  for (uint32_t i = 0; i < g_init_parallelism - 1; i++)
+    pthread_join(p_thds[i], NULL);
+  delete [] p_thds;
+  pthread_barrier_destroy(&load_bar);
+  delete [] load_row_ptrs;
+
+  load_lsn = header->lsn;
+  munmap(buf, file_size);
+  printf("Loaded %ld rows from %s at lsn %ld in %f s\n"
+      , row_cnt, name, load_lsn
+      , (double)(get_server_clock() - starttime) / BILLION);
+  return RCOK;
+}
+
+void Checkpointer::load_sections() {
+  uint64_t section_cnt = load_section_ptrs.size();
+  uint64_t section;
+  while ((section = ATOM_FETCH_ADD(next_row_section, 1)) < section_cnt)
+    load_rows(section);
+  // an entry may name rows of any section
+  pthread_barrier_wait(&load_bar);
+  while ((section = ATOM_FETCH_ADD(next_entry_section, 1)) < section_cnt)
+    load_entries(section);
+}
+
+void Checkpointer::load_rows(uint64_t section) {
+  CkptSection * header = (CkptSection *) load_section_ptrs[section];
+  char * pos = (char *) (header + 1);
+  row_t ** rows = &load_row_ptrs[load_row_bases[section]];
+  for (uint64_t i = 0; i < header->row_cnt; i++) {
+    CkptRow * r = (CkptRow *) pos;
+    pos += sizeof(CkptRow);
+    assert(r->table_id < load_tables_by_id.size() && load_tables_by_id[r->table_id] != NULL);
+    row_t * row;
+    uint64_t row_id = r->row_id;
+    load_tables_by_id[r->table_id]->get_new_row(row, r->part_id, row_id);
+    row->set_primary_key(r->primary_key);
+    assert(r->data_size == row->get_tuple_size());
+    row->set_data(pos);
+    pos += r->data_size;
+    rows[i] = row;
+  }
+}
+
+void Checkpointer::load_entries(uint64_t section) {
+  CkptSection * header = (CkptSection *) load_section_ptrs[section];
+  char * pos = (char *) (header + 1);
+  for (uint64_t i = 0; i < header->row_cnt; i++)
+    pos += sizeof(CkptRow) + ((CkptRow *) pos)->data_size;
+  for (uint64_t i = 0; i < header->entry_cnt; i++) {
+    CkptEntry * e = (CkptEntry *) pos;
+    uint64_t * row_nums = (uint64_t *) (e + 1);
+    pos += sizeof(CkptEntry) + e->item_cnt * sizeof(uint64_t);
+    assert(e->index_id < load_wl->indexes_by_id.size());
+    INDEX * index = load_wl->indexes_by_id[e->index_id];
+    if (e->nonunique)
+      index->nonunique = true;
+    // oldest first, so the chains come out as they were
+    for (uint32_t j = 0; j < e->item_cnt; j++) {
+      itemid_t * m_item = (itemid_t *) mem_allocator.alloc(sizeof(itemid_t));
+      m_item->init();
+      m_item->type = DT_row;
+      m_item->location = load_row_ptrs[row_nums[j]];
+      m_item->valid = true;
+      if (index->nonunique)
+        index->index_insert_nonunique(e->key, m_item, e->part_id);
+      else
+        index->index_insert(e->key, m_item, e->part_id);
+    }
+  }
+}
@@ -0,0 +1,132 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include "global.h"
+#include "helper.h"
+#include <vector>
+
+class Workload;
+class row_t;
+class table_t;
+struct CkptImage;
+
+#define CKPT_MAGIC 0x31544b50434e5644UL
+#define CKPT_VERSION 1
+
+struct CkptHeader {
+  uint64_t magic;
+  uint64_t version;
+  uint64_t config_key; // Checkpointer::get_config_key
+  uint64_t lsn; // the redo log must be replayed from here
+  uint64_t part_cnt;
+  uint64_t row_cnt;
+};
+
+// one per partition, followed by size bytes of rows and then index entries
+struct CkptSection {
+  uint64_t part_id;
+  uint64_t row_cnt;
+  uint64_t entry_cnt;
+  uint64_t size;
+};
+
+// followed by data_size bytes of row data
+struct CkptRow {
+  uint32_t table_id;
+  uint32_t data_size;
+  uint64_t part_id;
+  uint64_t row_id;
+  uint64_t primary_key;
+};
+
+// an index key and the rows under it, oldest first; followed by item_cnt
+// row numbers (rows are numbered across sections in file order)
+struct CkptEntry {
+  uint32_t index_id;
+  uint32_t item_cnt;
+  uint64_t key;
+  int32_t part_id;
+  uint32_t nonunique; // the index's rows were added with index_insert_nonunique
+};
+
+// Fuzzy checkpoints and table snapshots, which share a file format.
+//
+// Checkpoint rows are copied while txns keep writing them, so an image
+// may hold a torn or newer row; every write it may have missed or torn
+// has an lsn of at least the checkpoint's, and replaying the redo log
+// from there repairs it. A snapshot is an image of the freshly generated
+// tables, saved once per config (SNAPSHOT_LOAD) so later runs skip
+// generating them.
+//
+// Files end with a CRC32C of everything before it and are only renamed
+// into place once they are durable. Loading maps the file and rebuilds
+// rows and indexes with g_init_parallelism threads.
+class Checkpointer {
+public:
+  // writes a new checkpoint of wl's tables and indexes
+  void checkpoint(uint64_t thd_id, Workload * wl);
+  // builds wl's rows and indexes from the checkpoint; returns Abort if
+  // there is no valid one
+  RC load(Workload * wl);
+  // builds wl's tables from the checkpoint (CKPT_LOAD) or the snapshot of
+  // its config (SNAPSHOT_LOAD); returns Abort if the caller must
+  // generate them
+  RC load_tables(Workload * wl);
+  // SNAPSHOT_LOAD: saves the generated tables for later runs
+  void save_snapshot(Workload * wl);
+  // lsn of the loaded checkpoint, 0 if none was loaded
+  uint64_t get_lsn() { return load_lsn; }
+  // loader thread: creates the rows of each section, then, once all rows
+  // exist, inserts the index entries
+  void load_sections();
+
+private:
+  void get_file_name(char * name);
+  void get_snapshot_name(char * name, Workload * wl);
+  // hash of the config and schema the tables were generated with
+  uint64_t get_config_key(Workload * wl);
+  // returns the size of the file written, or 0 if it was not
+  uint64_t write_image(Workload * wl, const char * name, uint64_t lsn);
+  RC load_image(Workload * wl, const char * name);
+  void write_section(CkptImage * image, uint64_t part_id, uint64_t row_base);
+  void append(const void * data, uint64_t size);
+  void flush();
+
+  // writer state
+  int ckpt_fd;
+  char * wbuf;
+  uint64_t wbuf_size;
+  uint32_t crc;
+  bool write_failed;
+
+  // loader state
+  void load_rows(uint64_t section);
+  void load_entries(uint64_t section);
+  uint64_t load_lsn;
+  Workload * load_wl;
+  std::vector<table_t *> load_tables_by_id;
+  std::vector<char *> load_section_ptrs;
+  std::vector<uint64_t> load_row_bases;
+  row_t ** load_row_ptrs;
+  volatile uint64_t next_row_section;
+  volatile uint64_t next_entry_section;
+  pthread_barrier_t load_bar;
+};
+
+#endif
@@ -0,0 +1,38 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "thread.h"
+#include "checkpoint_thread.h"
+#include "checkpoint.h"
+
+void CheckpointThread::setup() {
+}
+
+RC CheckpointThread::run() {
+  tsetup();
+  uint64_t last_ckpt = get_sys_clock();
+	while (!simulation->is_done()) {
+    if (get_sys_clock() - last_ckpt < g_ckpt_interval) {
+      usleep(1000);
+      continue;
+    }
+    checkpointer.checkpoint(get_thd_id(), _wl);
+    last_ckpt = get_sys_clock();
+  }
+  return FINISH;
+}
@@ -37,6 +37,18 @@ void ClientThread::setup() {
   // send ~twice as frequently due to delays in context switching
   send_interval = (g_client_thread_cnt * BILLION) / g_load_per_server / 1.8;
   printf("Client interval: %ld\n",send_interval);
+#elif LOAD_METHOD == LOAD_OPEN
+  assert(g_load_per_server > 0);
+  // mean gap between the sends of this thread, which carries its share of
+  // the load of every server it sends to
+  send_interval = (g_client_thread_cnt * BILLION) / (g_load_per_server * g_servers_per_client);
+#if ARRIVAL_DIST == ARRIVAL_BURSTY
+  assert(g_burst_on_time > 0);
+  send_interval = send_interval * g_burst_on_time / (g_burst_on_time + g_burst_off_time);
+#endif
+  // client nodes must not draw the same arrivals
+  rdm.init(g_node_id * g_client_thread_cnt + _thd_id);
+  printf("Client interval: %ld\n",send_interval);
 #endif
 
 }
@@ -53,6 +65,11 @@ RC ClientThread::run() {
       txns_sent[i] = 0;
 
 	run_starttime = get_sys_clock();
+#if LOAD_METHOD == LOAD_OPEN
+  arrival_starttime = run_starttime;
+  arrival_clock = 0;
+  next_send_time = next_arrival();
+#endif
 
   while(!simulation->is_done()) {
     heartbeat();
@@ -86,6 +103,16 @@ RC ClientThread::run() {
     }
     last_send_time = gate_time;
 		m_query = client_query_queue.get_next_query(next_node,_thd_id);
+#elif LOAD_METHOD == LOAD_OPEN
+    while(get_sys_clock() < next_send_time && !simulation->is_done()) { }
+    // a full inflight window delays the send but not the schedule
+    while((inf_cnt = client_man.inc_inflight(next_node)) < 0 && !simulation->is_done()) { }
+    if(inf_cnt < 0)
+      break;
+    uint64_t send_time = next_send_time;
+    next_send_time = next_arrival();
+    INC_STATS(get_thd_id(),cl_send_lag,get_sys_clock() - send_time);
+		m_query = client_query_queue.get_next_query(next_node,_thd_id);
 #else
     assert(false);
 #endif
@@ -95,11 +122,19 @@ RC ClientThread::run() {
 				_thd_id, next_node_id,inf_cnt,simulation->seconds_from_start(get_sys_clock()));
 
     Message * msg = Message::create_message((BaseQuery*)m_query,CL_QRY);
-    ((ClientQueryMessage*)msg)->client_startts = get_sys_clock();
+#if LOAD_METHOD == LOAD_OPEN
+    // latency counts from the scheduled send, so the sends a slow server
+    // held back are charged to it
+    uint64_t startts = send_time;
+#else
+    uint64_t startts = get_sys_clock();
+#endif
+    ((ClientQueryMessage*)msg)->client_startts = startts;
     msg_queue.enqueue(get_thd_id(),msg,next_node_id);
 		num_txns_sent++;
 		txns_sent[next_node]++;
     INC_STATS(get_thd_id(),txn_sent_cnt,1);
+    INC_STATS_SEC(get_thd_id(),cl_sec_sent_cnt,startts,1);
 
 	}
 
@@ -113,3 +148,19 @@ RC ClientThread::run() {
   fflush(stdout);
 	return FINISH;
 }
+
+uint64_t ClientThread::next_arrival() {
+  uint64_t gap = send_interval;
+#if ARRIVAL_DIST == ARRIVAL_POISSON || ARRIVAL_DIST == ARRIVAL_BURSTY
+  // exponential gaps; u is in [0,1)
+  double u = (double) rdm.next() / RAND_MAX;
+  gap = (uint64_t) (-log(1 - u) * send_interval);
+#endif
+  arrival_clock += gap;
+#if ARRIVAL_DIST == ARRIVAL_BURSTY
+  uint64_t period = g_burst_on_time + g_burst_off_time;
+  return arrival_starttime + arrival_clock / g_burst_on_time * period + arrival_clock % g_burst_on_time;
+#else
+  return arrival_starttime + arrival_clock;
+#endif
+}
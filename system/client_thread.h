@@ -28,6 +28,13 @@ public:
 private:
   uint64_t last_send_time;
   uint64_t send_interval;
+  // [LOAD_OPEN] sends are scheduled on a clock that only runs in the on
+  // periods of ARRIVAL_BURSTY
+  uint64_t arrival_starttime;
+  uint64_t arrival_clock;
+  uint64_t next_send_time;
+  // returns the scheduled time of the next send
+  uint64_t next_arrival();
 };
 
 #endif
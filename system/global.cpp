@@ -31,7 +31,12 @@
 #include "client_txn.h"
 #include "sequencer.h"
 #include "logger.h"
+#include "checkpoint.h"
 #include "maat.h"
+#include "silo.h"
+#include "tictoc.h"
+#include "dl_detect.h"
+#include "numa.h"
 
 mem_alloc mem_allocator;
 Stats stats;
@@ -41,13 +46,17 @@ Query_queue query_queue;
 Client_query_queue client_query_queue;
 OptCC occ_man;
 Maat maat_man;
+Silo silo_man;
+TicToc tictoc_man;
+DL_detect dl_detector;
+NumaMap numa_map;
 Transport tport_man;
 TxnManPool txn_man_pool;
 TxnPool txn_pool;
-AccessPool access_pool;
 TxnTablePool txn_table_pool;
 MsgPool msg_pool;
 RowPool row_pool;
+VersionPool version_pool;
 QryPool qry_pool;
 TxnTable txn_table;
 QWorkQueue work_queue;
@@ -56,6 +65,7 @@ MessageQueue msg_queue;
 Client_txn client_man;
 Sequencer seq_man;
 Logger logger;
+Checkpointer checkpointer;
 TimeTable time_table;
 
 bool volatile warmup_done = false;
@@ -109,17 +119,24 @@ UInt32 g_logger_thread_cnt = 1;
 #else
 UInt32 g_logger_thread_cnt = 0;
 #endif
+#if CHECKPOINT
+UInt32 g_ckpt_thread_cnt = 1;
+#else
+UInt32 g_ckpt_thread_cnt = 0;
+#endif
 UInt32 g_send_thread_cnt = SEND_THREAD_CNT;
 #if CC_ALG == CALVIN
-// sequencer + scheduler thread
-UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + 2;
+// sequencer + lock threads
+UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_ckpt_thread_cnt + SEQ_THREAD_CNT + CALVIN_LOCK_THREAD_CNT;
 #else
-UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt;
+UInt32 g_total_thread_cnt = g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt + g_abort_thread_cnt + g_logger_thread_cnt + g_ckpt_thread_cnt;
 #endif
 UInt32 g_total_client_thread_cnt = g_client_thread_cnt + g_client_rem_thread_cnt + g_client_send_thread_cnt;
 UInt32 g_total_node_cnt = g_node_cnt + g_client_node_cnt + g_repl_cnt*g_node_cnt;
 UInt64 g_synth_table_size = SYNTH_TABLE_SIZE;
 UInt32 g_req_per_query = REQ_PER_QUERY;
+double g_scan_perc = SCAN_PERC;
+UInt32 g_scan_len = SCAN_LEN;
 bool g_strict_ppt = STRICT_PPT == 1;
 UInt32 g_field_per_tuple = FIELD_PER_TUPLE;
 UInt32 g_init_parallelism = INIT_PARALLELISM;
@@ -141,20 +158,29 @@ UInt32 g_network_delay = NETWORK_DELAY;
 UInt64 g_done_timer = DONE_TIMER;
 UInt64 g_batch_time_limit = BATCH_TIMER;
 UInt64 g_seq_batch_time_limit = SEQ_BATCH_TIMER;
+UInt64 g_burst_on_time = BURST_ON_TIME;
+UInt64 g_burst_off_time = BURST_OFF_TIME;
 UInt64 g_prog_timer = PROG_TIMER;
 UInt64 g_warmup_timer = WARMUP_TIMER;
 UInt64 g_msg_time_limit = MSG_TIME_LIMIT;
+UInt64 g_idle_spin_cnt = IDLE_SPIN_CNT;
 
 UInt64 g_log_buf_max = LOG_BUF_MAX;
 UInt64 g_log_flush_timeout = LOG_BUF_TIMEOUT;
+UInt64 g_ckpt_interval = CKPT_INTERVAL;
 
 // MVCC
 UInt64 g_max_read_req = MAX_READ_REQ;
 UInt64 g_max_pre_req = MAX_PRE_REQ;
 UInt64 g_his_recycle_len = HIS_RECYCLE_LEN;
 
+// SILO
+UInt64 g_silo_epoch_intvl = SILO_EPOCH_INTVL;
+UInt64 g_dl_detect_intvl = DL_DETECT_INTVL;
+
 // CALVIN
 UInt32 g_seq_thread_cnt = SEQ_THREAD_CNT;
+UInt32 g_calvin_lock_thread_cnt = CALVIN_LOCK_THREAD_CNT;
 
 double g_mpr = MPR;
 double g_mpitem = MPIR;
@@ -176,6 +202,9 @@ double g_perc_updatepart = PERC_PPS_UPDATEPART;
 // TPCC
 UInt32 g_num_wh = NUM_WH;
 double g_perc_payment = PERC_PAYMENT;
+double g_perc_order_status = PERC_ORDER_STATUS;
+double g_perc_delivery = PERC_DELIVERY;
+double g_perc_stock_level = PERC_STOCK_LEVEL;
 bool g_wh_update = WH_UPDATE;
 char * output_file = NULL;
 char * input_file = NULL;
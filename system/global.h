@@ -58,14 +58,18 @@ class Manager;
 class Query_queue;
 class OptCC;
 class Maat;
+class Silo;
+class TicToc;
+class DL_detect;
+class NumaMap;
 class Transport;
 class Remote_query;
 class TxnManPool;
 class TxnPool;
-class AccessPool;
 class TxnTablePool;
 class MsgPool;
 class RowPool;
+class VersionPool;
 class QryPool;
 class TxnTable;
 class QWorkQueue;
@@ -75,6 +79,7 @@ class Client_query_queue;
 class Client_txn;
 class Sequencer;
 class Logger;
+class Checkpointer;
 class TimeTable;
 
 typedef uint32_t UInt32;
@@ -95,13 +100,17 @@ extern Query_queue query_queue;
 extern Client_query_queue client_query_queue;
 extern OptCC occ_man;
 extern Maat maat_man;
+extern Silo silo_man;
+extern TicToc tictoc_man;
+extern DL_detect dl_detector;
+extern NumaMap numa_map;
 extern Transport tport_man;
 extern TxnManPool txn_man_pool;
 extern TxnPool txn_pool;
-extern AccessPool access_pool;
 extern TxnTablePool txn_table_pool;
 extern MsgPool msg_pool;
 extern RowPool row_pool;
+extern VersionPool version_pool;
 extern QryPool qry_pool;
 extern TxnTable txn_table;
 extern QWorkQueue work_queue;
@@ -110,6 +119,7 @@ extern MessageQueue msg_queue;
 extern Client_txn client_man;
 extern Sequencer seq_man;
 extern Logger logger;
+extern Checkpointer checkpointer;
 extern TimeTable time_table;
 
 extern bool volatile warmup_done;
@@ -149,6 +159,7 @@ extern UInt32 g_this_total_thread_cnt;
 extern UInt32 g_thread_cnt;
 extern UInt32 g_abort_thread_cnt;
 extern UInt32 g_logger_thread_cnt;
+extern UInt32 g_ckpt_thread_cnt;
 extern UInt32 g_send_thread_cnt;
 extern UInt32 g_rem_thread_cnt;
 extern ts_t g_abort_penalty; 
@@ -162,6 +173,7 @@ extern int32_t g_inflight_max;
 extern uint64_t g_msg_size;
 extern uint64_t g_log_buf_max;
 extern uint64_t g_log_flush_timeout;
+extern uint64_t g_ckpt_interval;
 
 extern UInt32 g_max_txn_per_part;
 extern int32_t g_load_per_server;
@@ -171,15 +183,22 @@ extern UInt32 g_network_delay;
 extern UInt64 g_done_timer;
 extern UInt64 g_batch_time_limit;
 extern UInt64 g_seq_batch_time_limit;
+extern UInt64 g_burst_on_time;
+extern UInt64 g_burst_off_time;
 extern UInt64 g_prog_timer;
 extern UInt64 g_warmup_timer;
 extern UInt64 g_msg_time_limit;
+extern UInt64 g_idle_spin_cnt;
 
 // MVCC
 extern UInt64 g_max_read_req;
 extern UInt64 g_max_pre_req;
 extern UInt64 g_his_recycle_len;
 
+// SILO
+extern UInt64 g_silo_epoch_intvl;
+extern UInt64 g_dl_detect_intvl;
+
 // YCSB
 extern UInt32 g_cc_alg;
 extern ts_t g_query_intvl;
@@ -194,6 +213,8 @@ extern double g_data_perc;
 extern double g_access_perc;
 extern UInt64 g_synth_table_size;
 extern UInt32 g_req_per_query;
+extern double g_scan_perc;
+extern UInt32 g_scan_len;
 extern bool g_strict_ppt;
 extern UInt32 g_field_per_tuple;
 extern UInt32 g_init_parallelism;
@@ -203,6 +224,9 @@ extern double g_mpitem;
 // TPCC
 extern UInt32 g_num_wh;
 extern double g_perc_payment;
+extern double g_perc_order_status;
+extern double g_perc_delivery;
+extern double g_perc_stock_level;
 extern bool g_wh_update;
 extern char * output_file;
 extern char * input_file;
@@ -228,6 +252,7 @@ extern double g_perc_updatepart;
 
 // CALVIN
 extern UInt32 g_seq_thread_cnt;
+extern UInt32 g_calvin_lock_thread_cnt;
 
 // Replication
 extern UInt32 g_repl_type;
@@ -259,6 +284,7 @@ enum RemReqType {INIT_DONE=0,
     LOG_MSG_RSP,
     LOG_FLUSHED,
     CALVIN_ACK,
+    DL_EDGES,
     NO_MSG};
 
 // Calvin
@@ -319,6 +345,8 @@ enum TsType {R_REQ = 0, W_REQ, P_REQ, XP_REQ};
 // index structure for specific purposes. (e.g. non-primary key access should use hash)
 #if (INDEX_STRUCT == IDX_BTREE)
 #define INDEX		index_btree
+#elif (INDEX_STRUCT == IDX_OPEN_HASH)
+#define INDEX		IndexOpenHash
 #else  // IDX_HASH
 #define INDEX		IndexHash
 #endif
@@ -18,6 +18,9 @@
 #include "helper.h"
 #include "mem_alloc.h"
 #include "time.h"
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
 
 bool itemid_t::operator==(const itemid_t &other) const {
 	return (type == other.type && location == other.location);
@@ -137,6 +140,42 @@ uint64_t get_sys_clock() {
 	return 0;
 }
 
+#ifndef __SSE4_2__
+// byte-at-a-time table for the reflected polynomial 0x82F63B78
+class Crc32cTable {
+public:
+	Crc32cTable() {
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? (c >> 1) ^ 0x82F63B78 : c >> 1;
+			t[i] = c;
+		}
+	}
+	uint32_t t[256];
+};
+static Crc32cTable crc32c_table;
+#endif
+
+uint32_t crc32c(uint32_t crc, const char * data, uint64_t size) {
+	crc = ~crc;
+#ifdef __SSE4_2__
+	uint64_t c = crc;
+	for (; size >= 8; size -= 8, data += 8) {
+		uint64_t word;
+		memcpy(&word, data, 8);
+		c = _mm_crc32_u64(c, word);
+	}
+	crc = (uint32_t) c;
+	for (; size > 0; size--, data++)
+		crc = _mm_crc32_u8(crc, *data);
+#else
+	for (; size > 0; size--, data++)
+		crc = crc32c_table.t[(crc ^ (uint8_t)*data) & 0xff] ^ (crc >> 8);
+#endif
+	return ~crc;
+}
+
 void myrand::init(uint64_t seed) {
 	this->seed = seed;
 }
@@ -70,6 +70,11 @@
 	__sync_fetch_and_add(&(dest), value)
 #define ATOM_SUB_FETCH(dest, value) \
 	__sync_sub_and_fetch(&(dest), value)
+// ordered load/store for publishing data to latch-free readers
+#define ATOM_LOAD_ACQ(src) \
+	__atomic_load_n(&(src), __ATOMIC_ACQUIRE)
+#define ATOM_STORE_REL(dest, value) \
+	__atomic_store_n(&(dest), value, __ATOMIC_RELEASE)
 
 /************************************************/
 // ASSERT Helper
@@ -145,6 +150,17 @@
 	if (STATS_ENABLE && simulation->is_warmup_done()) \
 		stats._stats[tid]->name.insert(value);
 
+// per-second series, by the second of the run that time falls in
+#define INC_STATS_SEC(tid, name, time, value) \
+	if (STATS_ENABLE && simulation->is_warmup_done()) \
+		stats._stats[tid]->name[stats._stats[tid]->sec_idx(time)] += value;
+
+#define MAX_STATS_SEC(tid, name, time, value) \
+	if (STATS_ENABLE && simulation->is_warmup_done()) { \
+		double * _sec_max = &stats._stats[tid]->name[stats._stats[tid]->sec_idx(time)]; \
+		if (value > *_sec_max) *_sec_max = value; \
+	}
+
 #define INC_GLOB_STATS(name, value) \
 	if (STATS_ENABLE && simulation->is_warmup_done()) \
 		stats.name += value;
@@ -262,6 +278,9 @@ uint64_t get_wall_clock();
 uint64_t get_server_clock();
 uint64_t get_sys_clock(); // return: in ns
 
+// CRC32C (Castagnoli) of data, continuing from crc (0 to start)
+uint32_t crc32c(uint32_t crc, const char * data, uint64_t size);
+
 class myrand {
 public:
 	void init(uint64_t seed);
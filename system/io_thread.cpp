@@ -30,6 +30,7 @@
 #include "message.h"
 #include "client_txn.h"
 #include "work_queue.h"
+#include "dl_detect.h"
 
 void InputThread::setup() {
 
@@ -89,6 +90,7 @@ RC InputThread::client_recv_loop() {
 	run_starttime = get_sys_clock();
   uint64_t return_node_offset;
   uint64_t inf;
+  uint64_t idle_cnt = 0;
 
   std::vector<Message*> * msgs;
 
@@ -100,8 +102,14 @@ RC InputThread::client_recv_loop() {
     starttime = get_sys_clock();
     //while((m_query = work_queue.get_next_query(get_thd_id())) != NULL) {
     //Message * msg = work_queue.dequeue();
-    if(msgs == NULL)
+    if(msgs == NULL) {
+      if(IDLE_PARK && ++idle_cnt > g_idle_spin_cnt) {
+        tport_man.wait_msg(get_thd_id());
+        idle_cnt = 0;
+      }
       continue;
+    }
+    idle_cnt = 0;
     while(!msgs->empty()) {
       Message * msg = msgs->front();
 			assert(msg->rtype == CL_RSP);
@@ -109,11 +117,15 @@ RC InputThread::client_recv_loop() {
       assert(return_node_offset < g_servers_per_client);
       rsp_cnts[return_node_offset]++;
       INC_STATS(get_thd_id(),txn_cnt,1);
-      uint64_t timespan = get_sys_clock() - ((ClientResponseMessage*)msg)->client_startts; 
+      uint64_t rsp_time = get_sys_clock();
+      uint64_t timespan = rsp_time - ((ClientResponseMessage*)msg)->client_startts; 
       INC_STATS(get_thd_id(),txn_run_time, timespan);
       if (warmup_done) {
         INC_STATS_ARR(get_thd_id(),client_client_latency, timespan);
       }
+      INC_STATS_SEC(get_thd_id(),cl_sec_txn_cnt,rsp_time,1);
+      INC_STATS_SEC(get_thd_id(),cl_sec_lat,rsp_time,timespan);
+      MAX_STATS_SEC(get_thd_id(),cl_sec_lat_max,rsp_time,timespan);
       //INC_STATS_ARR(get_thd_id(),all_lat,timespan);
       inf = client_man.dec_inflight(return_node_offset);
       DEBUG("Recv %ld from %ld, %ld -- %f\n",((ClientResponseMessage*)msg)->txn_id,msg->return_node_id,inf,float(timespan)/BILLION);
@@ -138,6 +150,7 @@ RC InputThread::server_recv_loop() {
 	RC rc = RCOK;
 	assert (rc == RCOK);
   uint64_t starttime;
+  uint64_t idle_cnt = 0;
 
   std::vector<Message*> * msgs;
 	while (!simulation->is_done()) {
@@ -149,8 +162,14 @@ RC InputThread::server_recv_loop() {
     INC_STATS(_thd_id,mtx[28], get_sys_clock() - starttime);
     starttime = get_sys_clock();
 
-    if(msgs == NULL)
+    if(msgs == NULL) {
+      if(IDLE_PARK && ++idle_cnt > g_idle_spin_cnt) {
+        tport_man.wait_msg(get_thd_id());
+        idle_cnt = 0;
+      }
       continue;
+    }
+    idle_cnt = 0;
     while(!msgs->empty()) {
       Message * msg = msgs->front();
       if(msg->rtype == INIT_DONE) {
@@ -169,6 +188,14 @@ RC InputThread::server_recv_loop() {
         msgs->erase(msgs->begin());
         continue;
       }
+#endif
+#if CC_ALG == DL_DETECT
+      if(msg->rtype == DL_EDGES) {
+        dl_detector.recv_edges((DLEdgeMessage*)msg);
+        Message::release_message(msg);
+        msgs->erase(msgs->begin());
+        continue;
+      }
 #endif
       work_queue.enqueue(get_thd_id(),msg,false);
       msgs->erase(msgs->begin());
@@ -27,7 +27,8 @@ RC LogThread::run() {
   tsetup();
 	while (!simulation->is_done()) {
     logger.processRecord(get_thd_id());
-    //logger.flushBufferCheck();
+    logger.flushBufferCheck(get_thd_id());
+    logger.idle(get_thd_id());
   }
   return FINISH;
  
@@ -2,19 +2,75 @@
 #include "work_queue.h"
 #include "message.h"
 #include "mem_alloc.h"
-#include <fstream>
+#include "row.h"
+#include "table.h"
+#include "catalog.h"
+#include "wl.h"
+#include "index_hash.h"
+#include "index_open_hash.h"
+#include "index_btree.h"
+#include "txn.h"
+#include "txn_table.h"
+#include "pool.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
 
 
 void Logger::init(const char * log_file_name) {
   this->log_file_name = log_file_name;
-  log_file.open(log_file_name, ios::out | ios::app | ios::binary);
-  assert(log_file.is_open());
-  pthread_mutex_init(&mtx,NULL);
+  log_fd = open(log_file_name, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  assert(log_fd >= 0);
 
+  parker.init();
+  log_buf_cnt = g_total_thread_cnt;
+  int ok = posix_memalign((void **)&log_bufs, CL_SIZE, sizeof(LogBuffer) * log_buf_cnt);
+  assert(ok == 0);
+  notify_end = (uint64_t *) mem_allocator.alloc(sizeof(uint64_t) * log_buf_cnt);
+  data_end = (uint64_t *) mem_allocator.alloc(sizeof(uint64_t) * log_buf_cnt);
+  for(uint32_t i = 0; i < log_buf_cnt; i++) {
+    new (&log_bufs[i]) LogBuffer();
+    log_bufs[i].data = (char *) mem_allocator.alloc(LOG_THD_BUF_SIZE);
+    log_bufs[i].notify = (LogNotify *) mem_allocator.alloc(sizeof(LogNotify) * LOG_THD_NOTIFY_CNT);
+    log_bufs[i].head = log_bufs[i].tail = 0;
+    log_bufs[i].notify_head = log_bufs[i].notify_tail = 0;
+    log_bufs[i].apply_lsn = UINT64_MAX;
+  }
+
+  // whole pages, so the group goes out in page aligned writes
+  group_capacity = (g_log_buf_max + 4095) & ~4095UL;
+  ok = posix_memalign((void **)&group_buf, 4096, group_capacity);
+  assert(ok == 0);
+  group_size = 0;
+  gathering = false;
+  last_flush = get_sys_clock();
 }
 
 void Logger::release() {
-  log_file.close(); 
+  close(log_fd);
+}
+
+void Logger::begin_apply(uint64_t thd_id) {
+  // the lsn counter only grows and the fetch-and-add that numbers each
+  // record is a full barrier, so this is published before any record
+  log_bufs[thd_id].apply_lsn = lsn;
+}
+
+void Logger::end_apply(uint64_t thd_id) {
+  ATOM_STORE_REL(log_bufs[thd_id].apply_lsn, UINT64_MAX);
+}
+
+uint64_t Logger::get_applied_lsn() {
+  uint64_t applied = lsn;
+  // a txn numbered below applied has published its apply_lsn by now
+  __sync_synchronize();
+  for(uint32_t i = 0; i < log_buf_cnt; i++) {
+    uint64_t apply_lsn = log_bufs[i].apply_lsn;
+    if(apply_lsn < applied)
+      applied = apply_lsn;
+  }
+  return applied;
 }
 
 LogRecord * Logger::createRecord( 
@@ -28,10 +84,81 @@ LogRecord * Logger::createRecord(
   record->rcd.lsn = ATOM_FETCH_ADD(lsn,1);
   record->rcd.iud = iud;
   record->rcd.txn_id = txn_id;
+#if !LOG_COMMAND
   record->rcd.table_id = table_id;
   record->rcd.key = key;
+#endif
+  return record;
+}
+
+#if LOG_COMMAND
+LogRecord * Logger::createRecord(TxnManager * txn) {
+  LogRecord * record = createRecord(txn->get_txn_id(),L_UPDATE,0,0);
+  record->rcd.batch_id = txn->get_batch_id();
+  // the same encoding the query travels in from the client
+  Message * msg = Message::create_message(txn,CL_QRY);
+  record->rcd.params_size = msg->get_size();
+  record->rcd.params = (char*)mem_allocator.alloc(record->rcd.params_size);
+  msg->copy_to_buf(record->rcd.params);
+  Message::release_message(msg);
+  return record;
+}
+#else
+LogRecord * Logger::createRecord(
+    uint64_t txn_id,
+    row_t * row,
+    row_t * before_row,
+    uint32_t index_id,
+    uint64_t index_key,
+    int index_cnt,
+    uint64_t part_id
+    ) {
+  LogRecord * record = createRecord(txn_id,L_UPDATE,row->get_table()->get_table_id(),row->get_primary_key());
+  record->rcd.part_id = part_id;
+  record->rcd.index_id = index_id;
+  record->rcd.index_key = index_key;
+  record->rcd.index_cnt = index_cnt;
+
+  Catalog * schema = row->get_schema();
+  uint64_t field_cnt = schema->get_field_cnt();
+  record->rcd.cols = (uint32_t*)mem_allocator.alloc(sizeof(uint32_t) * field_cnt);
+  record->rcd.after_image = (char*)mem_allocator.alloc(schema->get_tuple_size());
+  char * data = row->get_data();
+  for(uint32_t fid = 0; fid < field_cnt; fid++) {
+    uint64_t pos = schema->get_field_index(fid);
+    uint64_t size = schema->get_field_size(fid);
+    if(before_row && memcmp(data + pos,before_row->get_data() + pos,size) == 0)
+      continue;
+    record->rcd.cols[record->rcd.n_cols++] = fid;
+    memcpy(record->rcd.after_image + record->rcd.after_image_size,data + pos,size);
+    record->rcd.after_image_size += size;
+  }
+  return record;
+}
+
+LogRecord * Logger::createInsertRecord(
+    uint64_t txn_id,
+    row_t * row,
+    bool image,
+    uint32_t index_id,
+    uint64_t index_key,
+    int row_idx,
+    uint64_t part_id
+    ) {
+  LogRecord * record;
+  if(image) {
+    record = createRecord(txn_id,row,NULL,index_id,index_key,row_idx,part_id);
+    record->rcd.iud = L_INSERT;
+  } else {
+    record = createRecord(txn_id,L_INSERT,row->get_table()->get_table_id(),row->get_primary_key());
+    record->rcd.part_id = part_id;
+    record->rcd.index_id = index_id;
+    record->rcd.index_key = index_key;
+    record->rcd.index_cnt = row_idx;
+  }
   return record;
 }
+#endif
 
 LogRecord * Logger::createRecord( 
     LogRecord * record
@@ -51,111 +178,280 @@ void LogRecord::copyRecord(
   rcd.iud = record->rcd.iud;
   rcd.type = record->rcd.type;
   rcd.txn_id = record->rcd.txn_id;
+#if LOG_COMMAND
+  rcd.batch_id = record->rcd.batch_id;
+  rcd.params_size = record->rcd.params_size;
+  if(rcd.params_size > 0) {
+    rcd.params = (char*)mem_allocator.alloc(rcd.params_size);
+    memcpy(rcd.params,record->rcd.params,rcd.params_size);
+  }
+#else
+  rcd.part_id = record->rcd.part_id;
   rcd.table_id = record->rcd.table_id;
   rcd.key = record->rcd.key;
+  rcd.index_id = record->rcd.index_id;
+  rcd.index_key = record->rcd.index_key;
+  rcd.index_cnt = record->rcd.index_cnt;
+  rcd.n_cols = record->rcd.n_cols;
+  rcd.after_image_size = record->rcd.after_image_size;
+  if(rcd.n_cols > 0) {
+    rcd.cols = (uint32_t*)mem_allocator.alloc(sizeof(uint32_t) * rcd.n_cols);
+    memcpy(rcd.cols,record->rcd.cols,sizeof(uint32_t) * rcd.n_cols);
+  }
+  if(rcd.after_image_size > 0) {
+    rcd.after_image = (char*)mem_allocator.alloc(rcd.after_image_size);
+    memcpy(rcd.after_image,record->rcd.after_image,rcd.after_image_size);
+  }
+#endif
 }
 
+uint64_t LogRecord::get_size() {
+  uint64_t size = 0;
+  size += sizeof(rcd.checksum);
+  size += sizeof(rcd.size);
+  size += sizeof(rcd.lsn);
+  size += sizeof(rcd.type);
+  size += sizeof(rcd.iud);
+  size += sizeof(rcd.txn_id);
+#if LOG_COMMAND
+  size += sizeof(rcd.batch_id);
+  size += sizeof(rcd.params_size);
+  size += rcd.params_size;
+#else
+  size += sizeof(rcd.part_id);
+  size += sizeof(rcd.table_id);
+  size += sizeof(rcd.key);
+  size += sizeof(rcd.index_id);
+  size += sizeof(rcd.index_key);
+  size += sizeof(rcd.index_cnt);
+  size += sizeof(rcd.n_cols);
+  size += sizeof(uint32_t) * rcd.n_cols;
+  size += sizeof(rcd.after_image_size);
+  size += rcd.after_image_size;
+#endif
+  return size;
+}
 
-void Logger::enqueueRecord(LogRecord* record) {
-  DEBUG("Enqueue Log Record %ld\n",record->rcd.txn_id);
-  pthread_mutex_lock(&mtx);
-  log_queue.push(record); 
-  pthread_mutex_unlock(&mtx);
+void LogRecord::copy_to_buf(char * buf) {
+  rcd.size = get_size();
+  uint64_t ptr = 0;
+  COPY_BUF(buf,rcd.checksum,ptr);
+  COPY_BUF(buf,rcd.size,ptr);
+  COPY_BUF(buf,rcd.lsn,ptr);
+  COPY_BUF(buf,rcd.type,ptr);
+  COPY_BUF(buf,rcd.iud,ptr);
+  COPY_BUF(buf,rcd.txn_id,ptr);
+#if LOG_COMMAND
+  COPY_BUF(buf,rcd.batch_id,ptr);
+  COPY_BUF(buf,rcd.params_size,ptr);
+  if(rcd.params_size > 0) {
+    COPY_BUF_SIZE(buf,rcd.params[0],ptr,rcd.params_size);
+  }
+#else
+  COPY_BUF(buf,rcd.part_id,ptr);
+  COPY_BUF(buf,rcd.table_id,ptr);
+  COPY_BUF(buf,rcd.key,ptr);
+  COPY_BUF(buf,rcd.index_id,ptr);
+  COPY_BUF(buf,rcd.index_key,ptr);
+  COPY_BUF(buf,rcd.index_cnt,ptr);
+  COPY_BUF(buf,rcd.n_cols,ptr);
+  if(rcd.n_cols > 0) {
+    COPY_BUF_SIZE(buf,rcd.cols[0],ptr,sizeof(uint32_t) * rcd.n_cols);
+  }
+  COPY_BUF(buf,rcd.after_image_size,ptr);
+  if(rcd.after_image_size > 0) {
+    COPY_BUF_SIZE(buf,rcd.after_image[0],ptr,rcd.after_image_size);
+  }
+#endif
+  assert(ptr == rcd.size);
+  rcd.checksum = computeChecksum(buf,rcd.size);
+  memcpy(buf,&rcd.checksum,sizeof(rcd.checksum));
 }
 
-void Logger::processRecord(uint64_t thd_id) {
-  if(log_queue.empty())
-    return;
-  LogRecord * record = NULL;
-  pthread_mutex_lock(&mtx);
-  if(!log_queue.empty()) {
-    record = log_queue.front(); 
-    log_queue.pop();
+bool LogRecord::copy_from_buf(char * buf, uint64_t buf_size) {
+  rcd.init();
+  uint64_t ptr = 0;
+  if(buf_size < sizeof(rcd.checksum) + sizeof(rcd.size))
+    return false;
+  COPY_VAL(rcd.checksum,buf,ptr);
+  COPY_VAL(rcd.size,buf,ptr);
+  // a torn tail can leave any bytes here, so check the size before
+  // trusting anything the checksum has not covered yet
+  if(rcd.size < ptr || rcd.size > buf_size || rcd.checksum != computeChecksum(buf,rcd.size))
+    return false;
+  COPY_VAL(rcd.lsn,buf,ptr);
+  COPY_VAL(rcd.type,buf,ptr);
+  COPY_VAL(rcd.iud,buf,ptr);
+  COPY_VAL(rcd.txn_id,buf,ptr);
+#if LOG_COMMAND
+  COPY_VAL(rcd.batch_id,buf,ptr);
+  COPY_VAL(rcd.params_size,buf,ptr);
+  if(rcd.params_size > 0) {
+    rcd.params = (char*)mem_allocator.alloc(rcd.params_size);
+    COPY_VAL_SIZE(rcd.params[0],buf,ptr,rcd.params_size);
+  }
+#else
+  COPY_VAL(rcd.part_id,buf,ptr);
+  COPY_VAL(rcd.table_id,buf,ptr);
+  COPY_VAL(rcd.key,buf,ptr);
+  COPY_VAL(rcd.index_id,buf,ptr);
+  COPY_VAL(rcd.index_key,buf,ptr);
+  COPY_VAL(rcd.index_cnt,buf,ptr);
+  COPY_VAL(rcd.n_cols,buf,ptr);
+  if(rcd.n_cols > 0) {
+    rcd.cols = (uint32_t*)mem_allocator.alloc(sizeof(uint32_t) * rcd.n_cols);
+    COPY_VAL_SIZE(rcd.cols[0],buf,ptr,sizeof(uint32_t) * rcd.n_cols);
+  }
+  COPY_VAL(rcd.after_image_size,buf,ptr);
+  if(rcd.after_image_size > 0) {
+    rcd.after_image = (char*)mem_allocator.alloc(rcd.after_image_size);
+    COPY_VAL_SIZE(rcd.after_image[0],buf,ptr,rcd.after_image_size);
   }
-  pthread_mutex_unlock(&mtx);
+#endif
+  assert(ptr == rcd.size);
+  return true;
+}
 
-  if(record) {
-    uint64_t starttime = get_sys_clock();
-    DEBUG("Dequeue Log Record %ld\n",record->rcd.txn_id);
-    if(record->rcd.iud == L_NOTIFY) {
-      flushBuffer(thd_id);
-      work_queue.enqueue(thd_id,Message::create_message(record->rcd.txn_id,LOG_FLUSHED),false);
+void LogRecord::release() {
+#if LOG_COMMAND
+  if(rcd.params)
+    mem_allocator.free(rcd.params,rcd.params_size);
+  rcd.params = NULL;
+#else
+  if(rcd.cols)
+    mem_allocator.free(rcd.cols,sizeof(uint32_t) * rcd.n_cols);
+  if(rcd.after_image)
+    mem_allocator.free(rcd.after_image,rcd.after_image_size);
+  rcd.cols = NULL;
+  rcd.after_image = NULL;
+#endif
+}
 
-    }
+uint32_t LogRecord::computeChecksum(char * buf, uint64_t size) {
+  // everything after the checksum field itself
+  return crc32c(0,buf + sizeof(uint32_t),size - sizeof(uint32_t));
+}
+
+
+void Logger::enqueueRecord(uint64_t thd_id, LogRecord* record) {
+  DEBUG("Enqueue Log Record %ld\n",record->rcd.txn_id);
+  if(record->rcd.iud == L_NOTIFY) {
+#if LOG_COMMAND
+    notify_on_sync(thd_id,record->rcd.txn_id,record->rcd.batch_id);
+#else
+    notify_on_sync(thd_id,record->rcd.txn_id,0);
+#endif
+  } else {
     writeToBuffer(thd_id,record);
-    //writeToBuffer((char*)(&record->rcd),sizeof(record->rcd));
-    log_buf_cnt++;
-    mem_allocator.free(record,sizeof(LogRecord));
-    INC_STATS(thd_id,log_process_time,get_sys_clock() - starttime);
   }
-  
+  record->release();
+  mem_allocator.free(record,sizeof(LogRecord));
 }
 
-uint64_t Logger::reserveBuffer(uint64_t size) {
-  return ATOM_FETCH_ADD(aries_write_offset,size);
+bool Logger::drainBuffer(LogBuffer * buf, uint64_t end) {
+  uint64_t head = buf->head;
+  while(head < end && group_size < group_capacity) {
+    uint64_t off = head % LOG_THD_BUF_SIZE;
+    uint64_t len = end - head;
+    if(len > LOG_THD_BUF_SIZE - off)
+      len = LOG_THD_BUF_SIZE - off;
+    if(len > group_capacity - group_size)
+      len = group_capacity - group_size;
+    memcpy(group_buf + group_size, buf->data + off, len);
+    group_size += len;
+    head += len;
+  }
+  ATOM_STORE_REL(buf->head, head);
+  return head == end;
 }
 
+void Logger::processRecord(uint64_t thd_id) {
+  uint64_t starttime = get_sys_clock();
+  uint64_t prev_size = group_size;
+  if(!gathering) {
+    for(uint32_t i = 0; i < log_buf_cnt; i++)
+      notify_end[i] = ATOM_LOAD_ACQ(log_bufs[i].notify_tail);
+    for(uint32_t i = 0; i < log_buf_cnt; i++)
+      data_end[i] = ATOM_LOAD_ACQ(log_bufs[i].tail);
+    gathering = true;
+  }
+  bool done = true;
+  for(uint32_t i = 0; i < log_buf_cnt; i++) {
+    if(!drainBuffer(&log_bufs[i],data_end[i]))
+      done = false;
+  }
+  // if the group buffer filled up, flushBufferCheck flushes it and the
+  // remaining records are gathered on the next call
+  if(done) {
+    for(uint32_t i = 0; i < log_buf_cnt; i++) {
+      LogBuffer * buf = &log_bufs[i];
+      for(uint64_t n = buf->notify_head; n < notify_end[i]; n++)
+        txns_to_notify.push_back(buf->notify[n % LOG_THD_NOTIFY_CNT]);
+      ATOM_STORE_REL(buf->notify_head, notify_end[i]);
+    }
+    gathering = false;
+  }
+  if(group_size != prev_size)
+    INC_STATS(thd_id,log_process_time,get_sys_clock() - starttime);
+}
 
-//void Logger::writeToBuffer(char * data, uint64_t offset, uint64_t size) {
 void Logger::writeToBuffer(uint64_t thd_id, char * data, uint64_t size) {
-  //memcpy(aries_log_buffer + offset, data, size);
-  //aries_write_offset += size;
+  assert(thd_id < log_buf_cnt);
+  assert(size <= LOG_THD_BUF_SIZE);
   uint64_t starttime = get_sys_clock();
-  log_file.write(data,size);
+  LogBuffer * buf = &log_bufs[thd_id];
+  uint64_t tail = buf->tail;
+  // wait for the log thread to make room
+  while(tail + size - ATOM_LOAD_ACQ(buf->head) > LOG_THD_BUF_SIZE) {}
+  for(uint64_t done = 0; done < size; ) {
+    uint64_t off = (tail + done) % LOG_THD_BUF_SIZE;
+    uint64_t len = size - done;
+    if(len > LOG_THD_BUF_SIZE - off)
+      len = LOG_THD_BUF_SIZE - off;
+    memcpy(buf->data + off, data + done, len);
+    done += len;
+  }
+  ATOM_STORE_REL(buf->tail, tail + size);
+  parker.wake();
   INC_STATS(thd_id,log_write_time,get_sys_clock() - starttime);
   INC_STATS(thd_id,log_write_cnt,1);
+}
 
+void Logger::notify_on_sync(uint64_t thd_id, uint64_t txn_id, uint64_t batch_id) {
+  assert(thd_id < log_buf_cnt);
+  LogBuffer * buf = &log_bufs[thd_id];
+  uint64_t tail = buf->notify_tail;
+  while(tail - ATOM_LOAD_ACQ(buf->notify_head) >= LOG_THD_NOTIFY_CNT) {}
+  buf->notify[tail % LOG_THD_NOTIFY_CNT].txn_id = txn_id;
+  buf->notify[tail % LOG_THD_NOTIFY_CNT].batch_id = batch_id;
+  ATOM_STORE_REL(buf->notify_tail, tail + 1);
+  parker.wake();
 }
 
-void Logger::notify_on_sync(uint64_t txn_id) {
-  LogRecord * record = (LogRecord*)mem_allocator.alloc(sizeof(LogRecord));
-  record->rcd.init();
-  record->rcd.txn_id = txn_id;
-  record->rcd.iud = L_NOTIFY;
-  enqueueRecord(record);
+void Logger::idle(uint64_t thd_id) {
+  if(gathering || group_size > 0 || !txns_to_notify.empty()) {
+    parker.busy();
+    return;
+  }
+  parker.idle(thd_id);
 }
 
 void Logger::writeToBuffer(uint64_t thd_id, LogRecord * record) {
   DEBUG("Buffer Write\n");
-  //memcpy(aries_log_buffer + offset, data, size);
-  //aries_write_offset += size;
-  uint64_t starttime = get_sys_clock();
-#if LOG_COMMAND
-
-  WRITE_VAL(log_file,record->rcd.checksum);
-  WRITE_VAL(log_file,record->rcd.lsn);
-  WRITE_VAL(log_file,record->rcd.type);
-  WRITE_VAL(log_file,record->rcd.txn_id);
-  //WRITE_VAL(log_file,record->rcd.partid);
-#if WORKLOAD == TPCC
-  WRITE_VAL(log_file,record->rcd.txntype);
-#endif
-  WRITE_VAL_SIZE(log_file,record->rcd.params,record->rcd.params_size);
-
-#else
-
-  WRITE_VAL(log_file,record->rcd.checksum);
-  WRITE_VAL(log_file,record->rcd.lsn);
-  WRITE_VAL(log_file,record->rcd.type);
-  WRITE_VAL(log_file,record->rcd.iud);
-  WRITE_VAL(log_file,record->rcd.txn_id);
-  //WRITE_VAL(log_file,record->rcd.partid);
-  WRITE_VAL(log_file,record->rcd.table_id);
-  WRITE_VAL(log_file,record->rcd.key);
-  /*
-  WRITE_VAL(log_file,record->rcd.n_cols);
-  WRITE_VAL(log_file,record->rcd.cols);
-  WRITE_VAL_SIZE(log_file,record->rcd.before_image,record->rcd.before_image_size);
-  WRITE_VAL_SIZE(log_file,record->rcd.after_image,record->rcd.after_image_size);
-  */
-
-#endif
-  INC_STATS(thd_id,log_write_time,get_sys_clock() - starttime);
-
+  uint64_t size = record->get_size();
+  char * data = (char*)mem_allocator.alloc(size);
+  record->copy_to_buf(data);
+  writeToBuffer(thd_id,data,size);
+  mem_allocator.free(data,size);
 }
 
 void Logger::flushBufferCheck(uint64_t thd_id) {
-  if(log_buf_cnt >= g_log_buf_max || get_sys_clock() - last_flush > g_log_flush_timeout) {
+  if(group_size >= group_capacity) {
+    flushBuffer(thd_id);
+    return;
+  }
+  if((group_size > 0 || !txns_to_notify.empty())
+      && get_sys_clock() - last_flush > g_log_flush_timeout) {
     flushBuffer(thd_id);
   }
 }
@@ -163,10 +459,265 @@ void Logger::flushBufferCheck(uint64_t thd_id) {
 void Logger::flushBuffer(uint64_t thd_id) {
   DEBUG("Flush Buffer\n");
   uint64_t starttime = get_sys_clock();
-  log_file.flush();
+  for(uint64_t written = 0; written < group_size; ) {
+    ssize_t rc = write(log_fd, group_buf + written, group_size - written);
+    assert(rc > 0);
+    written += rc;
+  }
+  int rc __attribute__ ((unused));
+  rc = fdatasync(log_fd);
+  assert(rc == 0);
   INC_STATS(thd_id,log_flush_time,get_sys_clock() - starttime);
   INC_STATS(thd_id,log_flush_cnt,1);
+  INC_STATS(thd_id,log_flush_txn_cnt,txns_to_notify.size());
 
+  // the group is durable: release its txns
+  for(uint64_t i = 0; i < txns_to_notify.size(); i++) {
+    work_queue.enqueue(thd_id,Message::create_message(txns_to_notify[i].txn_id,txns_to_notify[i].batch_id,LOG_FLUSHED),false);
+  }
+  txns_to_notify.clear();
+  group_size = 0;
   last_flush = get_sys_clock();
-  log_buf_cnt = 0;
 }
+
+#if LOG_COMMAND
+// CALVIN runs a batch's txns node by node, each node's sub-batches merged in
+// sequencer thread order. A node's txn ids are n + g_node_cnt * i, where i
+// counts up through the merged batch, so id order is the schedule order.
+static bool calvin_less(LogRecord * a, LogRecord * b) {
+  if(a->rcd.batch_id != b->rcd.batch_id)
+    return a->rcd.batch_id < b->rcd.batch_id;
+  if(a->rcd.txn_id % g_node_cnt != b->rcd.txn_id % g_node_cnt)
+    return a->rcd.txn_id % g_node_cnt < b->rcd.txn_id % g_node_cnt;
+  return a->rcd.txn_id < b->rcd.txn_id;
+}
+#else
+static bool lsn_less(LogRecord * a, LogRecord * b) {
+  return a->rcd.lsn < b->rcd.lsn;
+}
+
+static void apply_image(row_t * row, AriesLogRecord & rcd) {
+  Catalog * schema = row->get_schema();
+  uint64_t ptr = 0;
+  for(uint32_t c = 0; c < rcd.n_cols; c++) {
+    row->set_value(rcd.cols[c],rcd.after_image + ptr);
+    ptr += schema->get_field_size(rcd.cols[c]);
+  }
+  assert(ptr == rcd.after_image_size);
+}
+
+static void * run_replay(void * logger) {
+  ((Logger*)logger)->replay();
+  return NULL;
+}
+#endif
+
+void Logger::recover(const char * log_file, Workload * wl, uint64_t start_lsn) {
+  uint64_t starttime = get_server_clock();
+  int fd = open(log_file, O_RDWR);
+  if(fd < 0) {
+    printf("No log to recover from\n");
+    return;
+  }
+  struct stat st;
+  int rc __attribute__ ((unused));
+  rc = fstat(fd,&st);
+  assert(rc == 0);
+  uint64_t file_size = st.st_size;
+  char * buf = (char*)mem_allocator.alloc(file_size + 1);
+  for(uint64_t done = 0; done < file_size; ) {
+    ssize_t len = pread(fd, buf + done, file_size - done, done);
+    assert(len > 0);
+    done += len;
+  }
+
+  // bucket the intact prefix of the log by partition
+  recover_wl = wl;
+  uint64_t replay_cnt = 0;
+  recover_recs = new std::vector<LogRecord*>[g_part_cnt];
+  uint64_t pos = 0;
+  uint64_t rec_cnt = 0;
+  while(pos < file_size) {
+    LogRecord * record = (LogRecord*)mem_allocator.alloc(sizeof(LogRecord));
+    if(!record->copy_from_buf(buf + pos, file_size - pos)) {
+      mem_allocator.free(record,sizeof(LogRecord));
+      break;
+    }
+    pos += record->rcd.size;
+    rec_cnt++;
+    if(record->rcd.lsn >= lsn)
+      lsn = record->rcd.lsn + 1;
+#if LOG_COMMAND
+    uint64_t part_id = 0;
+#else
+    uint64_t part_id = record->rcd.part_id;
+#endif
+    if((record->rcd.iud != L_UPDATE && record->rcd.iud != L_INSERT) || part_id >= g_part_cnt
+        || record->rcd.lsn < start_lsn) {
+      record->release();
+      mem_allocator.free(record,sizeof(LogRecord));
+      continue;
+    }
+    recover_recs[part_id].push_back(record);
+  }
+  mem_allocator.free(buf,file_size + 1);
+  if(pos < file_size) {
+    printf("Log: dropping %ld bytes of torn or corrupt tail\n",file_size - pos);
+    rc = ftruncate(fd,pos);
+    assert(rc == 0);
+  }
+  close(fd);
+
+#if LOG_COMMAND
+  replayCommands();
+  replay_cnt = recover_cnt;
+  printf("Recovered %ld records (%ld txns re-executed) in %f s\n"
+      ,rec_cnt,replay_cnt
+      ,(double)(get_server_clock() - starttime) / 1000000000);
+#else
+  // records of different threads interleave in the log; lsn order is the
+  // order in which the updates of a row were made
+  recover_tables.assign(wl->tables.size(),NULL);
+  for(map<string, table_t *>::iterator it = wl->tables.begin(); it != wl->tables.end(); it++)
+    recover_tables[it->second->get_table_id()] = it->second;
+  recover_next_part = 0;
+  recover_cnt = 0;
+  recover_miss_cnt = 0;
+  pthread_t * p_thds = new pthread_t[g_init_parallelism - 1];
+  for(uint32_t i = 0; i < g_init_parallelism - 1; i++) {
+    pthread_create(&p_thds[i], NULL, run_replay, this);
+  }
+  run_replay(this);
+  for(uint32_t i = 0; i < g_init_parallelism - 1; i++) {
+    pthread_join(p_thds[i], NULL);
+  }
+  delete [] p_thds;
+  replay_cnt = recover_cnt;
+  printf("Recovered %ld records (%ld replayed, %ld without a row) in %f s\n"
+      ,rec_cnt,replay_cnt,recover_miss_cnt
+      ,(double)(get_server_clock() - starttime) / 1000000000);
+#endif
+  delete [] recover_recs;
+}
+
+#if LOG_COMMAND
+void Logger::replayCommands() {
+  std::vector<LogRecord*> & recs = recover_recs[0];
+  recover_cnt = 0;
+#if CC_ALG == CALVIN
+  // CALVIN is deterministic: re-executing the logged inputs serially in
+  // schedule order yields the same writes. Reads that other nodes would
+  // have forwarded are not needed, as a node only writes its own rows.
+  std::stable_sort(recs.begin(),recs.end(),calvin_less);
+  for(uint64_t i = 0; i < recs.size(); i++) {
+    Message * msg = Message::create_message(recs[i]->rcd.params);
+    TxnManager * txn_man;
+    txn_man_pool.get(0,txn_man);
+    txn_man->register_thread(NULL);
+    txn_man->set_txn_id(recs[i]->rcd.txn_id);
+    txn_man->set_batch_id(recs[i]->rcd.batch_id);
+    msg->copy_to_txn(txn_man);
+    txn_man->recovering = true;
+    RC rc = RCOK;
+    if(!txn_man->isRecon())
+      rc = txn_man->acquire_locks();
+    // nothing else holds locks, so every lock is granted at once
+    assert(rc == RCOK);
+    rc = txn_man->run_calvin_txn();
+    assert(txn_man->calvin_exec_phase_done());
+    txn_man->release_locks(RCOK);
+    txn_man_pool.put(0,txn_man);
+    Message::release_message(msg);
+    recover_cnt++;
+  }
+#else
+  if(recs.size() > 0)
+    printf("Command log replay needs CALVIN; skipping %ld records\n",recs.size());
+#endif
+  for(uint64_t i = 0; i < recs.size(); i++) {
+    recs[i]->release();
+    mem_allocator.free(recs[i],sizeof(LogRecord));
+  }
+  recs.clear();
+}
+#else
+void Logger::replay() {
+  uint64_t part_id;
+  while((part_id = ATOM_FETCH_ADD(recover_next_part,1)) < g_part_cnt)
+    replayPartition(part_id);
+}
+
+void Logger::replayPartition(uint64_t part_id) {
+  std::vector<LogRecord*> & recs = recover_recs[part_id];
+  std::stable_sort(recs.begin(),recs.end(),lsn_less);
+  uint64_t cnt = 0;
+  uint64_t miss_cnt = 0;
+  InsertedRows inserted;
+  for(uint64_t i = 0; i < recs.size(); i++) {
+    AriesLogRecord & rcd = recs[i]->rcd;
+    if(rcd.iud == L_INSERT) {
+      if(replayInsert(rcd,inserted))
+        cnt++;
+      else
+        miss_cnt++;
+      recs[i]->release();
+      mem_allocator.free(recs[i],sizeof(LogRecord));
+      continue;
+    }
+    itemid_t * item = NULL;
+    if(rcd.index_id < recover_wl->indexes_by_id.size()) {
+      INDEX * index = recover_wl->indexes_by_id[rcd.index_id];
+      // the count reads return NULL on a miss and keep no per-thread state,
+      // so replay threads can share the index
+      index->index_read(rcd.index_key,rcd.index_cnt < 0 ? 0 : rcd.index_cnt,item,rcd.part_id);
+    }
+    row_t * row = item ? (row_t*)item->location : NULL;
+    if(row == NULL || row->get_primary_key() != rcd.key
+        || row->get_table()->get_table_id() != rcd.table_id) {
+      miss_cnt++;
+    } else {
+      apply_image(row,rcd);
+      cnt++;
+    }
+    recs[i]->release();
+    mem_allocator.free(recs[i],sizeof(LogRecord));
+  }
+  recs.clear();
+  ATOM_ADD(recover_cnt,cnt);
+  ATOM_ADD(recover_miss_cnt,miss_cnt);
+}
+
+bool Logger::replayInsert(AriesLogRecord & rcd, InsertedRows & inserted) {
+  // a row's records are logged in lsn order by one txn, so the image
+  // comes first and later entries find the row it created
+  std::pair<uint64_t,int32_t> id(rcd.txn_id,rcd.index_cnt);
+  row_t * row = NULL;
+  if(rcd.after_image_size > 0) {
+    if(rcd.table_id >= recover_tables.size() || recover_tables[rcd.table_id] == NULL)
+      return false;
+    uint64_t row_id = 0;
+    recover_tables[rcd.table_id]->get_new_row(row,rcd.part_id,row_id);
+    row->set_primary_key(rcd.key);
+    apply_image(row,rcd);
+    inserted[id] = row;
+  } else {
+    InsertedRows::iterator it = inserted.find(id);
+    if(it == inserted.end())
+      return false;
+    row = it->second;
+  }
+  if(rcd.index_id < recover_wl->indexes_by_id.size()) {
+    INDEX * index = recover_wl->indexes_by_id[rcd.index_id];
+    itemid_t * m_item = (itemid_t *) mem_allocator.alloc(sizeof(itemid_t));
+    m_item->init();
+    m_item->type = DT_row;
+    m_item->location = row;
+    m_item->valid = true;
+    if(index->nonunique)
+      index->index_insert_nonunique(rcd.index_key,m_item,rcd.part_id);
+    else
+      index->index_insert(rcd.index_key,m_item,rcd.part_id);
+  }
+  return true;
+}
+#endif
@@ -3,61 +3,91 @@
 
 #include "global.h"
 #include "helper.h"
-#include "concurrentqueue.h"
-#include <set>
-#include <queue>
-#include <fstream>
+#include "parker.h"
+#include <vector>
+#include <map>
+
+class row_t;
+class table_t;
+class Workload;
+class TxnManager;
 
 enum LogRecType { LRT_INVALID = 0, LRT_INSERT, LRT_UPDATE, LRT_DELETE, LRT_TRUNCATE };
 enum LogIUD { L_INSERT = 0, L_UPDATE, L_DELETE, L_NOTIFY };
 
-// Command log record (logical logging)
+// Command log record (logical logging): the serialized client query of a
+// committed txn. Under CALVIN, re-executing a node's records in
+// (batch_id, sequencer, txn_id) order reproduces that node's writes.
 struct CmdLogRecord {
-  uint32_t checksum;
+  void init() {
+    checksum = 0;
+    size = 0;
+    lsn = UINT64_MAX;
+    type = LRT_UPDATE;
+    iud = L_UPDATE;
+    txn_id = UINT64_MAX; 
+    batch_id = 0;
+    params_size = 0;
+    params = NULL;
+  }
+
+  uint32_t checksum; // CRC32C of the serialized record after this field
+  uint32_t size; // serialized size in bytes
   uint64_t lsn;
   LogRecType type;
+  LogIUD iud;
   uint64_t txn_id; // transaction id
-  //uint32_t partid; // partition id
-#if WORKLOAD==TPCC
-  TPCCTxnType txntype;
-#elif WORKLOAD==YCSB
-  //YCSBTxnType txntype;
-#endif
+  uint64_t batch_id; // CALVIN epoch of the txn
   uint32_t params_size;
-  char * params; // input parameters for this transaction type
+  char * params; // the txn's client query message (Message::copy_to_buf)
 };
 
-// ARIES-style log record (physiological logging)
+// ARIES-style log record (physiological logging). Update records are
+// redo-only: they carry the after-image of the columns the txn changed,
+// which is enough to roll a freshly loaded database forward. Insert
+// records carry the whole row and the index entry to add it under; a row
+// with several index entries gets one record per entry, and only the
+// first holds the image.
 struct AriesLogRecord {
   void init() {
     checksum = 0;
+    size = 0;
     lsn = UINT64_MAX;
     type = LRT_UPDATE;
     iud = L_UPDATE;
     txn_id = UINT64_MAX; 
+    part_id = 0;
     table_id = 0;
     key = UINT64_MAX;
+    index_id = 0;
+    index_key = UINT64_MAX;
+    index_cnt = -1;
+    n_cols = 0;
+    cols = NULL;
+    after_image_size = 0;
+    after_image = NULL;
   }
 
-  uint32_t checksum;
+  uint32_t checksum; // CRC32C of the serialized record after this field
+  uint32_t size; // serialized size in bytes
   uint64_t lsn;
   LogRecType type;
   LogIUD iud;
   uint64_t txn_id; // transaction id
-  //uint32_t partid; // partition id
+  uint64_t part_id; // partition of the row; recovery replays per partition
   uint32_t table_id; // table being updated
-  uint64_t key; // primary key (determines the partition ID)
-  // TODO: column list
-  
-  /*lsn
+  uint64_t key; // primary key
+  // how recovery finds the row again: the index the txn read it through,
+  // and its position among the rows under index_key (-1 if unique).
+  // [L_INSERT] the index to add the row to (UINT32_MAX if none), and the
+  // row's position among the rows the txn inserted
+  uint32_t index_id;
+  uint64_t index_key;
+  int32_t index_cnt;
   uint32_t n_cols; //how many columns are being updated
   uint32_t* cols; //ids of modified columns
-  uint32_t before_image_size; 
-  char * before_image; // data buffer for before image
   uint32_t after_image_size; 
-  char * after_image; // data buffer for after image
-  */
-
+  char * after_image; // values of cols, in order
 };
 
 class LogRecord {
@@ -65,8 +95,14 @@ public:
   //LogRecord();
   LogRecType getType() { return rcd.type; }
   void copyRecord( LogRecord * record);
-  // TODO: compute a reasonable checksum
-  uint64_t computeChecksum() {return (uint64_t)rcd.txn_id;};
+  uint64_t get_size();
+  // serializes the record and stamps its size and checksum
+  void copy_to_buf(char * buf);
+  // returns false unless buf starts with a whole record whose checksum
+  // matches; buf_size bounds the bytes that may be read
+  bool copy_from_buf(char * buf, uint64_t buf_size);
+  void release();
+  static uint32_t computeChecksum(char * buf, uint64_t size);
 #if LOG_COMMAND
   CmdLogRecord rcd;
 #else
@@ -77,6 +113,34 @@ private:
 
 };
 
+// a txn waiting for its records to be durable
+struct LogNotify {
+  uint64_t txn_id;
+  uint64_t batch_id;
+};
+
+// Per-thread log buffer: a byte ring written only by its owner thread and
+// drained only by the log thread, plus a ring of txns waiting for the log
+// to be durable. Positions grow monotonically; index with % size.
+struct LogBuffer {
+  char * data;
+  LogNotify * notify;
+  // advanced by the owner
+  volatile uint64_t tail;
+  volatile uint64_t notify_tail;
+  // lower bound on the lsns of a txn whose writes may not all be in the
+  // rows yet; UINT64_MAX when there is none
+  volatile uint64_t apply_lsn;
+  // advanced by the log thread
+  volatile uint64_t head __attribute__ ((aligned(CL_SIZE)));
+  volatile uint64_t notify_head;
+} __attribute__ ((aligned(CL_SIZE)));
+
+// Group commit: worker threads serialize records into their own LogBuffer.
+// The log thread coalesces all buffers into one aligned group buffer, writes
+// it with a single write() and fdatasync() once the group reaches
+// g_log_buf_max bytes or g_log_flush_timeout passes, and only then sends
+// LOG_FLUSHED to the txns of the group.
 class Logger {
 public:
   void init(const char * log_file);
@@ -91,24 +155,96 @@ public:
     //uint64_t partid,
     uint64_t table_id,
     uint64_t key);
-  void enqueueRecord(LogRecord* record); 
+#if LOG_COMMAND
+  // command record holding txn's query, serialized as a client query
+  LogRecord * createRecord(TxnManager * txn);
+#else
+  // redo record for an update of row: holds the columns in which row
+  // differs from before_row, or all of them if before_row is NULL
+  LogRecord * createRecord(
+    uint64_t txn_id,
+    row_t * row,
+    row_t * before_row,
+    uint32_t index_id,
+    uint64_t index_key,
+    int index_cnt,
+    uint64_t part_id);
+  // insert record for the row_idx'th row txn_id inserted, adding it to
+  // index_id under index_key; image is false for the row's later entries
+  LogRecord * createInsertRecord(
+    uint64_t txn_id,
+    row_t * row,
+    bool image,
+    uint32_t index_id,
+    uint64_t index_key,
+    int row_idx,
+    uint64_t part_id);
+#endif
+  // serializes (or, for L_NOTIFY, queues) the record in thd_id's buffer and
+  // frees it
+  void enqueueRecord(uint64_t thd_id, LogRecord* record); 
+  // log thread: moves buffered records into the group buffer
   void processRecord(uint64_t thd_id); 
+  // parks the log thread while nothing is buffered or waiting on a flush
+  void idle(uint64_t thd_id);
   void writeToBuffer(uint64_t thd_id,char * data, uint64_t size); 
   void writeToBuffer(uint64_t thd_id,LogRecord* record); 
-  uint64_t reserveBuffer(uint64_t size); 
-  void notify_on_sync(uint64_t txn_id);
+  // replays the intact prefix of log_file into wl's rows and cuts off any
+  // torn tail. Redo records are replayed one partition per recovery
+  // thread; command records are re-executed serially.
+  // records below start_lsn are already in wl's rows (see Checkpointer).
+  void recover(const char * log_file, Workload * wl, uint64_t start_lsn = 0);
+  // bracket the window from logging a txn's writes to releasing them
+  void begin_apply(uint64_t thd_id);
+  void end_apply(uint64_t thd_id);
+  // every update with a smaller lsn has been applied to its row
+  uint64_t get_applied_lsn();
+#if !LOG_COMMAND
+  // recovery thread: replays partitions until none are left
+  void replay();
+#endif
 private:
-  pthread_mutex_t mtx;
+  Parker parker;
   uint64_t lsn;
 
   void flushBuffer(uint64_t thd_id);
-  std::queue<LogRecord*> log_queue;
+  void notify_on_sync(uint64_t thd_id, uint64_t txn_id, uint64_t batch_id);
+  // copies buf's bytes up to position end into the group buffer, as far as
+  // it has room; returns true if all of them fit
+  bool drainBuffer(LogBuffer * buf, uint64_t end);
   const char * log_file_name;
-  std::ofstream log_file;
-  uint64_t aries_write_offset;
-  std::set<uint64_t> txns_to_notify;
+  int log_fd;
+  LogBuffer * log_bufs;
+  uint32_t log_buf_cnt;
+  // group buffer
+  char * group_buf;
+  uint64_t group_size;
+  uint64_t group_capacity;
+  // buffer positions of the group being gathered. The notify positions
+  // are read before the data positions: a txn's records precede its
+  // notify, so every txn up to notify_end has its records before data_end.
+  uint64_t * notify_end;
+  uint64_t * data_end;
+  bool gathering;
+  std::vector<LogNotify> txns_to_notify;
   uint64_t last_flush;
-  uint64_t log_buf_cnt;
+  // recovery state: the records of each partition (command records all
+  // go to partition 0)
+  Workload * recover_wl;
+  std::vector<LogRecord*> * recover_recs;
+  volatile uint64_t recover_cnt;
+#if LOG_COMMAND
+  void replayCommands();
+#else
+  void replayPartition(uint64_t part_id);
+  // rows a partition's insert records created, by (txn_id, row_idx)
+  typedef std::map<std::pair<uint64_t,int32_t>, row_t*> InsertedRows;
+  bool replayInsert(AriesLogRecord & rcd, InsertedRows & inserted);
+  // recovery's tables by table id
+  std::vector<table_t*> recover_tables;
+  volatile uint64_t recover_next_part;
+  volatile uint64_t recover_miss_cnt;
+#endif
 };
 
 
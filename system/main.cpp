@@ -24,6 +24,8 @@
 #include "abort_thread.h"
 #include "io_thread.h"
 #include "log_thread.h"
+#include "checkpoint_thread.h"
+#include "checkpoint.h"
 #include "manager.h"
 #include "math.h"
 #include "query.h"
@@ -37,6 +39,10 @@
 #include "abort_queue.h"
 #include "work_queue.h"
 #include "maat.h"
+#include "silo.h"
+#include "dl_detect.h"
+#include "numa.h"
+#include "mem_alloc.h"
 #include "client_query.h"
 
 void network_test();
@@ -49,6 +55,7 @@ InputThread * input_thds;
 OutputThread * output_thds;
 AbortThread * abort_thds;
 LogThread * log_thds;
+CheckpointThread * ckpt_thds;
 #if CC_ALG == CALVIN
 CalvinLockThread * calvin_lock_thds;
 CalvinSequencerThread * calvin_seq_thds;
@@ -76,6 +83,13 @@ int main(int argc, char* argv[])
   fflush(stdout);
 	stats.init(g_total_thread_cnt);
   printf("Done\n");
+#if NUMA_PLACEMENT
+  printf("Initializing NUMA placement...\n");
+  fflush(stdout);
+  numa_map.init();
+  mem_allocator.init();
+  printf("Done\n");
+#endif
   printf("Initializing global manager... ");
   fflush(stdout);
 	glob_manager.init();
@@ -141,10 +155,12 @@ int main(int argc, char* argv[])
   fflush(stdout);
   row_pool.init(m_wl,0);
   printf("Done\n");
-  printf("Initializing access pool... ");
+#if CC_ALG == MVCC
+  printf("Initializing version pool... ");
   fflush(stdout);
-  access_pool.init(m_wl,0);
+  version_pool.init(MVCC_VERSION_POOL_SIZE);
   printf("Done\n");
+#endif
   printf("Initializing txn node table pool... ");
   fflush(stdout);
   txn_table_pool.init(m_wl,0);
@@ -178,6 +194,11 @@ int main(int argc, char* argv[])
   printf("Done\n");
 #endif
 #if LOGGING
+#if LOG_RECOVER
+  printf("Recovering from log...\n");
+  fflush(stdout);
+  logger.recover("logfile.log",m_wl,checkpointer.get_lsn());
+#endif
   printf("Initializing logger... ");
   fflush(stdout);
   logger.init("logfile.log");
@@ -201,8 +222,11 @@ int main(int argc, char* argv[])
 #if LOGGING
     all_thd_cnt += 1; // logger thread
 #endif
+#if CHECKPOINT
+    all_thd_cnt += 1; // checkpoint thread
+#endif
 #if CC_ALG == CALVIN
-    all_thd_cnt += 2; // sequencer + scheduler thread
+    all_thd_cnt += g_seq_thread_cnt + g_calvin_lock_thread_cnt; // sequencer + lock threads
 #endif
     assert(all_thd_cnt == g_this_total_thread_cnt);
 	
@@ -216,9 +240,10 @@ int main(int argc, char* argv[])
     output_thds = new OutputThread[sthd_cnt];
     abort_thds = new AbortThread[1];
     log_thds = new LogThread[1];
+    ckpt_thds = new CheckpointThread[1];
 #if CC_ALG == CALVIN
-    calvin_lock_thds = new CalvinLockThread[1];
-    calvin_seq_thds = new CalvinSequencerThread[1];
+    calvin_lock_thds = new CalvinLockThread[g_calvin_lock_thread_cnt];
+    calvin_seq_thds = new CalvinSequencerThread[g_seq_thread_cnt];
 #endif
 	// query_queue should be the last one to be initialized!!!
 	// because it collects txn latency
@@ -230,6 +255,14 @@ int main(int argc, char* argv[])
     occ_man.init();
     printf("Done\n");
 #endif
+#if CC_ALG == DL_DETECT
+    dl_detector.init();
+#endif
+#if CC_ALG == SILO
+    printf("Initializing silo manager... ");
+    silo_man.init();
+    printf("Done\n");
+#endif
 
     /*
     printf("Initializing threads... ");
@@ -246,7 +279,7 @@ int main(int argc, char* argv[])
     warmup_done = true;
     pthread_barrier_init( &warmup_bar, NULL, all_thd_cnt);
 
-#if SET_AFFINITY
+#if SET_AFFINITY && !NUMA_PLACEMENT
   uint64_t cpu_cnt = 0;
   cpu_set_t cpus;
 #endif
@@ -256,7 +289,9 @@ int main(int argc, char* argv[])
 
   uint64_t id = 0;
   for (uint64_t i = 0; i < wthd_cnt; i++) {
-#if SET_AFFINITY
+#if NUMA_PLACEMENT
+      numa_map.set_affinity(&attr, id);
+#elif SET_AFFINITY
       CPU_ZERO(&cpus);
       CPU_SET(cpu_cnt, &cpus);
       pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
@@ -269,44 +304,81 @@ int main(int argc, char* argv[])
 	for (uint64_t j = 0; j < rthd_cnt ; j++) {
 	    assert(id >= wthd_cnt && id < wthd_cnt + rthd_cnt);
 	    input_thds[j].init(id,g_node_id,m_wl);
+#if NUMA_PLACEMENT
+	    numa_map.set_affinity(&attr, id);
+	    pthread_create(&p_thds[id++], &attr, run_thread, (void *)&input_thds[j]);
+#else
 	    pthread_create(&p_thds[id++], NULL, run_thread, (void *)&input_thds[j]);
+#endif
 	}
 
 
 	for (uint64_t j = 0; j < sthd_cnt; j++) {
 	    assert(id >= wthd_cnt + rthd_cnt && id < wthd_cnt + rthd_cnt + sthd_cnt);
 	    output_thds[j].init(id,g_node_id,m_wl);
+#if NUMA_PLACEMENT
+	    numa_map.set_affinity(&attr, id);
+	    pthread_create(&p_thds[id++], &attr, run_thread, (void *)&output_thds[j]);
+#else
 	    pthread_create(&p_thds[id++], NULL, run_thread, (void *)&output_thds[j]);
+#endif
 	  }
 #if LOGGING
     log_thds[0].init(id,g_node_id,m_wl);
+#if NUMA_PLACEMENT
+    numa_map.set_affinity(&attr, id);
+    pthread_create(&p_thds[id++], &attr, run_thread, (void *)&log_thds[0]);
+#else
     pthread_create(&p_thds[id++], NULL, run_thread, (void *)&log_thds[0]);
 #endif
+#endif
+#if CHECKPOINT
+    ckpt_thds[0].init(id,g_node_id,m_wl);
+#if NUMA_PLACEMENT
+    numa_map.set_affinity(&attr, id);
+    pthread_create(&p_thds[id++], &attr, run_thread, (void *)&ckpt_thds[0]);
+#else
+    pthread_create(&p_thds[id++], NULL, run_thread, (void *)&ckpt_thds[0]);
+#endif
+#endif
 
 #if CC_ALG != CALVIN
   abort_thds[0].init(id,g_node_id,m_wl);
+#if NUMA_PLACEMENT
+  numa_map.set_affinity(&attr, id);
+  pthread_create(&p_thds[id++], &attr, run_thread, (void *)&abort_thds[0]);
+#else
   pthread_create(&p_thds[id++], NULL, run_thread, (void *)&abort_thds[0]);
 #endif
+#endif
 
 #if CC_ALG == CALVIN
-#if SET_AFFINITY
+  for (uint64_t i = 0; i < g_calvin_lock_thread_cnt; i++) {
+#if NUMA_PLACEMENT
+    numa_map.set_affinity(&attr, id);
+#elif SET_AFFINITY
 		CPU_ZERO(&cpus);
     CPU_SET(cpu_cnt, &cpus);
     pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
 		cpu_cnt++;
 #endif
-
-  calvin_lock_thds[0].init(id,g_node_id,m_wl);
-  pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_lock_thds[0]);
-#if SET_AFFINITY
+    calvin_lock_thds[i].init(id,g_node_id,m_wl);
+    calvin_lock_thds[i].slice = i;
+    pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_lock_thds[i]);
+  }
+  for (uint64_t i = 0; i < g_seq_thread_cnt; i++) {
+#if NUMA_PLACEMENT
+    numa_map.set_affinity(&attr, id);
+#elif SET_AFFINITY
 		CPU_ZERO(&cpus);
     CPU_SET(cpu_cnt, &cpus);
     pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
 		cpu_cnt++;
 #endif
-
-  calvin_seq_thds[0].init(id,g_node_id,m_wl);
-  pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_seq_thds[0]);
+    calvin_seq_thds[i].init(id,g_node_id,m_wl);
+    calvin_seq_thds[i].seq_id = i;
+    pthread_create(&p_thds[id++], &attr, run_thread, (void *)&calvin_seq_thds[i]);
+  }
 #endif
 
 
@@ -329,7 +401,6 @@ int main(int argc, char* argv[])
   /*
   txn_table.delete_all();
   txn_pool.free_all();
-  access_pool.free_all();
   txn_table_pool.free_all();
   msg_pool.free_all();
   qry_pool.free_all();
@@ -339,6 +410,7 @@ int main(int argc, char* argv[])
 
 void * run_thread(void * id) {
     Thread * thd = (Thread *) id;
+    mem_allocator.bind_thread(thd->get_thd_id());
 	thd->run();
 	return NULL;
 }
@@ -22,8 +22,10 @@
 
 void Manager::init() {
 	timestamp = 1;
+	ts_base = g_ts_alloc == TS_CLOCK ? get_wall_clock() * (g_node_cnt + g_thread_cnt) : 0;
 	last_min_ts_time = 0;
 	min_ts = 0; 
+	min_ts_latch = false;
 	all_ts = (ts_t *) malloc(sizeof(ts_t) * (g_thread_cnt * g_node_cnt));
 	_all_txns = new TxnManager * [g_thread_cnt + g_rem_thread_cnt];
 	for (UInt32 i = 0; i < g_thread_cnt + g_rem_thread_cnt; i++) {
@@ -70,15 +72,32 @@ Manager::get_ts(uint64_t thread_id) {
 
 ts_t Manager::get_min_ts(uint64_t tid) {
 	uint64_t now = get_sys_clock();
-	if (now - last_min_ts_time > MIN_TS_INTVL) { 
-		last_min_ts_time = now;
-    uint64_t min = txn_table.get_min_ts(tid);
+	uint64_t last = last_min_ts_time;
+	// once per MIN_TS_INTVL, one thread moves the low watermark up
+	if (now - last > MIN_TS_INTVL && ATOM_CAS(last_min_ts_time, last, now)) {
+    while(!ATOM_CAS(min_ts_latch,false,true)) { };
+    // a txn that starts after the scan gets a larger ts than this
+    uint64_t min = get_ts(tid);
+    uint64_t active_min = txn_table.get_min_ts(tid);
+    if(active_min < min)
+      min = active_min;
     if(min > min_ts)
 		  min_ts = min;
+    ATOM_CAS(min_ts_latch,true,false);
 	} 
 	return min_ts;
 }
 
+ts_t Manager::get_snapshot_ts(uint64_t tid, uint64_t txn_id) {
+  // a refresh either published before we read min_ts, or its scan sees
+  // the registration below; either way the watermark stays above ts
+  while(!ATOM_CAS(min_ts_latch,false,true)) { };
+  ts_t ts = min_ts > 0 ? min_ts - 1 : 0;
+  txn_table.update_min_ts(tid,txn_id,0,ts);
+  ATOM_CAS(min_ts_latch,true,false);
+  return ts;
+}
+
 void Manager::set_txn_man(TxnManager * txn) {
 	int thd_id = txn->get_thd_id();
 	_all_txns[thd_id] = txn;
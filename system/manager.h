@@ -29,8 +29,15 @@ public:
 	// returns the next timestamp.
 	ts_t			get_ts(uint64_t thread_id);
 
-	// For MVCC. To calculate the min active ts in the system
+	// For MVCC. The min active ts in the system, refreshed every MIN_TS_INTVL.
+	// No active txn has a smaller ts, so versions below it can be collected.
 	ts_t 			get_min_ts(uint64_t tid = 0);
+	// For MVCC snapshot reads. Returns a ts just below the watermark and
+	// registers it in txn_table before the watermark can move past it.
+	ts_t 			get_snapshot_ts(uint64_t tid, uint64_t txn_id);
+	// No ts handed out by this node is smaller. Lets callers keep
+	// timestamps relative to the start of the run.
+	ts_t 			get_ts_base() { return ts_base; };
 
 	// HACK! the following mutexes are used to model a centralized
 	// lock/timestamp manager. 
@@ -42,12 +49,15 @@ public:
 private:
 	pthread_mutex_t ts_mutex;
 	uint64_t 		timestamp;
+	ts_t 			ts_base;
 	pthread_mutex_t mutexes[BUCKET_CNT];
 	uint64_t 		hash(row_t * row);
 	ts_t * volatile all_ts;
 	TxnManager ** 		_all_txns;
-	ts_t			last_min_ts_time;
-	ts_t			min_ts;
+	volatile ts_t	last_min_ts_time;
+	volatile ts_t	min_ts;
+	// orders watermark refreshes against snapshot ts registration
+	volatile bool	min_ts_latch;
 };
 
 #endif
@@ -18,9 +18,71 @@
 #include "helper.h"
 #include "global.h"
 #include "jemalloc/jemalloc.h"
+#include "numa.h"
+#include <map>
 
 //#define N_MALLOC
 
+#ifndef N_MALLOC
+// [NUMA_PLACEMENT] node of each arena we created; written before the
+// arena's hooks are installed and only read afterwards
+static std::map<unsigned,uint64_t> arena_nodes;
+static chunk_alloc_t * default_chunk_alloc;
+
+// jemalloc asks for chunks before touching them, so setting the policy here
+// places the arena's memory on its node
+static void * numa_chunk_alloc(void * new_addr, size_t size, size_t alignment,
+    bool * zero, bool * commit, unsigned arena_ind) {
+  void * chunk = default_chunk_alloc(new_addr, size, alignment, zero, commit, arena_ind);
+  if (chunk != NULL)
+    numa_map.place(chunk, size, arena_nodes[arena_ind]);
+  return chunk;
+}
+#endif
+
+void mem_alloc::init() {
+  thd_arenas = NULL;
+  node_arenas = NULL;
+#if NUMA_PLACEMENT && !defined(N_MALLOC)
+  node_arenas = new unsigned[numa_map.get_node_cnt()];
+  for (uint64_t i = 0; i < numa_map.get_node_cnt(); i++)
+    node_arenas[i] = create_arena(i);
+  thd_arenas = new unsigned[g_this_total_thread_cnt];
+  for (uint64_t i = 0; i < g_this_total_thread_cnt; i++)
+    thd_arenas[i] = create_arena(numa_map.get_thd_node(i));
+#endif
+}
+
+unsigned mem_alloc::create_arena(uint64_t node) {
+  unsigned arena = 0;
+#ifndef N_MALLOC
+  size_t sz = sizeof(arena);
+  int rc = je_mallctl("arenas.extend", &arena, &sz, NULL, 0);
+  assert(rc == 0);
+  char name[64];
+  sprintf(name, "arena.%u.chunk_hooks", arena);
+  chunk_hooks_t hooks;
+  sz = sizeof(hooks);
+  rc = je_mallctl(name, &hooks, &sz, NULL, 0);
+  assert(rc == 0);
+  default_chunk_alloc = hooks.alloc;
+  arena_nodes[arena] = node;
+  hooks.alloc = numa_chunk_alloc;
+  rc = je_mallctl(name, NULL, NULL, &hooks, sizeof(hooks));
+  assert(rc == 0);
+#endif
+  return arena;
+}
+
+void mem_alloc::bind_thread(uint64_t thd_id) {
+#ifndef N_MALLOC
+  if (thd_arenas == NULL)
+    return;
+  int rc = je_mallctl("thread.arena", NULL, NULL, &thd_arenas[thd_id], sizeof(unsigned));
+  assert(rc == 0);
+#endif
+}
+
 void mem_alloc::free(void * ptr, uint64_t size) {
 	if (NO_FREE) {} 
   DEBUG_M("free %ld 0x%lx\n",size,(uint64_t)ptr);
@@ -44,11 +106,30 @@ void * mem_alloc::alloc(uint64_t size) {
 	return ptr;
 }
 
+void * mem_alloc::alloc(uint64_t size, uint64_t part_id) {
+#ifndef N_MALLOC
+  if (node_arenas != NULL) {
+    // bypass the tcache, which may hold memory of another arena
+    void * ptr = je_mallocx(size,
+        MALLOCX_ARENA(node_arenas[numa_map.get_part_node(part_id)]) | MALLOCX_TCACHE_NONE);
+    DEBUG_M("alloc %ld 0x%lx part %ld\n",size,(uint64_t)ptr,part_id);
+    assert(ptr != NULL);
+    return ptr;
+  }
+#endif
+  return alloc(size);
+}
+
 void * mem_alloc::align_alloc(uint64_t size) {
   uint64_t aligned_size = size + CL_SIZE - (size % CL_SIZE);
   return alloc(aligned_size);
 }
 
+void * mem_alloc::align_alloc(uint64_t size, uint64_t part_id) {
+  uint64_t aligned_size = size + CL_SIZE - (size % CL_SIZE);
+  return alloc(aligned_size, part_id);
+}
+
 
 void * mem_alloc::realloc(void * ptr, uint64_t size) {
 #ifdef N_MALLOC
@@ -21,10 +21,22 @@
 
 class mem_alloc {
 public:
+    // [NUMA_PLACEMENT] creates a jemalloc arena on the node of each thread
+    // and one per node for the partitions; a no-op otherwise
+    void init();
+    // binds the calling thread to the arena of thread thd_id
+    void bind_thread(uint64_t thd_id);
     void * alloc(uint64_t size);
+    // allocates on the node serving part_id
+    void * alloc(uint64_t size, uint64_t part_id);
     void * align_alloc(uint64_t size);
+    void * align_alloc(uint64_t size, uint64_t part_id);
     void * realloc(void * ptr, uint64_t size);
     void free(void * block, uint64_t size);
+private:
+    unsigned create_arena(uint64_t node);
+    unsigned * thd_arenas;
+    unsigned * node_arenas;
 };
 
 #endif
@@ -40,6 +40,9 @@ void MessageQueue::init() {
   }
   for(uint64_t i = 0; i < g_this_send_thread_cnt;i++)
     sthd_m_cache.push_back(NULL);
+  parkers = (Parker *) mem_allocator.align_alloc(sizeof(Parker) * g_this_send_thread_cnt);
+  for(uint64_t i = 0; i < g_this_send_thread_cnt;i++)
+    parkers[i].init();
 }
 
 void MessageQueue::enqueue(uint64_t thd_id, Message * msg,uint64_t dest) {
@@ -63,10 +66,12 @@ void MessageQueue::enqueue(uint64_t thd_id, Message * msg,uint64_t dest) {
 #if NETWORK_DELAY_TEST
   if(ISCLIENTN(dest)) {
     while(!cl_m_queue[rand]->push(entry) && !simulation->is_done()) {}
+    parkers[rand].wake();
     return;
   }
 #endif
   while(!m_queue[rand]->push(entry) && !simulation->is_done()) {}
+  parkers[rand].wake();
   INC_STATS(thd_id,mtx[3],get_sys_clock() - mtx_time_start);
   INC_STATS(thd_id,msg_queue_enq_cnt,1);
 
@@ -139,3 +144,38 @@ uint64_t MessageQueue::dequeue(uint64_t thd_id, Message *& msg) {
   INC_STATS(thd_id,mtx[5],get_sys_clock() - curr_time);
   return dest;
 }
+
+uint64_t MessageQueue::dequeue(uint64_t thd_id, Message ** msgs, uint64_t * dests, uint64_t max_cnt) {
+#if NETWORK_DELAY_TEST
+  // delayed messages are held back one at a time; msgs[0] is left
+  // unset while the head message is held
+  msgs[0] = NULL;
+  dests[0] = dequeue(thd_id,msgs[0]);
+  return dests[0] != UINT64_MAX ? 1 : 0;
+#else
+  msg_entry * entry = NULL;
+  uint64_t cnt = 0;
+  uint64_t curr_time = get_sys_clock();
+  while(cnt < max_cnt && m_queue[thd_id%g_this_send_thread_cnt]->pop(entry)) {
+    assert(entry->dest < g_total_node_cnt);
+    dests[cnt] = entry->dest;
+    msgs[cnt] = entry->msg;
+    msgs[cnt]->mq_time = curr_time - entry->starttime;
+    INC_STATS(thd_id,msg_queue_delay_time,curr_time - entry->starttime);
+    DEBUG("MQ Dequeue %ld\n",entry->dest)
+    DEBUG_M("MessageQueue::dequeue msg_entry free\n");
+    mem_allocator.free(entry,sizeof(struct msg_entry));
+    cnt++;
+  }
+  INC_STATS(thd_id,msg_queue_cnt,cnt);
+  INC_STATS(thd_id,mtx[4],get_sys_clock() - curr_time);
+  return cnt;
+#endif
+}
+
+void MessageQueue::idle(uint64_t thd_id) {
+  // delayed messages held in sthd_m_cache have no producer to wake us
+#if !NETWORK_DELAY_TEST
+  parkers[thd_id % g_this_send_thread_cnt].idle(thd_id);
+#endif
+}
@@ -19,6 +19,7 @@
 
 #include "global.h"
 #include "helper.h"
+#include "parker.h"
 #include "concurrentqueue.h"
 #include "lock_free_queue.h"
 #include <boost/lockfree/queue.hpp>
@@ -39,6 +40,11 @@ public:
   void init();
   void enqueue(uint64_t thd_id, Message * msg, uint64_t dest);
   uint64_t dequeue(uint64_t thd_id, Message *& msg);
+  // dequeues up to max_cnt messages and their destinations; returns the count
+  uint64_t dequeue(uint64_t thd_id, Message ** msgs, uint64_t * dests, uint64_t max_cnt);
+  // spin-then-park for idle send threads
+  void idle(uint64_t thd_id);
+  void busy(uint64_t thd_id) {parkers[thd_id % g_this_send_thread_cnt].busy();}
 private:
  //LockfreeQueue m_queue;
 // This is close to max capacity for boost
@@ -47,6 +53,7 @@ private:
 #endif
   boost::lockfree::queue<msg_entry*> ** m_queue;
   std::vector<msg_entry*> sthd_m_cache;
+  Parker * parkers;
   uint64_t ** ctr;
 
 };
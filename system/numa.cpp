@@ -0,0 +1,141 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "numa.h"
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+void NumaMap::init() {
+  DIR * dir = opendir("/sys/devices/system/node");
+  if(dir) {
+    struct dirent * ent;
+    std::vector<uint64_t> ids;
+    while((ent = readdir(dir)) != NULL) {
+      unsigned id;
+      char c;
+      if(sscanf(ent->d_name, "node%u%c", &id, &c) == 1)
+        ids.push_back(id);
+    }
+    closedir(dir);
+    std::sort(ids.begin(), ids.end());
+    for(uint64_t i = 0; i < ids.size(); i++) {
+      char path[64];
+      sprintf(path, "/sys/devices/system/node/node%lu/cpulist", ids[i]);
+      std::vector<uint64_t> list;
+      read_cpulist(path, list);
+      // memory-only nodes get no threads
+      if(list.empty())
+        continue;
+      node_ids.push_back(ids[i]);
+      cpus.push_back(list);
+    }
+  }
+  if(cpus.empty()) {
+    // no NUMA information: one node with every online core
+    std::vector<uint64_t> list;
+    read_cpulist("/sys/devices/system/cpu/online", list);
+    if(list.empty()) {
+      for(long i = 0; i < sysconf(_SC_NPROCESSORS_ONLN); i++)
+        list.push_back(i);
+    }
+    node_ids.push_back(0);
+    cpus.push_back(list);
+  }
+  next_cpu.assign(cpus.size(), 0);
+  for(uint64_t i = 0; i < cpus.size(); i++)
+    printf("NUMA node %ld: %ld cores\n", node_ids[i], cpus[i].size());
+}
+
+void NumaMap::read_cpulist(const char * path, std::vector<uint64_t> & list) {
+  FILE * f = fopen(path, "r");
+  if(!f)
+    return;
+  // e.g. "0-13,28-41"
+  unsigned lo, hi;
+  while(fscanf(f, "%u", &lo) == 1) {
+    hi = lo;
+    int c = fgetc(f);
+    if(c == '-') {
+      if(fscanf(f, "%u", &hi) != 1)
+        break;
+      c = fgetc(f);
+    }
+    for(uint64_t cpu = lo; cpu <= hi; cpu++)
+      list.push_back(cpu);
+    if(c != ',')
+      break;
+  }
+  fclose(f);
+}
+
+uint64_t NumaMap::get_thd_node(uint64_t thd_id) {
+  if(thd_id < g_thread_cnt) {
+    if(NUMA_WORKER_NODE < 0)
+      return thd_id % get_node_cnt();
+    return NUMA_WORKER_NODE % get_node_cnt();
+  }
+  if(thd_id < g_thread_cnt + g_rem_thread_cnt + g_send_thread_cnt)
+    return NUMA_IO_NODE % get_node_cnt();
+  return NUMA_AUX_NODE % get_node_cnt();
+}
+
+uint64_t NumaMap::get_part_node(uint64_t part_id) {
+  if(NUMA_WORKER_NODE < 0)
+    return (part_id / g_node_cnt) % get_node_cnt();
+  return NUMA_WORKER_NODE % get_node_cnt();
+}
+
+void NumaMap::set_affinity(pthread_attr_t * attr, uint64_t thd_id) {
+  uint64_t node = get_thd_node(thd_id);
+  std::vector<uint64_t> & list = cpus[node];
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if(thd_id < g_thread_cnt) {
+    // wraps around if the node has fewer cores than workers
+    CPU_SET(list[next_cpu[node]++ % list.size()], &set);
+  } else {
+    for(uint64_t i = 0; i < list.size(); i++)
+      CPU_SET(list[i], &set);
+  }
+  pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), &set);
+}
+
+void NumaMap::place(void * addr, uint64_t size, uint64_t node) {
+  set_policy(addr, size, MPOL_PREFERRED, 1UL << node_ids[node]);
+}
+
+void NumaMap::interleave(void * addr, uint64_t size) {
+  uint64_t mask = 0;
+  for(uint64_t i = 0; i < node_ids.size(); i++)
+    mask |= 1UL << node_ids[i];
+  set_policy(addr, size, MPOL_INTERLEAVE, mask);
+}
+
+void NumaMap::set_policy(void * addr, uint64_t size, int mode, uint64_t mask) {
+  if(get_node_cnt() < 2)
+    return;
+  // only the whole pages inside the range
+  uint64_t page = sysconf(_SC_PAGESIZE);
+  uint64_t start = ((uint64_t)addr + page - 1) & ~(page - 1);
+  uint64_t end = ((uint64_t)addr + size) & ~(page - 1);
+  if(end <= start)
+    return;
+  // a failure only costs locality
+  syscall(SYS_mbind, start, end - start, mode, &mask, sizeof(mask) * 8, 0);
+}
@@ -0,0 +1,51 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _NUMA_H_
+#define _NUMA_H_
+
+#include "global.h"
+#include <vector>
+
+// NUMA topology of this machine, read from sysfs, and the placement of
+// threads and partitions on it. Worker threads are spread round-robin over
+// the nodes (or all put on NUMA_WORKER_NODE) and each gets a core of its
+// own; input/output threads and the other threads get all cores of
+// NUMA_IO_NODE and NUMA_AUX_NODE. A partition lives on the node of the
+// worker with the same local index, so with HSTORE a worker's partition is
+// on its own node.
+class NumaMap {
+public:
+  void init();
+  uint64_t get_node_cnt() { return cpus.size(); }
+  uint64_t get_thd_node(uint64_t thd_id);
+  uint64_t get_part_node(uint64_t part_id);
+  void set_affinity(pthread_attr_t * attr, uint64_t thd_id);
+  // prefer node for the pages of [addr, addr + size) that are not yet touched
+  void place(void * addr, uint64_t size, uint64_t node);
+  // spread the pages of [addr, addr + size) over all nodes
+  void interleave(void * addr, uint64_t size);
+private:
+  void read_cpulist(const char * path, std::vector<uint64_t> & list);
+  void set_policy(void * addr, uint64_t size, int mode, uint64_t mask);
+  // sysfs id and cpus of each node
+  std::vector<uint64_t> node_ids;
+  std::vector<std::vector<uint64_t> > cpus;
+  // next core handed to a worker, per node
+  std::vector<uint64_t> next_cpu;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "parker.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+void Parker::init() {
+  seq = 0;
+  sleeping = false;
+  wake_time = 0;
+  key = 0;
+  armed = false;
+  spins = 0;
+}
+
+void Parker::idle(uint64_t thd_id) {
+  if(!IDLE_PARK)
+    return;
+  if(spins < g_idle_spin_cnt) {
+    spins++;
+    __asm__ __volatile__("pause" ::: "memory");
+    return;
+  }
+  if(!armed) {
+    // A producer that publishes after the consumer's next poll sees
+    // sleeping and bumps seq, so the futex wait below cannot miss it
+    key = seq;
+    sleeping = true;
+    __sync_synchronize();
+    armed = true;
+    return;
+  }
+  uint64_t starttime = get_sys_clock();
+  struct timespec timeout;
+  timeout.tv_sec = IDLE_PARK_TIMEOUT / BILLION;
+  timeout.tv_nsec = IDLE_PARK_TIMEOUT % BILLION;
+  syscall(SYS_futex,&seq,FUTEX_WAIT_PRIVATE,key,&timeout,NULL,0);
+  uint64_t endtime = get_sys_clock();
+  INC_STATS(thd_id,idle_park_cnt,1);
+  INC_STATS(thd_id,idle_park_time,endtime - starttime);
+  if(seq != key) {
+    INC_STATS(thd_id,idle_wakeup_cnt,1);
+    if(endtime > wake_time)
+      INC_STATS(thd_id,idle_wakeup_time,endtime - wake_time);
+  }
+  sleeping = false;
+  armed = false;
+  spins = 0;
+}
+
+bool Parker::wake() {
+  if(!IDLE_PARK)
+    return false;
+  // order the caller's publish before the read of sleeping
+  __sync_synchronize();
+  // only the first producer to see the consumer asleep pays for the syscall
+  if(!sleeping || !ATOM_CAS(sleeping,true,false))
+    return false;
+  wake_time = get_sys_clock();
+  ATOM_ADD(seq,1);
+  syscall(SYS_futex,&seq,FUTEX_WAKE_PRIVATE,1,NULL,NULL,0);
+  return true;
+}
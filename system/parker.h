@@ -0,0 +1,52 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef _PARKER_H_
+#define _PARKER_H_
+
+#include <stdint.h>
+#include "config.h"
+
+// Spin-then-park idle handling for a queue with a single consumer thread.
+// The consumer calls idle() after every empty poll and busy() when it finds
+// work; producers call wake() after publishing work. Once the spin budget
+// (g_idle_spin_cnt polls) is used up, idle() announces the consumer as
+// sleeping and returns for one last poll; the next idle() sleeps on a futex
+// until a producer wakes it or IDLE_PARK_TIMEOUT passes.
+class Parker {
+public:
+  void init();
+  void idle(uint64_t thd_id);
+  void busy() {
+    spins = 0;
+    if(armed) {
+      armed = false;
+      sleeping = false;
+    }
+  }
+  // returns true if it woke the consumer up
+  bool wake();
+private:
+  volatile int32_t seq;
+  volatile bool sleeping;
+  volatile uint64_t wake_time;
+  // only touched by the consumer
+  int32_t key;
+  bool armed;
+  uint64_t spins;
+} __attribute__ ((aligned(CL_SIZE)));
+
+#endif
@@ -35,13 +35,18 @@ void print_usage() {
 
 	printf("\t-tppINT       ; MAX_TXN_PER_PART\n");
 	printf("\t-tifINT       ; MAX_TXN_IN_FLIGHT\n");
+	printf("\t-tlkINT       ; CALVIN_LOCK_THREAD_CNT\n");
+	printf("\t-tsqINT       ; SEQ_THREAD_CNT\n");
 	printf("\t-mprINT       ; MPR\n");
 	printf("\t-mpiINT       ; MPIR\n");
 	printf("\t-doneINT       ; DONE_TIMER\n");
 	printf("\t-btmrINT       ; BATCH_TIMER\n");
 	printf("\t-stmrINT       ; SEQ_BATCH_TIMER\n");
+	printf("\t-bonINT       ; BURST_ON_TIME\n");
+	printf("\t-boffINT       ; BURST_OFF_TIME\n");
 	printf("\t-progINT       ; PROG_TIMER\n");
 	printf("\t-abrtINT       ; ABORT_PENALTY (ms)\n");
+	printf("\t-spinINT       ; IDLE_SPIN_CNT\n");
 
 	printf("\t-qINT       ; QUERY_INTVL\n");
 	printf("\t-dINT       ; PRT_LAT_DISTR\n");
@@ -65,10 +70,15 @@ void print_usage() {
 	printf("\t-zipfFLOAT     ; ZIPF_THETA\n");
 	printf("\t-sINT       ; SYNTH_TABLE_SIZE\n");
 	printf("\t-rpqINT       ; REQ_PER_QUERY\n");
+	printf("\t-scpFLOAT       ; SCAN_PERC\n");
+	printf("\t-sclINT       ; SCAN_LEN\n");
 	printf("\t-fINT       ; FIELD_PER_TUPLE\n");
 	printf("  [TPCC]:\n");
 	printf("\t-whINT       ; NUM_WH\n");
 	printf("\t-ppFLOAT    ; PERC_PAYMENT\n");
+	printf("\t-posFLOAT   ; PERC_ORDER_STATUS\n");
+	printf("\t-pdlFLOAT   ; PERC_DELIVERY\n");
+	printf("\t-pslFLOAT   ; PERC_STOCK_LEVEL\n");
 	printf("\t-upINT      ; WH_UPDATE\n");
   
 }
@@ -85,12 +95,18 @@ void parser(int argc, char * argv[]) {
       g_batch_time_limit = atoi( &argv[i][5] );
     else if (argv[i][1] == 's' && argv[i][2] == 't' && argv[i][3] == 'm' && argv[i][4] == 'r')
       g_seq_batch_time_limit = atoi( &argv[i][5] );
+    else if (argv[i][1] == 'b' && argv[i][2] == 'o' && argv[i][3] == 'f' && argv[i][4] == 'f')
+      g_burst_off_time = atoi( &argv[i][5] );
+    else if (argv[i][1] == 'b' && argv[i][2] == 'o' && argv[i][3] == 'n')
+      g_burst_on_time = atoi( &argv[i][4] );
     else if (argv[i][1] == 's' && argv[i][2] == 'p' && argv[i][3] == 'p' && argv[i][4] == 't')
       g_strict_ppt = atoi( &argv[i][5] ) == 1;
     else if (argv[i][1] == 'p' && argv[i][2] == 'r' && argv[i][3] == 'o' && argv[i][4] == 'g')
 			g_thread_cnt = atoi( &argv[i][5] );
     else if (argv[i][1] == 'a' && argv[i][2] == 'b' && argv[i][3] == 'r' && argv[i][4] == 't')
 			g_abort_penalty = atoi( &argv[i][5] );
+    else if (argv[i][1] == 's' && argv[i][2] == 'p' && argv[i][3] == 'i' && argv[i][4] == 'n')
+			g_idle_spin_cnt = atoi( &argv[i][5] );
     else if (argv[i][1] == 'z' && argv[i][2] == 'i' && argv[i][3] == 'p' && argv[i][4] == 'f')
 			g_zipf_theta = atof( &argv[i][5] );
     else if (argv[i][1] == 'n' && argv[i][2] == 'i' && argv[i][3] == 'd')
@@ -105,6 +121,10 @@ void parser(int argc, char * argv[]) {
 			g_max_txn_per_part = atoi( &argv[i][4] );
     else if (argv[i][1] == 't' && argv[i][2] == 'i' && argv[i][3] == 'f')
 			g_inflight_max = atoi( &argv[i][4] );
+    else if (argv[i][1] == 't' && argv[i][2] == 'l' && argv[i][3] == 'k')
+			g_calvin_lock_thread_cnt = atoi( &argv[i][4] );
+    else if (argv[i][1] == 't' && argv[i][2] == 's' && argv[i][3] == 'q')
+			g_seq_thread_cnt = atoi( &argv[i][4] );
     else if (argv[i][1] == 'm' && argv[i][2] == 'p' && argv[i][3] == 'r')
 			g_mpr = atof( &argv[i][4] );
     else if (argv[i][1] == 'm' && argv[i][2] == 'p' && argv[i][3] == 'i')
@@ -113,6 +133,10 @@ void parser(int argc, char * argv[]) {
       g_part_per_txn = atoi( &argv[i][4] );
     else if (argv[i][1] == 'r' && argv[i][2] == 'p' && argv[i][3] == 'q')
       g_req_per_query = atoi( &argv[i][4] );
+    else if (argv[i][1] == 's' && argv[i][2] == 'c' && argv[i][3] == 'p')
+      g_scan_perc = atof( &argv[i][4] );
+    else if (argv[i][1] == 's' && argv[i][2] == 'c' && argv[i][3] == 'l')
+      g_scan_len = atoi( &argv[i][4] );
     else if (argv[i][1] == 'c' && argv[i][2] == 'n')
       g_client_node_cnt = atoi( &argv[i][3] );
     else if (argv[i][1] == 't' && argv[i][2] == 'r')
@@ -127,6 +151,12 @@ void parser(int argc, char * argv[]) {
 			txn_file = argv[++i];
     else if (argv[i][1] == 'p' && argv[i][2] == 'p')
       g_perc_payment = atof( &argv[i][3] );
+    else if (argv[i][1] == 'p' && argv[i][2] == 'o' && argv[i][3] == 's')
+      g_perc_order_status = atof( &argv[i][4] );
+    else if (argv[i][1] == 'p' && argv[i][2] == 'd' && argv[i][3] == 'l')
+      g_perc_delivery = atof( &argv[i][4] );
+    else if (argv[i][1] == 'p' && argv[i][2] == 's' && argv[i][3] == 'l')
+      g_perc_stock_level = atof( &argv[i][4] );
     else if (argv[i][1] == 'u' && argv[i][2] == 'p')
       g_wh_update = atoi( &argv[i][3] );
     else if (argv[i][1] == 'd' && argv[i][2] == 'p')
@@ -182,8 +212,11 @@ void parser(int argc, char * argv[]) {
 #if LOGGING
   g_total_thread_cnt += g_logger_thread_cnt; // logger thread
 #endif
+#if CHECKPOINT
+  g_total_thread_cnt += g_ckpt_thread_cnt; // checkpoint thread
+#endif
 #if CC_ALG == CALVIN
-    g_total_thread_cnt += 2; // sequencer + scheduler thread
+    g_total_thread_cnt += g_seq_thread_cnt + g_calvin_lock_thread_cnt; // sequencer + lock threads
   // Remove abort thread
   g_abort_thread_cnt = 0;
   g_total_thread_cnt -= 1;
@@ -217,17 +250,24 @@ void parser(int argc, char * argv[]) {
 			printf("g_client_send_thread_cnt %d\n",g_client_send_thread_cnt );
 			printf("g_max_txn_per_part %d\n",g_max_txn_per_part );
 			printf("g_load_per_server %d\n",g_load_per_server );
+			printf("g_burst_on_time %ld\n",g_burst_on_time );
+			printf("g_burst_off_time %ld\n",g_burst_off_time );
 			printf("g_inflight_max %d\n",g_inflight_max );
 			printf("g_mpr %f\n",g_mpr );
 			printf("g_mpitem %f\n",g_mpitem );
       printf("g_part_per_txn %d\n",g_part_per_txn );
       printf("g_req_per_query %d\n",g_req_per_query );
+      printf("g_scan_perc %f\n",g_scan_perc );
+      printf("g_scan_len %d\n",g_scan_len );
       printf("g_client_node_cnt %d\n",g_client_node_cnt );
       printf("g_rem_thread_cnt %d\n",g_rem_thread_cnt );
       printf("g_send_thread_cnt %d\n",g_send_thread_cnt );
       printf("g_client_thread_cnt %d\n",g_client_thread_cnt );
       printf("g_num_wh %d\n",g_num_wh );
       printf("g_perc_payment %f\n",g_perc_payment );
+      printf("g_perc_order_status %f\n",g_perc_order_status );
+      printf("g_perc_delivery %f\n",g_perc_delivery );
+      printf("g_perc_stock_level %f\n",g_perc_stock_level );
       printf("g_wh_update %d\n",g_wh_update );
       printf("g_part_cnt %d\n",g_part_cnt );
       printf("g_node_cnt %d\n",g_node_cnt );
@@ -254,6 +294,8 @@ void parser(int argc, char * argv[]) {
       printf("g_total_client_thread_cnt %d\n",g_total_client_thread_cnt);
       printf("g_total_node_cnt %d\n",g_total_node_cnt);
       printf("g_seq_batch_time_limit %ld\n",g_seq_batch_time_limit);
+      printf("g_seq_thread_cnt %d\n",g_seq_thread_cnt);
+      printf("g_calvin_lock_thread_cnt %d\n",g_calvin_lock_thread_cnt);
 
     // Initialize client-specific globals
     if (g_node_id >= g_node_cnt)
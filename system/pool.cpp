@@ -72,6 +72,7 @@ void TxnManPool::put(uint64_t thd_id, TxnManager * item) {
   while(!pool[thd_id]->push(item) && tries++ < TRY_LIMIT) { }
 #endif
   if(tries >= TRY_LIMIT) {
+    item->arena.release();
     mem_allocator.free(item,sizeof(TxnManager));
   }
 }
@@ -84,6 +85,7 @@ void TxnManPool::free_all() {
 #else
   while(pool[thd_id]->pop(item)) {
 #endif
+    item->arena.release();
     mem_allocator.free(item,sizeof(TxnManager));
   }
   }
@@ -253,50 +255,6 @@ void QryPool::free_all() {
 }
 
 
-void AccessPool::init(Workload * wl, uint64_t size) {
-  _wl = wl;
-  pool = new boost::lockfree::queue<Access* > * [g_total_thread_cnt];
-  DEBUG_M("AccessPool alloc init\n");
-  for(uint64_t thd_id = 0; thd_id < g_total_thread_cnt; thd_id++) {
-    pool[thd_id] = new boost::lockfree::queue<Access* > (size);
-    for(uint64_t i = 0; i < size; i++) {
-    Access * item = (Access*)mem_allocator.alloc(sizeof(Access));
-    put(thd_id,item);
-    }
-  }
-}
-
-void AccessPool::get(uint64_t thd_id, Access *& item) {
-  //bool r = pool->pop(item);
-  bool r = pool[thd_id]->pop(item);
-  if(!r) {
-    DEBUG_M("access_pool alloc\n");
-    item = (Access*)mem_allocator.alloc(sizeof(Access));
-  }
-}
-
-void AccessPool::put(uint64_t thd_id, Access * item) {
-  pool[thd_id]->push(item);
-  /*
-  int tries = 0;
-  while(!pool->push(item) && tries++ < TRY_LIMIT) { }
-  if(tries >= TRY_LIMIT) {
-    mem_allocator.free(item,sizeof(Access));
-  }
-  */
-}
-
-void AccessPool::free_all() {
-  Access * item;
-  DEBUG_M("access_pool free\n");
-  //while(pool->pop(item)) {
-    for(uint64_t thd_id = 0; thd_id < g_total_thread_cnt; thd_id++) {
-  while(pool[thd_id]->pop(item)) {
-    mem_allocator.free(item,sizeof(item));
-  }
-  }
-}
-
 void TxnTablePool::init(Workload * wl, uint64_t size) {
   _wl = wl;
   pool = new boost::lockfree::queue<txn_node* > * [g_total_thread_cnt];
@@ -414,3 +372,53 @@ void RowPool::free_all() {
   }
 }
 
+
+// a version of another table is only re-initialized if none of the top few
+// entries of the stack match
+#define VERSION_POOL_SCAN 4
+
+void VersionPool::init(uint64_t size) {
+  _size = size;
+  stacks = (version_stack *) mem_allocator.align_alloc(sizeof(version_stack) * g_total_thread_cnt);
+  for(uint64_t thd_id = 0; thd_id < g_total_thread_cnt; thd_id++) {
+    stacks[thd_id].rows = (row_t **) mem_allocator.alloc(sizeof(row_t *) * size);
+    stacks[thd_id].cnt = 0;
+  }
+}
+
+row_t * VersionPool::get(uint64_t thd_id, table_t * table, uint64_t part_id) {
+  version_stack * s = &stacks[thd_id];
+  row_t * row = NULL;
+  for(uint64_t i = 0; i < VERSION_POOL_SCAN && i < s->cnt; i++) {
+    row_t * r = s->rows[s->cnt - 1 - i];
+    if(r->get_table() == table && r->get_part_id() == part_id) {
+      s->rows[s->cnt - 1 - i] = s->rows[s->cnt - 1];
+      row = r;
+      break;
+    }
+  }
+  if(row) {
+    s->cnt--;
+    INC_STATS(thd_id,mvcc_version_reuse_cnt,1);
+    return row;
+  }
+  if(s->cnt > 0) {
+    row = s->rows[--s->cnt];
+    row->free_row();
+  } else {
+    DEBUG_M("VersionPool alloc\n");
+    row = (row_t *) mem_allocator.alloc(sizeof(row_t));
+  }
+  row->init(table, part_id);
+  return row;
+}
+
+void VersionPool::put(uint64_t thd_id, row_t * row) {
+  version_stack * s = &stacks[thd_id];
+  if(s->cnt < _size) {
+    s->rows[s->cnt++] = row;
+    return;
+  }
+  row->free_row();
+  mem_allocator.free(row, sizeof(row_t));
+}
@@ -28,9 +28,9 @@ class BaseQuery;
 class Workload;
 struct msg_entry;
 struct txn_node;
-class Access;
 class Transaction;
 class row_t;
+class table_t;
 
 
 class TxnManPool {
@@ -86,20 +86,6 @@ private:
 };
 
 
-class AccessPool {
-public:
-  void init(Workload * wl, uint64_t size);
-  void get(uint64_t thd_id, Access *& item);
-  void put(uint64_t thd_id, Access * items);
-  void free_all();
-
-private:
-  boost::lockfree::queue<Access* > ** pool;
-  Workload * _wl;
-
-};
-
-
 class TxnTablePool {
 public:
   void init(Workload * wl, uint64_t size);
@@ -138,5 +124,24 @@ private:
 
 };
 
+// MVCC versions are full rows whose data buffers are kept for reuse. A
+// version is taken and given back by the worker running the access, so each
+// thread has a plain stack with no synchronization.
+class VersionPool {
+public:
+  void init(uint64_t size);
+  // returns an initialized row of table/part_id; its data is garbage
+  row_t * get(uint64_t thd_id, table_t * table, uint64_t part_id);
+  void put(uint64_t thd_id, row_t * row);
+
+private:
+  struct version_stack {
+    row_t ** rows;
+    uint64_t cnt;
+  } __attribute__ ((aligned(CL_SIZE)));
+  version_stack * stacks;
+  uint64_t _size;
+};
+
 
 #endif
@@ -31,27 +31,49 @@
 #include <boost/lockfree/queue.hpp>
 
 void Sequencer::init(Workload * wl) {
-  next_txn_id = 0;
   rsp_cnt = g_node_cnt + g_client_node_cnt;
   _wl = wl;
   last_time_batch = 0;
-  wl_head = NULL;
-  wl_tail = NULL;
-  fill_queue = new boost::lockfree::queue<Message*, boost::lockfree::capacity<65526> > [g_node_cnt];
+  // participants are kept as a bitmap of nodes
+  assert(g_node_cnt <= 64);
+  epochs = (qlite_epoch *) mem_allocator.alloc(sizeof(qlite_epoch) * SEQ_EPOCH_WINDOW);
+  for(uint64_t i = 0; i < SEQ_EPOCH_WINDOW; i++) {
+    qlite_epoch * en = &epochs[i];
+    // each client has at most g_inflight_max txns at a node
+    en->max_size = g_inflight_max * g_client_node_cnt;
+    en->lists = (qlite **) mem_allocator.alloc(sizeof(qlite *) * g_seq_thread_cnt);
+    en->sizes = (uint64_t *) mem_allocator.alloc(sizeof(uint64_t) * g_seq_thread_cnt);
+    for(uint64_t j = 0; j < g_seq_thread_cnt; j++) {
+      en->lists[j] = (qlite *) mem_allocator.alloc(sizeof(qlite) * en->max_size);
+      en->sizes[j] = 0;
+    }
+    en->txns_left = 0;
+    en->sealed_cnt = 0;
+    en->epoch = 0;
+    en->busy = false;
+  }
+  fill_epoch = (uint64_t *) mem_allocator.alloc(sizeof(uint64_t) * g_seq_thread_cnt);
+  for(uint64_t j = 0; j < g_seq_thread_cnt; j++)
+    fill_epoch[j] = simulation->get_seq_epoch() + 1;
+  qlite_epoch * en = get_epoch(simulation->get_seq_epoch() + 1);
+  en->epoch = simulation->get_seq_epoch() + 1;
+  en->txns_left = 1;
+  en->busy = true;
 }
 
-// Assumes 1 thread does sequencer work
-void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
-  qlite_ll * en = wl_head;
-  while(en != NULL && en->epoch != msg->get_batch_id()) {
-    en = en->next;
-  }
-  assert(en);
-  qlite * wait_list = en->list;
-  assert(wait_list != NULL);
+// Acks may be processed by any sequencer thread
+void Sequencer::process_ack(Message * msg, uint64_t thd_id, uint64_t seq_id) {
+  qlite_epoch * en = get_epoch(msg->get_batch_id());
+  assert(en->busy && en->epoch == msg->get_batch_id());
   assert(en->txns_left > 0);
 
+  // the high digit of the id is the sequencer thread that took the txn
   uint64_t id = msg->get_txn_id() / g_node_cnt;
+  uint64_t k = id / en->max_size;
+  assert(k < g_seq_thread_cnt);
+  qlite * wait_list = en->lists[k];
+  id = id % en->max_size;
+  assert(id < en->sizes[k]);
   uint64_t prof_stat = get_sys_clock();
   assert(wait_list[id].server_ack_cnt > 0);
 
@@ -63,7 +85,6 @@ void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
   }
 
   if (query_acks_left == 0) {
-      en->txns_left--;
       ATOM_FETCH_ADD(total_txns_finished,1);
       INC_STATS(thd_id,seq_txn_cnt,1);
       // free msg, queries
@@ -110,7 +131,7 @@ void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
           cl_msg->return_node_id = wait_list[id].client_id;
           wait_list[id].total_batch_time += en->batch_send_time - wait_list[id].seq_startts;
           // restart
-          process_txn(cl_msg, thd_id, wait_list[id].seq_first_startts, wait_list[id].seq_startts, wait_list[id].total_batch_time, abort_cnt);
+          process_txn(cl_msg, thd_id, seq_id, wait_list[id].seq_first_startts, wait_list[id].seq_startts, wait_list[id].total_batch_time, abort_cnt);
       }
       else {
 #endif
@@ -169,69 +190,50 @@ void Sequencer::process_ack(Message * msg, uint64_t thd_id) {
 
   }
 
-  // If we have all acks for this batch, send qry responses to all clients
-  if (en->txns_left == 0) {
+  // If we have all acks for this batch, its slot can take a new epoch
+  if (query_acks_left == 0 && ATOM_SUB_FETCH(en->txns_left,1) == 0) {
       DEBUG("FINISHED BATCH %ld\n",en->epoch);
-      LIST_REMOVE_HT(en,wl_head,wl_tail);
-      mem_allocator.free(en->list,sizeof(qlite) * en->max_size);
-      mem_allocator.free(en,sizeof(qlite_ll));
-
+      release_epoch(en);
   }
   INC_STATS(thd_id,seq_ack_time,get_sys_clock() - prof_stat);
 }
 
-// Assumes 1 thread does sequencer work
-void Sequencer::process_txn( Message * msg,uint64_t thd_id, uint64_t early_start, uint64_t last_start, uint64_t wait_time, uint32_t abort_cnt) {
+// Each sequencer thread fills its own sub-batch of the epoch
+void Sequencer::process_txn( Message * msg,uint64_t thd_id, uint64_t seq_id, uint64_t early_start, uint64_t last_start, uint64_t wait_time, uint32_t abort_cnt) {
 
     uint64_t starttime = get_sys_clock();
     DEBUG("SEQ Processing msg\n");
-    qlite_ll * en = wl_tail;
-
-    // LL is potentially a bottleneck here
-    if(!en || en->epoch != simulation->get_seq_epoch()+1) {
-      DEBUG("SEQ new wait list for epoch %ld\n",simulation->get_seq_epoch()+1);
-      // First txn of new wait list
-      en = (qlite_ll *) mem_allocator.alloc(sizeof(qlite_ll));
-      en->epoch = simulation->get_seq_epoch()+1;
-      en->max_size = 1000;
-      en->size = 0;
-      en->txns_left = 0;
-      en->list = (qlite *) mem_allocator.alloc(sizeof(qlite) * en->max_size);
-      LIST_PUT_TAIL(wl_head,wl_tail,en)
-    }
-    if(en->size == en->max_size) {
-      en->max_size *= 2;
-      en->list = (qlite *) mem_allocator.realloc(en->list,sizeof(qlite) * en->max_size);
-    }
-
-    txnid_t txn_id = g_node_id + g_node_cnt * next_txn_id;
-    next_txn_id++;
-    uint64_t id = txn_id / g_node_cnt;
+    qlite_epoch * en = get_epoch(fill_epoch[seq_id]);
+    assert(en->busy && en->epoch == fill_epoch[seq_id]);
+    uint64_t id = en->sizes[seq_id];
+    assert(id < en->max_size);
+    qlite * entry = &en->lists[seq_id][id];
+
+    // ids follow the order send_next_batch merges the sub-batches in
+    txnid_t txn_id = g_node_id + g_node_cnt * (seq_id * en->max_size + id);
     msg->batch_id = en->epoch;
     msg->txn_id = txn_id;
     assert(txn_id != UINT64_MAX);
 
 #if WORKLOAD == YCSB
-    std::set<uint64_t> participants = YCSBQuery::participants(msg,_wl);
+    uint64_t participants = YCSBQuery::participants(msg,_wl);
 #elif WORKLOAD == TPCC
-    std::set<uint64_t> participants = TPCCQuery::participants(msg,_wl);
+    uint64_t participants = TPCCQuery::participants(msg,_wl);
 #elif WORKLOAD == PPS
-    std::set<uint64_t> participants = PPSQuery::participants(msg,_wl);
+    uint64_t participants = PPSQuery::participants(msg,_wl);
 #endif
-    uint32_t server_ack_cnt = participants.size();
+    uint32_t server_ack_cnt = __builtin_popcountl(participants);
     assert(server_ack_cnt > 0);
     assert(ISCLIENTN(msg->get_return_id()));
-    en->list[id].client_id = msg->get_return_id();
-    en->list[id].client_startts = ((ClientQueryMessage*)msg)->client_startts;
-    //en->list[id].seq_startts = get_sys_clock();
-
-    en->list[id].total_batch_time = wait_time;
-    en->list[id].abort_cnt = abort_cnt;
-    en->list[id].skew_startts = 0;
-    en->list[id].server_ack_cnt = server_ack_cnt;
-    en->list[id].msg = msg;
-    en->size++;
-    en->txns_left++;
+    entry->client_id = msg->get_return_id();
+    entry->client_startts = ((ClientQueryMessage*)msg)->client_startts;
+
+    entry->total_batch_time = wait_time;
+    entry->abort_cnt = abort_cnt;
+    entry->skew_startts = 0;
+    entry->server_ack_cnt = server_ack_cnt;
+    entry->participants = participants;
+    entry->msg = msg;
     // Note: Modifying msg!
     msg->return_node_id = g_node_id;
     msg->lat_network_time = 0;
@@ -243,34 +245,29 @@ void Sequencer::process_txn( Message * msg,uint64_t thd_id, uint64_t early_start
             cl_msg->txn_type == PPS_ORDERPRODUCT) {
         if (cl_msg->part_keys.size() == 0) {
             cl_msg->recon = true;
-            en->list[id].seq_startts = get_sys_clock();
+            entry->seq_startts = get_sys_clock();
         }
         else {
             cl_msg->recon = false;
-            en->list[id].seq_startts = last_time;
+            entry->seq_startts = last_start;
         }
 
     }
     else {
         cl_msg->recon = false;
-        en->list[id].seq_startts = get_sys_clock();
+        entry->seq_startts = get_sys_clock();
     }
 #else
-    en->list[id].seq_startts = get_sys_clock();
+    entry->seq_startts = get_sys_clock();
 #endif
     if (early_start == 0) {
-        en->list[id].seq_first_startts = en->list[id].seq_startts;
+        entry->seq_first_startts = entry->seq_startts;
     } else {
-        en->list[id].seq_first_startts = early_start;
-    }
-    assert(en->size == en->txns_left);
-    assert(en->size <= ((uint64_t)g_inflight_max * g_node_cnt));
-
-    // Add new txn to fill queue
-    for(auto participant = participants.begin(); participant != participants.end(); participant++) {
-      DEBUG("SEQ adding (%ld,%ld) to fill queue (recon: %d)\n",msg->get_txn_id(),msg->get_batch_id(),((PPSClientQueryMessage*)msg)->recon);
-      while(!fill_queue[*participant].push(msg) && !simulation->is_done()) {}
+        entry->seq_first_startts = early_start;
     }
+    DEBUG("SEQ adding (%ld,%ld) to sub-batch %ld\n",msg->get_txn_id(),msg->get_batch_id(),seq_id);
+    ATOM_ADD(en->txns_left,1);
+    en->sizes[seq_id]++;
 
 	INC_STATS(thd_id,seq_process_cnt,1);
 	INC_STATS(thd_id,seq_process_time,get_sys_clock() - starttime);
@@ -279,32 +276,70 @@ void Sequencer::process_txn( Message * msg,uint64_t thd_id, uint64_t early_start
 }
 
 
-// Assumes 1 thread does sequencer work
-void Sequencer::send_next_batch(uint64_t thd_id) {
+bool Sequencer::next_epoch() {
+  // txns that arrive from now on go to the epoch after the one cut
+  uint64_t epoch = simulation->get_seq_epoch() + 2;
+  qlite_epoch * en = get_epoch(epoch);
+  if(en->busy) {
+    // the batch grows until an old epoch finishes
+    return false;
+  }
+  for(uint64_t j = 0; j < g_seq_thread_cnt; j++)
+    en->sizes[j] = 0;
+  en->txns_left = 1;
+  en->sealed_cnt = 0;
+  en->epoch = epoch;
+  en->busy = true;
+  simulation->advance_seq_epoch();
+  return true;
+}
+
+void Sequencer::seal_epochs(uint64_t thd_id, uint64_t seq_id) {
+  while(fill_epoch[seq_id] <= simulation->get_seq_epoch()) {
+    qlite_epoch * en = get_epoch(fill_epoch[seq_id]);
+    fill_epoch[seq_id]++;
+    if(ATOM_ADD_FETCH(en->sealed_cnt,1) == g_seq_thread_cnt)
+      send_next_batch(thd_id,en);
+  }
+}
+
+void Sequencer::release_epoch(qlite_epoch * en) {
+  ATOM_CAS(en->busy,true,false);
+}
+
+// Sends the sub-batches in thread order, so every node sees one order
+void Sequencer::send_next_batch(uint64_t thd_id, qlite_epoch * en) {
   uint64_t prof_stat = get_sys_clock();
-  qlite_ll * en = wl_tail;
   bool empty = true;
-  if(en && en->epoch == simulation->get_seq_epoch()) {
-    DEBUG("SEND NEXT BATCH %ld [%ld,%ld] %ld\n",thd_id,simulation->get_seq_epoch(),en->epoch,en->size);
-    empty = false;
-
-    en->batch_send_time = prof_stat;
+  for(uint64_t k = 0; k < g_seq_thread_cnt; k++) {
+    if(en->sizes[k] > 0)
+      empty = false;
   }
+  if(!empty) {
+    DEBUG("SEND NEXT BATCH %ld [%ld,%ld]\n",thd_id,simulation->get_seq_epoch(),en->epoch);
+  }
+  en->batch_send_time = prof_stat;
 
   Message * msg;
   for(uint64_t j = 0; j < g_node_cnt; j++) {
-    while(fill_queue[j].pop(msg)) {
-      if(j == g_node_id) {
+    for(uint64_t k = 0; k < g_seq_thread_cnt; k++) {
+      qlite * list = en->lists[k];
+      for(uint64_t i = 0; i < en->sizes[k]; i++) {
+        if(!(list[i].participants & (1UL << j)))
+          continue;
+        msg = list[i].msg;
+        if(j == g_node_id) {
           work_queue.sched_enqueue(thd_id,msg);
-      } else {
-        msg_queue.enqueue(thd_id,msg,j);
+        } else {
+          msg_queue.enqueue(thd_id,msg,j);
+        }
       }
     }
     if(!empty) {
-      DEBUG("Seq RDONE %ld\n",simulation->get_seq_epoch())
+      DEBUG("Seq RDONE %ld\n",en->epoch)
     }
     msg = Message::create_message(RDONE);
-    msg->batch_id = simulation->get_seq_epoch(); 
+    msg->batch_id = en->epoch;
     if(j == g_node_id) {
       work_queue.sched_enqueue(thd_id,msg);
     } else {
@@ -322,6 +357,6 @@ void Sequencer::send_next_batch(uint64_t thd_id) {
     INC_STATS(thd_id,seq_full_batch_cnt,1);
   }
   INC_STATS(thd_id,seq_prep_time,get_sys_clock() - prof_stat);
-  next_txn_id = 0;
+  if(ATOM_SUB_FETCH(en->txns_left,1) == 0)
+    release_epoch(en);
 }
-
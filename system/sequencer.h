@@ -35,32 +35,45 @@ typedef struct qlite_entry {
 	uint64_t total_batch_time;
 	uint32_t server_ack_cnt;
 	uint32_t abort_cnt;
+	// bit n is set if node n takes part in the txn
+	uint64_t participants;
   Message * msg;
 } qlite;
 
-typedef struct qlite_ll_entry {
-  qlite * list;
-	uint64_t size;
+// The txns of one epoch. Each sequencer thread fills its own sub-batch, and
+// the batch is the sub-batches in thread order.
+typedef struct qlite_epoch_entry {
+  qlite ** lists;
+	uint64_t * sizes;
 	uint32_t max_size;
-	uint32_t txns_left;
-	uint64_t epoch;
+	// txns waiting for acks, plus one until the batch is sent
+	volatile uint64_t txns_left;
+	// sequencer threads done filling the epoch
+	volatile uint32_t sealed_cnt;
+	volatile uint64_t epoch;
+	volatile bool busy;
 	uint64_t batch_send_time;
-  qlite_ll_entry * next;
-  qlite_ll_entry * prev;
-} qlite_ll;
+} qlite_epoch;
 
 
 class Sequencer {
  public:
 	void init(Workload * wl);	
-	void process_ack(Message * msg, uint64_t thd_id);
-	void process_txn(Message * msg,uint64_t thd_id, uint64_t early_start, uint64_t last_start, uint64_t wait_time, uint32_t abort_cnt);
-	void send_next_batch(uint64_t thd_id);
+	void process_ack(Message * msg, uint64_t thd_id, uint64_t seq_id);
+	void process_txn(Message * msg,uint64_t thd_id, uint64_t seq_id, uint64_t early_start, uint64_t last_start, uint64_t wait_time, uint32_t abort_cnt);
+	// [seq_id 0] cuts the epoch being filled. Returns false, and cuts
+	// nothing, while the next epoch has no free slot.
+	bool next_epoch();
+	// closes this thread's sub-batches of the epochs cut since its last
+	// call; the last thread to close an epoch sends it
+	void seal_epochs(uint64_t thd_id, uint64_t seq_id);
 
  private:
 	void reset_participating_nodes(bool * part_nodes);
+	void send_next_batch(uint64_t thd_id, qlite_epoch * en);
+	void release_epoch(qlite_epoch * en);
+	qlite_epoch * get_epoch(uint64_t epoch) {return &epochs[epoch % SEQ_EPOCH_WINDOW];}
 
-  boost::lockfree::queue<Message*, boost::lockfree::capacity<65526> > * fill_queue;
 #if WORKLOAD == YCSB
 	YCSBQuery* node_queries;
 #elif WORKLOAD == TPCC
@@ -72,9 +85,10 @@ class Sequencer {
 	volatile uint64_t total_txns_received;
 	volatile uint32_t rsp_cnt;
   uint64_t last_time_batch;
-	qlite_ll * wl_head;		// list of txns in batch being executed
-	qlite_ll * wl_tail;		// list of txns in batch being executed
-	volatile uint32_t next_txn_id;
+	// epochs whose batch is being filled or executed
+	qlite_epoch * epochs;
+	// epoch each sequencer thread is filling
+	uint64_t * fill_epoch;
 	Workload * _wl;
 };
 
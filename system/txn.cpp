@@ -27,6 +27,7 @@
 #include "catalog.h"
 #include "index_btree.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "msg_queue.h"
 #include "pool.h"
 #include "message.h"
@@ -35,6 +36,10 @@
 #include "pps_query.h"
 #include "array.h"
 #include "maat.h"
+#include "silo.h"
+#include "row_silo.h"
+#include "tictoc.h"
+#include "row_tictoc.h"
 
 
 void TxnStats::init() {
@@ -270,6 +275,8 @@ void Transaction::init() {
   batch_id = UINT64_MAX;
   DEBUG_M("Transaction::init array insert_rows\n");
   insert_rows.init(g_max_items_per_txn + 10); 
+  DEBUG_M("Transaction::init array index_inserts\n");
+  index_inserts.init(2 * (g_max_items_per_txn + 10));
   DEBUG_M("Transaction::reset array accesses\n");
   accesses.init(MAX_ROW_PER_TXN);  
 
@@ -277,22 +284,17 @@ void Transaction::init() {
 }
 
 void Transaction::reset(uint64_t thd_id) {
-  release_accesses(thd_id);
+  // the accesses live in the TxnManager's arena
   accesses.clear();
   //release_inserts(thd_id);
   insert_rows.clear();  
+  index_inserts.clear();
   write_cnt = 0;
   row_cnt = 0;
   twopc_state = START;
   rc = RCOK;
 }
 
-void Transaction::release_accesses(uint64_t thd_id) {
-  for(uint64_t i = 0; i < accesses.size(); i++) {
-    access_pool.put(thd_id,accesses[i]);
-  }
-}
-
 void Transaction::release_inserts(uint64_t thd_id) {
   for(uint64_t i = 0; i < insert_rows.size(); i++) {
     row_t * row = insert_rows[i];
@@ -308,12 +310,12 @@ void Transaction::release_inserts(uint64_t thd_id) {
 
 void Transaction::release(uint64_t thd_id) {
   DEBUG("Transaction release\n");
-  release_accesses(thd_id);
   DEBUG_M("Transaction::release array accesses free\n")
   accesses.release();
   release_inserts(thd_id);
   DEBUG_M("Transaction::release array insert_rows free\n")
   insert_rows.release();
+  index_inserts.release();
 }
 
 void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
@@ -335,6 +337,8 @@ void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
   //reset();
   sem_init(&rsp_mutex, 0, 1);
   return_id = UINT64_MAX;
+  last_index = NULL;
+  recovering = false;
 
 	this->h_wl = h_wl;
 #if CC_ALG == MAAT
@@ -346,10 +350,14 @@ void TxnManager::init(uint64_t thd_id, Workload * h_wl) {
   phase = CALVIN_RW_ANALYSIS;
   locking_done = false;
   calvin_locked_rows.init(MAX_ROW_PER_TXN);
+  calvin_slice_locks = new Array<CalvinLockReq> [g_calvin_lock_thread_cnt];
+  for (uint64_t i = 1; i < g_calvin_lock_thread_cnt; i++)
+    calvin_slice_locks[i].init(MAX_ROW_PER_TXN);
 #endif
   
   txn_ready = true;
   twopl_wait_start = 0;
+  dl_victim = false;
 
   txn_stats.init();
 }
@@ -364,6 +372,7 @@ void TxnManager::reset() {
   aborted = false;
   return_id = UINT64_MAX;
   twopl_wait_start = 0;
+  dl_victim = false;
 
   //ready = true;
 
@@ -381,11 +390,14 @@ void TxnManager::reset() {
   phase = CALVIN_RW_ANALYSIS;
   locking_done = false;
   calvin_locked_rows.clear();
+  for (uint64_t i = 1; i < g_calvin_lock_thread_cnt; i++)
+    calvin_slice_locks[i].clear();
 #endif
 
   assert(txn);
   assert(query);
   txn->reset(get_thd_id());
+  arena.reset();
 
   // Stats
   txn_stats.reset();
@@ -402,6 +414,7 @@ TxnManager::release() {
   txn_pool.put(get_thd_id(),txn);
   INC_STATS(get_thd_id(),mtx[1],get_sys_clock()-prof_starttime);
   txn = NULL;
+  arena.reset();
 
 #if CC_ALG == MAAT
   delete uncommitted_writes;
@@ -410,6 +423,9 @@ TxnManager::release() {
 #endif
 #if CC_ALG == CALVIN
   calvin_locked_rows.release();
+  for (uint64_t i = 1; i < g_calvin_lock_thread_cnt; i++)
+    calvin_slice_locks[i].release();
+  delete [] calvin_slice_locks;
 #endif
   txn_ready = true;
 }
@@ -426,7 +442,24 @@ void TxnManager::reset_query() {
 
 RC TxnManager::commit() {
   DEBUG("Commit %ld\n",get_txn_id());
+#if LOGGING && LOG_COMMAND
+  // the home node has the whole query; logging it before the locks go
+  // keeps the log in commit order
+  if(IS_LOCAL(get_txn_id())) {
+    LogRecord * record = logger.createRecord(this);
+    if(g_repl_cnt > 0) {
+      msg_queue.enqueue(get_thd_id(),Message::create_message(record,LOG_MSG),g_node_id + g_node_cnt + g_client_node_cnt); 
+    }
+    logger.enqueueRecord(get_thd_id(),record);
+  }
+#elif LOGGING
+  logger.begin_apply(get_thd_id());
+  log_writes();
+#endif
   release_locks(RCOK);
+#if LOGGING && !LOG_COMMAND
+  logger.end_apply(get_thd_id());
+#endif
 #if CC_ALG == MAAT
   time_table.release(get_thd_id(),get_txn_id());
 #endif
@@ -436,12 +469,56 @@ RC TxnManager::commit() {
     if(g_repl_cnt > 0) {
       msg_queue.enqueue(get_thd_id(),Message::create_message(record,LOG_MSG),g_node_id + g_node_cnt + g_client_node_cnt); 
     }
-  logger.enqueueRecord(record);
+  logger.enqueueRecord(get_thd_id(),record);
   return WAIT;
 #endif
   return Commit;
 }
 
+#if LOGGING && !LOG_COMMAND
+static void log_write(uint64_t thd_id, LogRecord * record) {
+  if(g_repl_cnt > 0) {
+    msg_queue.enqueue(thd_id,Message::create_message(record,LOG_MSG),g_node_id + g_node_cnt + g_client_node_cnt); 
+  }
+  logger.enqueueRecord(thd_id,record);
+}
+
+void TxnManager::log_writes() {
+  // the writes are not yet released, so each row's records are logged in
+  // the order its writers commit
+  for(uint64_t i = 0; i < txn->accesses.size(); i++) {
+    Access * access = txn->accesses[i];
+    if(access->type != WR)
+      continue;
+    // the before-image is the shared row if the txn wrote a private copy,
+    // else the rollback copy, if any
+    row_t * before = access->data != access->orig_row ? access->orig_row : access->orig_data;
+    uint32_t index_id = access->index ? access->index->index_id : UINT32_MAX;
+    LogRecord * record = logger.createRecord(get_txn_id(),access->data,before,index_id,
+        access->index_key,access->index_cnt,access->index_part_id);
+    log_write(get_thd_id(),record);
+  }
+  // inserted rows go by the index entries they get at commit; a row is
+  // replayed in the partition of its index
+  for(uint64_t i = 0; i < txn->insert_rows.size(); i++) {
+    row_t * row = txn->insert_rows[i];
+    bool image = true;
+    for(uint64_t j = 0; j < txn->index_inserts.size(); j++) {
+      IndexInsert ins = txn->index_inserts[j];
+      if(ins.row != row)
+        continue;
+      log_write(get_thd_id(),logger.createInsertRecord(get_txn_id(),row,image,
+            ins.index->index_id,ins.key,i,ins.part_id));
+      image = false;
+    }
+    if(image) {
+      log_write(get_thd_id(),logger.createInsertRecord(get_txn_id(),row,true,
+            UINT32_MAX,0,i,row->get_part_id()));
+    }
+  }
+}
+#endif
+
 RC TxnManager::abort() {
   if(aborted)
     return Abort;
@@ -499,7 +576,7 @@ RC TxnManager::start_commit() {
   RC rc = RCOK;
   DEBUG("%ld start_commit RO?%d\n",get_txn_id(),query->readonly());
   if(is_multi_part()) {
-    if(!query->readonly() || CC_ALG == OCC || CC_ALG == MAAT) {
+    if(!query->readonly() || CC_ALG == OCC || CC_ALG == MAAT || CC_ALG == SILO || CC_ALG == TICTOC) {
       // send prepare messages
       send_prepare_messages();
       rc = WAIT_REM;
@@ -727,12 +804,8 @@ void TxnManager::cleanup_row(RC rc, uint64_t rid) {
     }
 #endif
 
-#if ROLL_BACK && (CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC)
+#if ROLL_BACK && (CC_ALG == DL_DETECT || CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC)
     if (type == WR) {
-        //printf("free 10 %ld\n",get_txn_id());
-              txn->accesses[rid]->orig_data->free_row();
-        DEBUG_M("TxnManager::cleanup row_t free\n");
-        row_pool.put(get_thd_id(),txn->accesses[rid]->orig_data);
         if(rc == RCOK) {
             INC_STATS(get_thd_id(),record_write_cnt,1);
             ++txn_stats.write_cnt;
@@ -745,9 +818,21 @@ void TxnManager::cleanup_row(RC rc, uint64_t rid) {
 }
 
 void TxnManager::cleanup(RC rc) {
+    // the index entries go in while the txn still holds its rows, so a
+    // reader that sees its writes can also find what it inserted
+    if (rc != Abort) {
+        publish_index_inserts();
+        publish_commit();
+    }
 #if CC_ALG == OCC && MODE == NORMAL_MODE
     occ_man.finish(rc,this);
 #endif
+#if CC_ALG == SILO && MODE == NORMAL_MODE
+    silo_man.finish(rc,this);
+#endif
+#if CC_ALG == TICTOC && MODE == NORMAL_MODE
+    tictoc_man.finish(rc,this);
+#endif
 
     ts_t starttime = get_sys_clock();
     uint64_t row_cnt = txn->accesses.get_count();
@@ -770,6 +855,7 @@ void TxnManager::cleanup(RC rc) {
 	if (rc == Abort) {
 	    txn->release_inserts(get_thd_id());
 	    txn->insert_rows.clear();
+	    txn->index_inserts.clear();
 
         INC_STATS(get_thd_id(), abort_time, get_sys_clock() - starttime);
 	} 
@@ -780,6 +866,16 @@ RC TxnManager::get_lock(row_t * row, access_t type) {
         return RCOK;
     }
     calvin_locked_rows.add(row);
+    // rows of other slices are locked by their own lock thread; slices go by
+    // row address since keys repeat across tables and many rows have none
+    uint64_t slice = ((uint64_t) row >> 6) % g_calvin_lock_thread_cnt;
+    if (slice != 0) {
+      CalvinLockReq req;
+      req.row = row;
+      req.type = type;
+      calvin_slice_locks[slice].add(req);
+      return RCOK;
+    }
     RC rc = row->get_lock(type, this);
     if(rc == WAIT) {
       INC_STATS(get_thd_id(), txn_wait_cnt, 1);
@@ -791,21 +887,17 @@ RC TxnManager::get_row(row_t * row, access_t type, row_t *& row_rtn) {
     uint64_t starttime = get_sys_clock();
     uint64_t timespan;
     RC rc = RCOK;
-    DEBUG_M("TxnManager::get_row access alloc\n");
-    Access * access;
-    access_pool.get(get_thd_id(),access);
     //uint64_t row_cnt = txn->row_cnt;
     //assert(txn->accesses.get_count() - 1 == row_cnt);
 
     this->last_row = row;
     this->last_type = type;
 
-    rc = row->get_row(type, this, access->data);
+    row_t * data;
+    rc = row->get_row(type, this, data);
 
     if (rc == Abort || rc == WAIT) {
         row_rtn = NULL;
-        DEBUG_M("TxnManager::get_row(abort) access free\n");
-        access_pool.put(get_thd_id(),access);
         timespan = get_sys_clock() - starttime;
         INC_STATS(get_thd_id(), txn_manager_time, timespan);
         INC_STATS(get_thd_id(), txn_conflict_cnt, 1);
@@ -815,28 +907,35 @@ RC TxnManager::get_row(row_t * row, access_t type, row_t *& row_rtn) {
 #endif
         return rc;
     }
+    Access * access = (Access *) arena.alloc(sizeof(Access));
+	access->data = data;
 	access->type = type;
 	access->orig_row = row;
+	access->orig_data = NULL;
+	access->index = last_index;
+	access->index_key = last_index_key;
+	access->index_cnt = last_index_cnt;
+	access->index_part_id = last_index_part_id;
+#if CC_ALG == SILO
+	access->tid = cur_tid;
+#endif
+#if CC_ALG == TICTOC
+	access->wts = cur_wts;
+	access->rts = cur_rts;
+	// the commit timestamp must lie within the validity of what was read
+	// and after the last read of what will be written
+	if (type == WR)
+		commit_timestamp = max(commit_timestamp, cur_rts + 1);
+	else
+		commit_timestamp = max(commit_timestamp, cur_wts);
+#endif
 #if ROLL_BACK && (CC_ALG == DL_DETECT || CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE || CC_ALG == HSTORE || CC_ALG == HSTORE_SPEC)
 	if (type == WR) {
     //printf("alloc 10 %ld\n",get_txn_id());
-    uint64_t part_id = row->get_part_id();
-    DEBUG_M("TxnManager::get_row row_t alloc\n")
-    row_pool.get(get_thd_id(),access->orig_data);
-    access->orig_data->init(row->get_table(), part_id, 0);
+    access->orig_data = alloc_row(row);
     access->orig_data->copy(row);
     assert(access->orig_data->get_schema() == row->get_schema());
 
-    // ARIES-style physiological logging
-#if LOGGING
-    //LogRecord * record = logger.createRecord(LRT_UPDATE,L_UPDATE,get_txn_id(),part_id,row->get_table()->get_table_id(),row->get_primary_key());
-    LogRecord * record = logger.createRecord(get_txn_id(),L_UPDATE,row->get_table()->get_table_id(),row->get_primary_key());
-    if(g_repl_cnt > 0) {
-      msg_queue.enqueue(get_thd_id(),Message::create_message(record,LOG_MSG),g_node_id + g_node_cnt + g_client_node_cnt); 
-    }
-    logger.enqueueRecord(record);
-#endif
-
 	}
 #endif
 
@@ -856,6 +955,12 @@ RC TxnManager::get_row(row_t * row, access_t type, row_t *& row_rtn) {
   return rc;
 }
 
+row_t * TxnManager::alloc_row(row_t * row) {
+  row_t * copy = (row_t *) arena.alloc(sizeof(row_t));
+  copy->init(row->get_table(), row->get_part_id(), 0, (char *) arena.alloc(row->get_tuple_size()));
+  return copy;
+}
+
 RC TxnManager::get_row_post_wait(row_t *& row_rtn) {
   assert(CC_ALG != HSTORE && CC_ALG != HSTORE_SPEC);
 
@@ -863,21 +968,20 @@ RC TxnManager::get_row_post_wait(row_t *& row_rtn) {
   row_t * row = this->last_row;
   access_t type = this->last_type;
   assert(row != NULL);
-  DEBUG_M("TxnManager::get_row_post_wait access alloc\n")
-  Access * access;
-  access_pool.get(get_thd_id(),access);
+  Access * access = (Access *) arena.alloc(sizeof(Access));
 
   row->get_row_post_wait(type,this,access->data);
 
 	access->type = type;
 	access->orig_row = row;
+	access->orig_data = NULL;
+	access->index = last_index;
+	access->index_key = last_index_key;
+	access->index_cnt = last_index_cnt;
+	access->index_part_id = last_index_part_id;
 #if ROLL_BACK && (CC_ALG == DL_DETECT || CC_ALG == NO_WAIT || CC_ALG == WAIT_DIE)
 	if (type == WR) {
-	  uint64_t part_id = row->get_part_id();
-    //printf("alloc 10 %ld\n",get_txn_id());
-    DEBUG_M("TxnManager::get_row_post_wait row_t alloc\n")
-    row_pool.get(get_thd_id(),access->orig_data);
-		access->orig_data->init(row->get_table(), part_id, 0);
+		access->orig_data = alloc_row(row);
 		access->orig_data->copy(row);
 	}
 #endif
@@ -903,12 +1007,49 @@ void TxnManager::insert_row(row_t * row, table_t * table) {
   txn->insert_rows.add(row);
 }
 
+void TxnManager::index_insert(INDEX * index, idx_key_t key, row_t * row, uint64_t part_id) {
+	IndexInsert ins;
+	ins.index = index;
+	ins.key = key;
+	ins.row = row;
+	ins.part_id = part_id;
+	txn->index_inserts.add(ins);
+}
+
+void TxnManager::publish_index_inserts() {
+	uint64_t cnt = txn->index_inserts.size();
+	if (cnt == 0)
+		return;
+	uint64_t starttime = get_sys_clock();
+	// the items of the whole txn come from one allocation
+	itemid_t * items = (itemid_t *) mem_allocator.alloc(sizeof(itemid_t) * cnt, txn->index_inserts[0].part_id);
+	// Published newest first: an insert made later (an order line) is
+	// visible before the one that leads readers to it (its order).
+	for (int64_t i = cnt - 1; i >= 0; i--) {
+		IndexInsert ins = txn->index_inserts[i];
+		items[i].init();
+		items[i].type = DT_row;
+		items[i].location = ins.row;
+		items[i].valid = true;
+		RC rc __attribute__ ((unused));
+		rc = ins.index->index_insert(ins.key, &items[i], ins.part_id);
+		assert(rc == RCOK);
+	}
+	txn->index_inserts.clear();
+	INC_STATS(get_thd_id(), txn_index_insert_cnt, cnt);
+	INC_STATS(get_thd_id(), txn_index_insert_time, get_sys_clock() - starttime);
+}
+
 itemid_t *
 TxnManager::index_read(INDEX * index, idx_key_t key, int part_id) {
 	uint64_t starttime = get_sys_clock();
 
 	itemid_t * item;
 	index->index_read(key, item, part_id, get_thd_id());
+	last_index = index;
+	last_index_key = key;
+	last_index_cnt = -1;
+	last_index_part_id = part_id;
 
   uint64_t t = get_sys_clock() - starttime;
   INC_STATS(get_thd_id(), txn_index_time, t);
@@ -923,6 +1064,10 @@ TxnManager::index_read(INDEX * index, idx_key_t key, int part_id, int count) {
 
 	itemid_t * item;
 	index->index_read(key, count, item, part_id);
+	last_index = index;
+	last_index_key = key;
+	last_index_cnt = count;
+	last_index_part_id = part_id;
 
   uint64_t t = get_sys_clock() - starttime;
   INC_STATS(get_thd_id(), txn_index_time, t);
@@ -936,13 +1081,17 @@ RC TxnManager::validate() {
 #if MODE != NORMAL_MODE
   return RCOK;
 #endif
-  if (CC_ALG != OCC && CC_ALG != MAAT) {
+  if (CC_ALG != OCC && CC_ALG != MAAT && CC_ALG != SILO && CC_ALG != TICTOC) {
       return RCOK;
   }
   RC rc = RCOK;
   uint64_t starttime = get_sys_clock();
   if(CC_ALG == OCC && rc == RCOK)
     rc = occ_man.validate(this);
+  if(CC_ALG == SILO && rc == RCOK)
+    rc = silo_man.validate(this);
+  if(CC_ALG == TICTOC && rc == RCOK)
+    rc = tictoc_man.validate(this);
   if(CC_ALG == MAAT && rc == RCOK) {
     rc = maat_man.validate(this);
     // Note: home node must be last to validate
@@ -954,12 +1103,56 @@ RC TxnManager::validate() {
   return rc;
 }
 
+void TxnManager::mark_write_set() {
+  uint64_t cnt = get_access_cnt();
+  // (row, access id): sorted, each row's accesses are adjacent and in order
+  std::pair<row_t *, uint64_t> * order = (std::pair<row_t *, uint64_t> *)
+    arena.alloc(sizeof(std::pair<row_t *, uint64_t>) * cnt);
+  for (uint64_t i = 0; i < cnt; i++) {
+    Access * access = txn->accesses[i];
+    order[i] = std::make_pair(access->orig_row, i);
+    access->row_written = false;
+    access->first_write = false;
+    access->last_write = false;
+  }
+  std::sort(order, order + cnt);
+  for (uint64_t begin = 0, end; begin < cnt; begin = end) {
+    Access * first = NULL;
+    Access * last = NULL;
+    for (end = begin; end < cnt && order[end].first == order[begin].first; end++) {
+      Access * access = txn->accesses[order[end].second];
+      if (access->type != WR)
+        continue;
+      if (first == NULL)
+        first = access;
+      last = access;
+    }
+    if (first == NULL)
+      continue;
+    first->first_write = true;
+    last->last_write = true;
+    for (uint64_t i = begin; i < end; i++)
+      txn->accesses[order[i].second]->row_written = true;
+  }
+}
+
+void TxnManager::unlock_write_set(uint64_t to) {
+#if CC_ALG == SILO || CC_ALG == TICTOC
+  for (uint64_t i = 0; i < to; i++) {
+    if (txn->accesses[i]->first_write)
+      txn->accesses[i]->orig_row->manager->release();
+  }
+#endif
+}
+
 RC
 TxnManager::send_remote_reads() {
   assert(CC_ALG == CALVIN);
 #if !YCSB_ABORT_MODE && WORKLOAD == YCSB
   return RCOK;
 #endif
+  if(recovering)
+    return RCOK;
   assert(query->active_nodes.size() == g_node_cnt);
   for(uint64_t i = 0; i < query->active_nodes.size(); i++) {
     if(i == g_node_id)
@@ -982,7 +1175,7 @@ bool TxnManager::calvin_exec_phase_done() {
 }
 
 bool TxnManager::calvin_collect_phase_done() {
-  bool ready =  (phase == CALVIN_COLLECT_RD) && (get_rsp_cnt() == calvin_expected_rsp_cnt);
+  bool ready =  (phase == CALVIN_COLLECT_RD) && (recovering || get_rsp_cnt() == calvin_expected_rsp_cnt);
   if(ready) {
     DEBUG("(%ld,%ld) calvin collect phase done!\n",txn->txn_id,txn->batch_id);
   }
@@ -21,6 +21,7 @@
 #include "helper.h"
 #include "semaphore.h"
 #include "array.h"
+#include "arena.h"
 //#include "wl.h"
 
 class Workload;
@@ -42,14 +43,44 @@ public:
 	row_t * 	orig_row;
 	row_t * 	data;
 	row_t * 	orig_data;
+	// how the row was found, so redo records can find it again
+	INDEX * 	index;
+	idx_key_t 	index_key;
+	int 		index_cnt;
+	int 		index_part_id;
+	// [SILO] TID of the row version that was read
+	uint64_t 	tid;
+	// [TICTOC] wts and rts of the row version that was read
+	uint64_t 	wts;
+	uint64_t 	rts;
+	// [SILO, TICTOC] set by TxnManager::mark_write_set: the txn writes this
+	// row, and this access is the first / last of those writes
+	bool 		row_written;
+	bool 		first_write;
+	bool 		last_write;
 	void cleanup();
 };
 
+// index entry of a row the txn inserted; it is published at commit
+class IndexInsert {
+public:
+	INDEX * 	index;
+	idx_key_t 	key;
+	row_t * 	row;
+	uint64_t 	part_id;
+};
+
+// [CALVIN] lock request left to the lock thread of the row's slice
+class CalvinLockReq {
+public:
+	row_t * 	row;
+	access_t 	type;
+};
+
 class Transaction {
 public:
     void init();
     void reset(uint64_t thd_id);
-    void release_accesses(uint64_t thd_id);
     void release_inserts(uint64_t thd_id);
     void release(uint64_t thd_id);
     //vector<Access*> accesses;
@@ -64,6 +95,7 @@ public:
     // Internal state
     TxnState twopc_state;
     Array<row_t*> insert_rows;
+    Array<IndexInsert> index_inserts;
     txnid_t         txn_id;
     uint64_t batch_id;
     RC rc;
@@ -126,7 +158,7 @@ public:
     virtual void reset();
     void clear();
     void reset_query();
-    void release();
+    virtual void release();
     Thread * h_thd;
     Workload * h_wl;
 
@@ -164,9 +196,22 @@ public:
     bool isRecon() { assert(CC_ALG == CALVIN || !recon); return recon;};
     bool recon;
 
+    // backs cur_row copies, Access records and orig_data images; rewound in
+    // reset() and release()
+    Arena arena;
+    // a private row for row's table backed by the arena; data is not copied
+    row_t * alloc_row(row_t * row);
+
     row_t * volatile cur_row;
+    // [SILO] TID of the version copied into cur_row
+    uint64_t cur_tid;
+    // [TICTOC] wts and rts of the version copied into cur_row
+    uint64_t cur_wts;
+    uint64_t cur_rts;
     // [DL_DETECT, NO_WAIT, WAIT_DIE]
     int volatile   lock_ready;
+    // [DL_DETECT] the detector dropped the lock request this txn waits on
+    bool volatile   dl_victim;
     // [TIMESTAMP, MVCC]
     bool volatile   ts_ready;
     // [HSTORE, HSTORE_SPEC]
@@ -175,6 +220,11 @@ public:
     bool aborted;
     uint64_t return_id;
     RC        validate();
+    // [SILO, TICTOC] sets the write flags of every access. Sorts the
+    // accesses by row, so large write sets are not scanned per access.
+    void            mark_write_set();
+    // [SILO, TICTOC] releases the write locks of the first `to` accesses
+    void            unlock_write_set(uint64_t to);
     void            cleanup(RC rc);
     void            cleanup_row(RC rc,uint64_t rid);
     void release_last_row_lock();
@@ -192,7 +242,7 @@ public:
     uint64_t get_batch_id() {return txn->batch_id;}
     void set_batch_id(uint64_t batch_id) {txn->batch_id = batch_id;}
 
-    // For MaaT
+    // For MaaT and TicToc
     uint64_t commit_timestamp;
     uint64_t get_commit_timestamp() {return commit_timestamp;}
     void set_commit_timestamp(uint64_t timestamp) {commit_timestamp = timestamp;}
@@ -209,6 +259,8 @@ public:
 	////////////////////////////////
 //	void 			gen_log_entry(int &length, void * log);
     bool log_flushed;
+    // re-executing a logged command: serve no remote reads and expect none
+    bool recovering;
     bool repl_finished;
     Transaction * txn;
     BaseQuery * query;
@@ -236,6 +288,9 @@ public:
     bool locking_done;
     CALVIN_PHASE phase;
     Array<row_t*> calvin_locked_rows;
+    // the requests each lock thread makes for this txn; slice 0's are made
+    // as they are found and are not kept
+    Array<CalvinLockReq> * calvin_slice_locks;
     bool calvin_exec_phase_done();
     bool calvin_collect_phase_done();
 
@@ -243,17 +298,31 @@ protected:
 
     int rsp_cnt;
     void            insert_row(row_t * row, table_t * table);
+    // the entry becomes visible when the txn commits and is dropped if it aborts
+    void            index_insert(INDEX * index, idx_key_t key, row_t * row, uint64_t part_id);
+    void            publish_index_inserts();
+    // workload state that may only change once the txn commits
+    virtual void    publish_commit() {}
 
     itemid_t *      index_read(INDEX * index, idx_key_t key, int part_id);
     itemid_t *      index_read(INDEX * index, idx_key_t key, int part_id, int count);
     RC get_lock(row_t * row, access_t type);
     RC get_row(row_t * row, access_t type, row_t *& row_rtn);
     RC get_row_post_wait(row_t *& row_rtn);
+#if LOGGING && !LOG_COMMAND
+    // logs the after-images of the rows this txn wrote
+    void log_writes();
+#endif
 
     // For Waiting
     row_t * last_row;
     row_t * last_row_rtn;
     access_t last_type;
+    // the last index lookup, which found the row get_row accesses next
+    INDEX * last_index;
+    idx_key_t last_index_key;
+    int last_index_cnt;
+    int last_index_part_id;
 
     sem_t rsp_mutex;
 };
@@ -20,6 +20,7 @@
 #include "row.h"
 #include "table.h"
 #include "index_hash.h"
+#include "index_open_hash.h"
 #include "index_btree.h"
 #include "catalog.h"
 #include "mem_alloc.h"
@@ -91,27 +92,39 @@ RC Workload::init_schema(const char * schema_file) {
 	    int part_cnt __attribute__ ((unused));
 			part_cnt = (CENTRAL_INDEX)? 1 : g_part_cnt;
 
-      uint64_t table_size = g_synth_table_size;
+      uint64_t table_size __attribute__ ((unused));
+      table_size = g_synth_table_size;
 #if WORKLOAD == TPCC
-      if ( !tname.compare(1, 9, "WAREHOUSE") ) {
+      // room for the orders NewOrder inserts at runtime
+      uint64_t insert_cnt __attribute__ ((unused));
+      insert_cnt = g_num_wh / g_part_cnt * g_dist_per_wh * TPCC_INSERTS_PER_DIST;
+      if ( !tname.compare(1, string::npos, "WAREHOUSE") ) {
         table_size = g_num_wh / g_part_cnt;
         printf("WAREHOUSE size %ld\n",table_size);
-      } else if ( !tname.compare(1, 8, "DISTRICT") ) {
+      } else if ( !tname.compare(1, string::npos, "DISTRICT") ) {
         table_size = g_num_wh / g_part_cnt * g_dist_per_wh;
         printf("DISTRICT size %ld\n",table_size);
-      } else if ( !tname.compare(1, 8, "CUSTOMER") ) {
+      } else if ( !tname.compare(1, string::npos, "CUSTOMER") ) {
         table_size = g_num_wh / g_part_cnt * g_dist_per_wh * g_cust_per_dist;
         printf("CUSTOMER size %ld\n",table_size);
-      } else if ( !tname.compare(1, 7, "HISTORY") ) {
+      } else if ( !tname.compare(1, string::npos, "HISTORY") ) {
         table_size = g_num_wh / g_part_cnt * g_dist_per_wh * g_cust_per_dist;
         printf("HISTORY size %ld\n",table_size);
-      } else if ( !tname.compare(1, 5, "ORDER") ) {
-        table_size = g_num_wh / g_part_cnt * g_dist_per_wh * g_cust_per_dist;
+      } else if ( !tname.compare(1, string::npos, "ORDER") ) {
+        table_size = g_num_wh / g_part_cnt * g_dist_per_wh * g_cust_per_dist + insert_cnt;
         printf("ORDER size %ld\n",table_size);
-      } else if ( !tname.compare(1, 4, "ITEM") ) {
+      } else if ( !tname.compare(1, string::npos, "NEW-ORDER") ) {
+        table_size = g_num_wh / g_part_cnt * g_dist_per_wh * g_cust_per_dist + insert_cnt;
+        printf("NEW-ORDER size %ld\n",table_size);
+      } else if ( !tname.compare(1, string::npos, "ORDER-LINE") ) {
+        // loaded orders have up to 15 lines
+        table_size = g_num_wh / g_part_cnt * g_dist_per_wh * g_cust_per_dist * 15
+          + insert_cnt * g_max_items_per_txn;
+        printf("ORDER-LINE size %ld\n",table_size);
+      } else if ( !tname.compare(1, string::npos, "ITEM") ) {
         table_size = g_max_items;
         printf("ITEM size %ld\n",table_size);
-      } else if ( !tname.compare(1, 5, "STOCK") ) {
+      } else if ( !tname.compare(1, string::npos, "STOCK") ) {
         table_size = g_num_wh / g_part_cnt * g_max_items;
         printf("STOCK size %ld\n",table_size);
       }
@@ -135,12 +148,15 @@ RC Workload::init_schema(const char * schema_file) {
       table_size = g_synth_table_size / g_part_cnt;
 #endif
 
-#if INDEX_STRUCT == IDX_HASH
+#if INDEX_STRUCT == IDX_HASH || INDEX_STRUCT == IDX_OPEN_HASH
 			index->init(1024, tables[tname], table_size);
 			//index->init(part_cnt*1024, tables[tname], table_size);
 #else
 			index->init(part_cnt, tables[tname]);
 #endif
+			index->index_id = indexes_by_id.size();
+			index->nonunique = false;
+			indexes_by_id.push_back(index);
 			indexes[iname] = index;
 		}
     }
@@ -169,7 +185,7 @@ void Workload::index_insert(INDEX * index, uint64_t key, row_t * row, int64_t pa
 	if (part_id == -1)
 		pid = get_part_id(row);
 	itemid_t * m_item =
-		(itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
+		(itemid_t *) mem_allocator.alloc( sizeof(itemid_t), pid);
 	m_item->init();
 	m_item->type = DT_row;
 	m_item->location = row;
@@ -184,13 +200,14 @@ void Workload::index_insert_nonunique(INDEX * index, uint64_t key, row_t * row,
 	if (part_id == -1)
 		pid = get_part_id(row);
 	itemid_t * m_item =
-		(itemid_t *) mem_allocator.alloc( sizeof(itemid_t));
+		(itemid_t *) mem_allocator.alloc( sizeof(itemid_t), pid);
 	m_item->init();
 	m_item->type = DT_row;
 	m_item->location = row;
 	m_item->valid = true;
 
   assert(index);
+  index->nonunique = true;
   assert( index->index_insert_nonunique(key, m_item, pid) == RCOK );
 }
 
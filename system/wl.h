@@ -22,6 +22,7 @@
 class row_t;
 class table_t;
 class IndexHash;
+class IndexOpenHash;
 class index_btree;
 class Catalog;
 class lock_man;
@@ -38,6 +39,8 @@ public:
 	// tables indexed by table name
   map<string, table_t *> tables;
   map<string, INDEX *> indexes;
+  // indexes by index_base::index_id
+  vector<INDEX *> indexes_by_id;
 
   void index_delete_all(); 
 	
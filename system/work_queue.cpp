@@ -26,12 +26,35 @@ void QWorkQueue::init() {
   last_sched_dq = NULL;
   sched_ptr = 0;
   seq_queue = new boost::lockfree::queue<work_queue_entry* > (0);
-  work_queue = new boost::lockfree::queue<work_queue_entry* > (0);
-  new_txn_queue = new boost::lockfree::queue<work_queue_entry* >(0);
+  work_queue = new boost::lockfree::queue<work_queue_entry* > * [g_thread_cnt];
+  new_txn_queue = new boost::lockfree::queue<work_queue_entry* > * [g_thread_cnt];
+  for ( uint64_t i = 0; i < g_thread_cnt; i++) {
+    work_queue[i] = new boost::lockfree::queue<work_queue_entry* > (0);
+    new_txn_queue[i] = new boost::lockfree::queue<work_queue_entry* > (0);
+  }
+  parkers = (Parker *) mem_allocator.align_alloc(sizeof(Parker) * g_thread_cnt);
+  for ( uint64_t i = 0; i < g_thread_cnt; i++) {
+    parkers[i].init();
+  }
+  sched_parker.init();
+#if PRIORITY_WORK_QUEUE
+  prio_queue = new prio_work_queue * [g_thread_cnt];
+  for ( uint64_t i = 0; i < g_thread_cnt; i++) {
+    prio_queue[i] = new prio_work_queue;
+    prio_queue[i]->latch = false;
+    prio_queue[i]->cnt = 0;
+  }
+#endif
   sched_queue = new boost::lockfree::queue<work_queue_entry* > * [g_node_cnt];
   for ( uint64_t i = 0; i < g_node_cnt; i++) {
     sched_queue[i] = new boost::lockfree::queue<work_queue_entry* > (0);
   }
+  lock_slice_queue = new boost::lockfree::queue<TxnManager* > * [g_calvin_lock_thread_cnt];
+  lock_slice_parkers = (Parker *) mem_allocator.align_alloc(sizeof(Parker) * g_calvin_lock_thread_cnt);
+  for ( uint64_t i = 0; i < g_calvin_lock_thread_cnt; i++) {
+    lock_slice_queue[i] = new boost::lockfree::queue<TxnManager* > (0);
+    lock_slice_parkers[i].init();
+  }
 
 }
 
@@ -96,6 +119,7 @@ void QWorkQueue::sched_enqueue(uint64_t thd_id, Message * msg) {
   DEBUG("Sched Enqueue (%ld,%ld)\n",entry->txn_id,entry->batch_id);
   uint64_t mtx_time_start = get_sys_clock();
   while(!sched_queue[msg->get_return_id()]->push(entry) && !simulation->is_done()) {}
+  sched_parker.wake();
   INC_STATS(thd_id,mtx[37],get_sys_clock() - mtx_time_start);
 
   INC_STATS(thd_id,sched_queue_enqueue_time,get_sys_clock() - starttime);
@@ -150,6 +174,50 @@ Message * QWorkQueue::sched_dequeue(uint64_t thd_id) {
 
 }
 
+void QWorkQueue::lock_slice_enqueue(uint64_t thd_id, uint64_t slice, TxnManager * txn_man) {
+  assert(CC_ALG == CALVIN);
+  assert(slice > 0 && slice < g_calvin_lock_thread_cnt);
+  // a single producer, so the slice sees txns in sequence order
+  while(!lock_slice_queue[slice]->push(txn_man) && !simulation->is_done()) {}
+  lock_slice_parkers[slice].wake();
+}
+
+TxnManager * QWorkQueue::lock_slice_dequeue(uint64_t thd_id, uint64_t slice) {
+  assert(CC_ALG == CALVIN);
+  TxnManager * txn_man = NULL;
+  lock_slice_queue[slice]->pop(txn_man);
+  return txn_man;
+}
+
+void QWorkQueue::prio_push(uint64_t qid, work_queue_entry * entry) {
+  prio_work_queue * pq = prio_queue[qid];
+  while(!ATOM_CAS(pq->latch,false,true)) {}
+  pq->queue.push(entry);
+  pq->cnt++;
+  ATOM_CAS(pq->latch,true,false);
+}
+
+bool QWorkQueue::prio_pop(uint64_t qid, work_queue_entry *& entry, bool steal) {
+  prio_work_queue * pq = prio_queue[qid];
+  if(pq->cnt == 0)
+    return false;
+  if(steal) {
+    // don't wait on a busy peer
+    if(!ATOM_CAS(pq->latch,false,true))
+      return false;
+  } else {
+    while(!ATOM_CAS(pq->latch,false,true)) {}
+  }
+  bool valid = false;
+  if(!pq->queue.empty() && (!steal || pq->queue.top()->rtype == CL_QRY)) {
+    entry = pq->queue.top();
+    pq->queue.pop();
+    pq->cnt--;
+    valid = true;
+  }
+  ATOM_CAS(pq->latch,true,false);
+  return valid;
+}
 
 void QWorkQueue::enqueue(uint64_t thd_id, Message * msg,bool busy) {
   uint64_t starttime = get_sys_clock();
@@ -161,14 +229,42 @@ void QWorkQueue::enqueue(uint64_t thd_id, Message * msg,bool busy) {
   entry->txn_id = msg->txn_id;
   entry->batch_id = msg->batch_id;
   entry->starttime = get_sys_clock();
+  entry->prio_ts = 0;
+  if(msg->rtype == CL_QRY) {
+    entry->prio_ts = UINT64_MAX;
+  }
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+  else if(msg->rtype == RQRY) {
+    // older txns go first so they are not aborted by younger ones
+    entry->prio_ts = ((QueryMessage*)msg)->ts;
+  }
+#endif
   assert(ISSERVER || ISREPLICA);
   DEBUG("Work Enqueue (%ld,%ld) %d\n",entry->txn_id,entry->batch_id,entry->rtype);
 
   uint64_t mtx_wait_starttime = get_sys_clock();
+  uint64_t qid;
   if(msg->rtype == CL_QRY) {
-    while(!new_txn_queue->push(entry) && !simulation->is_done()) {}
+    qid = mtx_wait_starttime % g_thread_cnt;
   } else {
-    while(!work_queue->push(entry) && !simulation->is_done()) {}
+    assert(msg->txn_id != UINT64_MAX);
+    qid = get_owner(msg->txn_id);
+  }
+#if PRIORITY_WORK_QUEUE
+  prio_push(qid,entry);
+#else
+  if(msg->rtype == CL_QRY) {
+    while(!new_txn_queue[qid]->push(entry) && !simulation->is_done()) {}
+  } else {
+    while(!work_queue[qid]->push(entry) && !simulation->is_done()) {}
+  }
+#endif
+  if(IDLE_PARK && msg->rtype == CL_QRY) {
+    // any worker may steal a new txn: if qid's worker is not parked, it may
+    // be busy for a while, so wake the first parked peer instead
+    for(uint64_t i = 0; i < g_thread_cnt && !parkers[(qid + i) % g_thread_cnt].wake(); i++) {}
+  } else {
+    parkers[qid].wake();
   }
   INC_STATS(thd_id,mtx[13],get_sys_clock() - mtx_wait_starttime);
 
@@ -184,8 +280,13 @@ Message * QWorkQueue::dequeue(uint64_t thd_id) {
   assert(ISSERVER || ISREPLICA);
   Message * msg = NULL;
   work_queue_entry * entry = NULL;
+  assert(thd_id < g_thread_cnt);
   uint64_t mtx_wait_starttime = get_sys_clock();
-  bool valid = work_queue->pop(entry);
+#if PRIORITY_WORK_QUEUE
+  bool valid = prio_pop(thd_id,entry,false);
+#else
+  bool valid = work_queue[thd_id]->pop(entry);
+#endif
   if(!valid) {
 #if SERVER_GENERATE_QUERIES
     if(ISSERVER) {
@@ -195,8 +296,21 @@ Message * QWorkQueue::dequeue(uint64_t thd_id) {
         msg = Message::create_message((BaseQuery*)m_query,CL_QRY);
       }
     }
+#elif PRIORITY_WORK_QUEUE
+    for(uint64_t i = 1; !valid && i < g_thread_cnt; i++) {
+      valid = prio_pop((thd_id + i) % g_thread_cnt,entry,true);
+      if(valid) {
+        INC_STATS(thd_id,work_queue_steal_cnt,1);
+      }
+    }
 #else
-    valid = new_txn_queue->pop(entry);
+    valid = new_txn_queue[thd_id]->pop(entry);
+    for(uint64_t i = 1; !valid && i < g_thread_cnt; i++) {
+      valid = new_txn_queue[(thd_id + i) % g_thread_cnt]->pop(entry);
+      if(valid) {
+        INC_STATS(thd_id,work_queue_steal_cnt,1);
+      }
+    }
 #endif
   }
   INC_STATS(thd_id,mtx[14],get_sys_clock() - mtx_wait_starttime);
@@ -20,6 +20,7 @@
 
 #include "global.h"
 #include "helper.h"
+#include "parker.h"
 #include <queue>
 #include <boost/lockfree/queue.hpp>
 //#include "message.h"
@@ -27,6 +28,7 @@
 class BaseQuery;
 class Workload;
 class Message;
+class TxnManager;
 
 struct work_queue_entry {
   Message * msg;
@@ -34,6 +36,8 @@ struct work_queue_entry {
   uint64_t txn_id;
   RemReqType rtype;
   uint64_t starttime;
+  // PRIORITY_TS: timestamp of the txn, 0 for home continuations, UINT64_MAX for new txns
+  uint64_t prio_ts;
 
 };
 
@@ -45,10 +49,11 @@ struct CompareSchedEntry {
     return lhs->batch_id < rhs->batch_id;
   }
 };
+// Returns true if lhs runs after rhs (std::priority_queue puts the greatest on top)
 struct CompareWQEntry {
 #if PRIORITY == PRIORITY_FCFS
   bool operator()(const work_queue_entry* lhs, const work_queue_entry* rhs) {
-    return lhs->starttime < rhs->starttime;
+    return lhs->starttime > rhs->starttime;
   }
 #elif PRIORITY == PRIORITY_ACTIVE
   bool operator()(const work_queue_entry* lhs, const work_queue_entry* rhs) {
@@ -56,20 +61,35 @@ struct CompareWQEntry {
       return true;
     if(rhs->rtype == CL_QRY && lhs->rtype != CL_QRY)
       return false;
-    return lhs->starttime < rhs->starttime;
+    return lhs->starttime > rhs->starttime;
   }
 #elif PRIORITY == PRIORITY_HOME
   bool operator()(const work_queue_entry* lhs, const work_queue_entry* rhs) {
-    if(ISLOCAL(lhs->txn_id) && !ISLOCAL(rhs->txn_id))
+    if(IS_LOCAL(lhs->txn_id) && !IS_LOCAL(rhs->txn_id))
       return true;
-    if(ISLOCAL(rhs->txn_id) && !ISLOCAL(lhs->txn_id))
+    if(IS_LOCAL(rhs->txn_id) && !IS_LOCAL(lhs->txn_id))
       return false;
-    return lhs->starttime < rhs->starttime;
+    return lhs->starttime > rhs->starttime;
+  }
+#elif PRIORITY == PRIORITY_TS
+  bool operator()(const work_queue_entry* lhs, const work_queue_entry* rhs) {
+    if(lhs->prio_ts != rhs->prio_ts)
+      return lhs->prio_ts > rhs->prio_ts;
+    return lhs->starttime > rhs->starttime;
   }
 #endif
 
 };
 
+// One worker's share of the priority scheduler. Each worker pops the best
+// entry of its own heap, so the global order is only approximate.
+struct prio_work_queue {
+  std::priority_queue<work_queue_entry*,std::vector<work_queue_entry*>,CompareWQEntry> queue;
+  volatile bool latch;
+  volatile uint64_t cnt;
+  char _pad[CL_SIZE];
+};
+
 class QWorkQueue {
 public:
   void init();
@@ -79,6 +99,16 @@ public:
   Message * sched_dequeue(uint64_t thd_id); 
   void sequencer_enqueue(uint64_t thd_id, Message * msg); 
   Message * sequencer_dequeue(uint64_t thd_id); 
+  // spin-then-park for idle workers and the Calvin lock thread
+  void idle(uint64_t thd_id) {parkers[thd_id].idle(thd_id);}
+  void busy(uint64_t thd_id) {parkers[thd_id].busy();}
+  void sched_idle(uint64_t thd_id) {sched_parker.idle(thd_id);}
+  void sched_busy() {sched_parker.busy();}
+  // [CALVIN] txns whose locks in slice are left to that slice's lock thread
+  void lock_slice_enqueue(uint64_t thd_id, uint64_t slice, TxnManager * txn_man);
+  TxnManager * lock_slice_dequeue(uint64_t thd_id, uint64_t slice);
+  void lock_slice_idle(uint64_t thd_id, uint64_t slice) {lock_slice_parkers[slice].idle(thd_id);}
+  void lock_slice_busy(uint64_t slice) {lock_slice_parkers[slice].busy();}
 
   uint64_t get_cnt() {return get_wq_cnt() + get_rem_wq_cnt() + get_new_wq_cnt();}
   uint64_t get_wq_cnt() {return 0;}
@@ -90,11 +120,25 @@ public:
   //uint64_t get_new_wq_cnt() {return new_query_queue.size();}
 
 private:
-  boost::lockfree::queue<work_queue_entry* > * work_queue;
-  boost::lockfree::queue<work_queue_entry* > * new_txn_queue;
+  // worker that runs all messages of txn_id, so a txn's continuations
+  // stay on one core instead of bouncing off busy workers
+  uint64_t get_owner(uint64_t txn_id) {return (txn_id / g_node_cnt) % g_thread_cnt;}
+  // per-worker queues; new txns have no owner yet and may be stolen by idle workers
+  boost::lockfree::queue<work_queue_entry* > ** work_queue;
+  boost::lockfree::queue<work_queue_entry* > ** new_txn_queue;
+  // PRIORITY_WORK_QUEUE: one heap per worker in place of the two queues above
+  prio_work_queue ** prio_queue;
+  // one per worker, woken when its queues get work
+  Parker * parkers;
+  Parker sched_parker;
+  void prio_push(uint64_t qid, work_queue_entry * entry);
+  // pops the top of heap qid; a steal takes it only if it is a new txn
+  bool prio_pop(uint64_t qid, work_queue_entry *& entry, bool steal);
   boost::lockfree::queue<work_queue_entry* > * seq_queue;
   boost::lockfree::queue<work_queue_entry* > ** sched_queue;
   uint64_t sched_ptr;
+  boost::lockfree::queue<TxnManager* > ** lock_slice_queue;
+  Parker * lock_slice_parkers;
   BaseQuery * last_sched_dq;
   uint64_t curr_epoch;
 
@@ -127,6 +127,19 @@ void WorkerThread::release_txn_man() {
 void WorkerThread::calvin_wrapup() {
   txn_man->release_locks(RCOK);
   txn_man->commit_stats();
+#if LOGGING && LOG_COMMAND
+  if(!txn_man->isRecon()) {
+    // the scheduler logged the command; ack once it is durable
+    LogRecord * record = logger.createRecord(txn_man->get_txn_id(),L_NOTIFY,0,0);
+    record->rcd.batch_id = txn_man->get_batch_id();
+    logger.enqueueRecord(get_thd_id(),record);
+    return;
+  }
+#endif
+  calvin_ack();
+}
+
+void WorkerThread::calvin_ack() {
   DEBUG("(%ld,%ld) calvin ack to %ld\n",txn_man->get_txn_id(),txn_man->get_batch_id(),txn_man->return_id);
   if(txn_man->return_id == g_node_id) {
     work_queue.sequencer_enqueue(_thd_id,Message::create_message(txn_man,CALVIN_ACK));
@@ -198,8 +211,10 @@ RC WorkerThread::run() {
     if(!msg) {
       if(idle_starttime ==0)
         idle_starttime = get_sys_clock();
+      work_queue.idle(get_thd_id());
       continue;
     }
+    work_queue.busy(get_thd_id());
     if(idle_starttime > 0) {
       INC_STATS(_thd_id,worker_idle_time,get_sys_clock() - idle_starttime);
       idle_starttime = 0;
@@ -292,7 +307,7 @@ RC WorkerThread::process_rfin(Message * msg) {
   } 
   txn_man->commit();
   //if(!txn_man->query->readonly() || CC_ALG == OCC)
-  if(!((FinishMessage*)msg)->readonly || CC_ALG == MAAT || CC_ALG == OCC)
+  if(!((FinishMessage*)msg)->readonly || CC_ALG == MAAT || CC_ALG == OCC || CC_ALG == SILO || CC_ALG == TICTOC)
     msg_queue.enqueue(get_thd_id(),Message::create_message(txn_man,RACK_FIN),GET_NODE_ID(msg->get_txn_id()));
   release_txn_man();
 
@@ -370,6 +385,11 @@ RC WorkerThread::process_rqry_rsp(Message * msg) {
   assert(IS_LOCAL(msg->get_txn_id()));
 
   txn_man->txn_stats.remote_wait_time += get_sys_clock() - txn_man->txn_stats.wait_starttime;
+#if CC_ALG == TICTOC
+  // fold in the commit timestamp bound of the remote accesses
+  if(((QueryResponseMessage*)msg)->commit_timestamp > txn_man->get_commit_timestamp())
+    txn_man->set_commit_timestamp(((QueryResponseMessage*)msg)->commit_timestamp);
+#endif
 
   if(((QueryResponseMessage*)msg)->rc == Abort) {
     txn_man->start_abort();
@@ -411,6 +431,14 @@ RC WorkerThread::process_rqry_cont(Message * msg) {
   assert(!IS_LOCAL(msg->get_txn_id()));
   RC rc = RCOK;
 
+#if CC_ALG == DL_DETECT
+  if(txn_man->dl_victim) {
+    txn_man->dl_victim = false;
+    rc = txn_man->abort();
+    msg_queue.enqueue(get_thd_id(),Message::create_message(txn_man,RQRY_RSP),txn_man->return_id);
+    return rc;
+  }
+#endif
   txn_man->run_txn_post_wait();
   rc = txn_man->run_txn();
 
@@ -428,6 +456,14 @@ RC WorkerThread::process_rtxn_cont(Message * msg) {
 
   txn_man->txn_stats.local_wait_time += get_sys_clock() - txn_man->txn_stats.wait_starttime;
 
+#if CC_ALG == DL_DETECT
+  if(txn_man->dl_victim) {
+    // picked as a deadlock victim while blocked
+    txn_man->dl_victim = false;
+    check_if_done(txn_man->start_abort());
+    return RCOK;
+  }
+#endif
   txn_man->run_txn_post_wait();
   RC rc = txn_man->run_txn();
   check_if_done(rc);
@@ -437,6 +473,9 @@ RC WorkerThread::process_rtxn_cont(Message * msg) {
 RC WorkerThread::process_rprepare(Message * msg) {
   DEBUG("RPREP %ld\n",msg->get_txn_id());
     RC rc = RCOK;
+#if CC_ALG == TICTOC
+    txn_man->set_commit_timestamp(((PrepareMessage*)msg)->commit_timestamp);
+#endif
 
     // Validate transaction
     rc  = txn_man->validate();
@@ -475,7 +514,7 @@ RC WorkerThread::process_rtxn(Message * msg) {
           bool ready = txn_man->unset_ready();
           INC_STATS(get_thd_id(),worker_activate_txn_time,get_sys_clock() - ready_starttime);
           assert(ready);
-					if (CC_ALG == WAIT_DIE) {
+					if (CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT) {
             txn_man->set_timestamp(get_next_ts());
           }
           txn_man->txn_stats.starttime = get_sys_clock();
@@ -493,6 +532,13 @@ RC WorkerThread::process_rtxn(Message * msg) {
           if(is_cc_new_timestamp()) {
             txn_man->set_timestamp(get_next_ts());
 					}
+#if CC_ALG == MVCC && MVCC_SNAPSHOT_READ
+          // read-only txns read just below the watermark; the ts is
+          // registered as it is picked so its versions are kept
+          if(txn_man->query->readonly()) {
+            txn_man->set_timestamp(glob_manager.get_snapshot_ts(get_thd_id(),txn_id));
+          }
+#endif
 #if CC_ALG == MVCC
           txn_table.update_min_ts(get_thd_id(),txn_id,0,txn_man->get_timestamp());
 #endif
@@ -528,7 +574,7 @@ RC WorkerThread::process_log_msg(Message * msg) {
   assert(ISREPLICA);
   DEBUG("REPLICA PROCESS %ld\n",msg->get_txn_id());
   LogRecord * record = logger.createRecord(&((LogMessage*)msg)->record);
-  logger.enqueueRecord(record);
+  logger.enqueueRecord(get_thd_id(),record);
   return RCOK;
 }
 
@@ -548,6 +594,10 @@ RC WorkerThread::process_log_flushed(Message * msg) {
   }
 
   txn_man->log_flushed = true;
+#if CC_ALG == CALVIN
+  calvin_ack();
+  return RCOK;
+#endif
   if(g_repl_cnt == 0 || txn_man->repl_finished)
     commit();
   return RCOK; 
@@ -170,6 +170,9 @@ Message * Message::create_message(RemReqType rtype) {
     case CL_RSP:
       msg = new ClientResponseMessage;
       break;
+    case DL_EDGES:
+      msg = new DLEdgeMessage;
+      break;
     default: assert(false);
   }
   assert(msg);
@@ -366,6 +369,12 @@ void Message::release_message(Message * msg) {
       delete m_msg;
       break;
                  }
+    case DL_EDGES: {
+      DLEdgeMessage * m_msg = (DLEdgeMessage*)msg;
+      m_msg->release();
+      delete m_msg;
+      break;
+                   }
     default: { assert(false); }
   }
 }
@@ -373,7 +382,7 @@ void Message::release_message(Message * msg) {
 
 uint64_t QueryMessage::get_size() {
   uint64_t size = Message::mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
   size += sizeof(ts);
 #endif
 #if CC_ALG == OCC 
@@ -384,7 +393,7 @@ uint64_t QueryMessage::get_size() {
 
 void QueryMessage::copy_from_txn(TxnManager * txn) {
   Message::mcopy_from_txn(txn);
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
   ts = txn->get_timestamp();
   assert(ts != 0);
 #endif
@@ -395,7 +404,7 @@ void QueryMessage::copy_from_txn(TxnManager * txn) {
 
 void QueryMessage::copy_to_txn(TxnManager * txn) {
   Message::mcopy_to_txn(txn);
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
   assert(ts != 0);
   txn->set_timestamp(ts);
 #endif
@@ -409,7 +418,7 @@ void QueryMessage::copy_from_buf(char * buf) {
   Message::mcopy_from_buf(buf);
   uint64_t ptr __attribute__ ((unused));
   ptr = Message::mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
  COPY_VAL(ts,buf,ptr);
   assert(ts != 0);
 #endif
@@ -422,7 +431,7 @@ void QueryMessage::copy_to_buf(char * buf) {
   Message::mcopy_to_buf(buf);
   uint64_t ptr __attribute__ ((unused));
   ptr = Message::mget_size();
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
  COPY_BUF(buf,ts,ptr);
   assert(ts != 0);
 #endif
@@ -543,7 +552,7 @@ void TPCCClientQueryMessage::release() {
 
 uint64_t TPCCClientQueryMessage::get_size() {
   uint64_t size = ClientQueryMessage::get_size();
-  size += sizeof(uint64_t) * 10; 
+  size += sizeof(uint64_t) * 12; 
   size += sizeof(char) * LASTNAME_LEN; 
   size += sizeof(bool) * 3;
   size += sizeof(size_t);
@@ -575,6 +584,10 @@ void TPCCClientQueryMessage::copy_from_query(BaseQuery * query) {
   remote = tpcc_query->remote;
   ol_cnt = tpcc_query->ol_cnt;
   o_entry_d = tpcc_query->o_entry_d;
+
+  // delivery, stock level
+  o_carrier_id = tpcc_query->o_carrier_id;
+  threshold = tpcc_query->threshold;
 }
 
 
@@ -595,6 +608,12 @@ void TPCCClientQueryMessage::copy_to_txn(TxnManager * txn) {
     ((TPCCTxnManager*)txn)->state = TPCC_PAYMENT0;
   else if (tpcc_query->txn_type == TPCC_NEW_ORDER) 
     ((TPCCTxnManager*)txn)->state = TPCC_NEWORDER0;
+  else if (tpcc_query->txn_type == TPCC_ORDER_STATUS) 
+    ((TPCCTxnManager*)txn)->state = TPCC_ORDERSTATUS0;
+  else if (tpcc_query->txn_type == TPCC_DELIVERY) 
+    ((TPCCTxnManager*)txn)->state = TPCC_DELIVERY0;
+  else if (tpcc_query->txn_type == TPCC_STOCK_LEVEL) 
+    ((TPCCTxnManager*)txn)->state = TPCC_STOCKLEVEL0;
 	// common txn input for both payment & new-order
   tpcc_query->w_id = w_id;
   tpcc_query->d_id = d_id;
@@ -615,6 +634,10 @@ void TPCCClientQueryMessage::copy_to_txn(TxnManager * txn) {
   tpcc_query->ol_cnt = ol_cnt;
   tpcc_query->o_entry_d = o_entry_d;
 
+  // delivery, stock level
+  tpcc_query->o_carrier_id = o_carrier_id;
+  tpcc_query->threshold = threshold;
+
 }
 
 void TPCCClientQueryMessage::copy_from_buf(char * buf) {
@@ -651,6 +674,9 @@ void TPCCClientQueryMessage::copy_from_buf(char * buf) {
   COPY_VAL(ol_cnt,buf,ptr);
   COPY_VAL(o_entry_d,buf,ptr);
 
+  COPY_VAL(o_carrier_id,buf,ptr);
+  COPY_VAL(threshold,buf,ptr);
+
  assert(ptr == get_size());
 }
 
@@ -683,6 +709,9 @@ void TPCCClientQueryMessage::copy_to_buf(char * buf) {
   COPY_BUF(buf,remote,ptr);
   COPY_BUF(buf,ol_cnt,ptr);
   COPY_BUF(buf,o_entry_d,ptr);
+
+  COPY_BUF(buf,o_carrier_id,ptr);
+  COPY_BUF(buf,threshold,ptr);
  assert(ptr == get_size());
 }
 
@@ -1029,11 +1058,17 @@ void ForwardMessage::copy_to_buf(char * buf) {
 uint64_t PrepareMessage::get_size() {
   uint64_t size = Message::mget_size();
   //size += sizeof(uint64_t);
+#if CC_ALG == TICTOC
+  size += sizeof(uint64_t);
+#endif
   return size;
 }
 
 void PrepareMessage::copy_from_txn(TxnManager * txn) {
   Message::mcopy_from_txn(txn);
+#if CC_ALG == TICTOC
+  commit_timestamp = txn->get_commit_timestamp();
+#endif
 }
 
 void PrepareMessage::copy_to_txn(TxnManager * txn) {
@@ -1043,12 +1078,18 @@ void PrepareMessage::copy_to_txn(TxnManager * txn) {
 void PrepareMessage::copy_from_buf(char * buf) {
   Message::mcopy_from_buf(buf);
   uint64_t ptr = Message::mget_size();
+#if CC_ALG == TICTOC
+  COPY_VAL(commit_timestamp,buf,ptr);
+#endif
  assert(ptr == get_size());
 }
 
 void PrepareMessage::copy_to_buf(char * buf) {
   Message::mcopy_to_buf(buf);
   uint64_t ptr = Message::mget_size();
+#if CC_ALG == TICTOC
+  COPY_BUF(buf,commit_timestamp,ptr);
+#endif
  assert(ptr == get_size());
 }
 
@@ -1139,12 +1180,18 @@ uint64_t QueryResponseMessage::get_size() {
   uint64_t size = Message::mget_size(); 
   size += sizeof(RC);
   //size += sizeof(uint64_t);
+#if CC_ALG == TICTOC
+  size += sizeof(uint64_t);
+#endif
   return size;
 }
 
 void QueryResponseMessage::copy_from_txn(TxnManager * txn) {
   Message::mcopy_from_txn(txn);
   rc = txn->get_rc();
+#if CC_ALG == TICTOC
+  commit_timestamp = txn->get_commit_timestamp();
+#endif
 
 }
 
@@ -1158,6 +1205,9 @@ void QueryResponseMessage::copy_from_buf(char * buf) {
   Message::mcopy_from_buf(buf);
   uint64_t ptr = Message::mget_size();
   COPY_VAL(rc,buf,ptr);
+#if CC_ALG == TICTOC
+  COPY_VAL(commit_timestamp,buf,ptr);
+#endif
 
  assert(ptr == get_size());
 }
@@ -1166,6 +1216,9 @@ void QueryResponseMessage::copy_to_buf(char * buf) {
   Message::mcopy_to_buf(buf);
   uint64_t ptr = Message::mget_size();
   COPY_BUF(buf,rc,ptr);
+#if CC_ALG == TICTOC
+  COPY_BUF(buf,commit_timestamp,ptr);
+#endif
  assert(ptr == get_size());
 }
 
@@ -1228,12 +1281,14 @@ void FinishMessage::copy_to_buf(char * buf) {
 
 void LogMessage::release() {
   //log_records.release();
+  record.release();
 }
 
 uint64_t LogMessage::get_size() {
   uint64_t size = Message::mget_size();
   //size += sizeof(size_t);
   //size += sizeof(LogRecord) * log_records.size();
+  size += record.get_size();
   return size;
 }
 
@@ -1254,14 +1309,19 @@ void LogMessage::copy_from_record(LogRecord * record) {
 void LogMessage::copy_from_buf(char * buf) {
   Message::mcopy_from_buf(buf);
   uint64_t ptr = Message::mget_size();
-  COPY_VAL(record,buf,ptr);
+  // a message always holds one whole record
+  bool ok __attribute__ ((unused));
+  ok = record.copy_from_buf(&buf[ptr],UINT32_MAX);
+  assert(ok);
+  ptr += record.rcd.size;
  assert(ptr == get_size());
 }
 
 void LogMessage::copy_to_buf(char * buf) {
   Message::mcopy_to_buf(buf);
   uint64_t ptr = Message::mget_size();
-  COPY_BUF(buf,record,ptr);
+  record.copy_to_buf(&buf[ptr]);
+  ptr += record.rcd.size;
  assert(ptr == get_size());
 }
 
@@ -1290,6 +1350,41 @@ void LogRspMessage::copy_to_buf(char * buf) {
   //uint64_t ptr = Message::mget_size();
 }
 
+/************************/
+
+uint64_t DLEdgeMessage::get_size() {
+  uint64_t size = Message::mget_size();
+  size += sizeof(size_t);
+  size += sizeof(uint64_t) * edges.size();
+  return size;
+}
+
+void DLEdgeMessage::copy_from_buf(char * buf) {
+  Message::mcopy_from_buf(buf);
+  uint64_t ptr = Message::mget_size();
+  size_t size;
+  COPY_VAL(size,buf,ptr);
+  edges.init(size);
+  for(uint64_t i = 0 ; i < size;i++) {
+    uint64_t item;
+    COPY_VAL(item,buf,ptr);
+    edges.add(item);
+  }
+ assert(ptr == get_size());
+}
+
+void DLEdgeMessage::copy_to_buf(char * buf) {
+  Message::mcopy_to_buf(buf);
+  uint64_t ptr = Message::mget_size();
+  size_t size = edges.size();
+  COPY_BUF(buf,size,ptr);
+  for(uint64_t i = 0; i < edges.size(); i++) {
+    uint64_t item = edges[i];
+    COPY_BUF(buf,item,ptr);
+  }
+ assert(ptr == get_size());
+}
+
 
 
 /************************/
@@ -1421,6 +1516,20 @@ uint64_t TPCCQueryMessage::get_size() {
     size += sizeof(uint64_t); // items size
   }
 
+  // Order Status
+  if(txn_type == TPCC_ORDER_STATUS) {
+    size += sizeof(char) * LASTNAME_LEN; // c_last[LASTNAME_LEN]
+    size += sizeof(bool); // by_last_name
+  }
+
+  // Delivery
+  if(txn_type == TPCC_DELIVERY)
+    size += sizeof(uint64_t); // o_carrier_id
+
+  // Stock Level
+  if(txn_type == TPCC_STOCK_LEVEL)
+    size += sizeof(uint64_t); // threshold
+
   return size;
 }
 
@@ -1455,6 +1564,15 @@ void TPCCQueryMessage::copy_from_txn(TxnManager * txn) {
     o_entry_d = tpcc_query->o_entry_d;
   }
 
+  if(txn_type == TPCC_ORDER_STATUS) {
+    strcpy(c_last,tpcc_query->c_last);
+    by_last_name = tpcc_query->by_last_name;
+  }
+  if(txn_type == TPCC_DELIVERY)
+    o_carrier_id = tpcc_query->o_carrier_id;
+  if(txn_type == TPCC_STOCK_LEVEL)
+    threshold = tpcc_query->threshold;
+
 }
 
 void TPCCQueryMessage::copy_to_txn(TxnManager * txn) {
@@ -1488,6 +1606,18 @@ void TPCCQueryMessage::copy_to_txn(TxnManager * txn) {
     tpcc_query->o_entry_d = o_entry_d;
   }
 
+  if(txn_type == TPCC_ORDER_STATUS) {
+    tpcc_query->d_w_id = w_id;
+    tpcc_query->c_w_id = w_id;
+    tpcc_query->c_d_id = d_id;
+    strcpy(tpcc_query->c_last,c_last);
+    tpcc_query->by_last_name = by_last_name;
+  }
+  if(txn_type == TPCC_DELIVERY)
+    tpcc_query->o_carrier_id = o_carrier_id;
+  if(txn_type == TPCC_STOCK_LEVEL)
+    tpcc_query->threshold = threshold;
+
 
 }
 
@@ -1497,7 +1627,8 @@ void TPCCQueryMessage::copy_from_buf(char * buf) {
   uint64_t ptr = QueryMessage::get_size();
 
   COPY_VAL(txn_type,buf,ptr); 
-  assert(txn_type == TPCC_PAYMENT || txn_type == TPCC_NEW_ORDER);
+  assert(txn_type == TPCC_PAYMENT || txn_type == TPCC_NEW_ORDER || txn_type == TPCC_ORDER_STATUS
+      || txn_type == TPCC_DELIVERY || txn_type == TPCC_STOCK_LEVEL);
   COPY_VAL(state,buf,ptr); 
 	// common txn input for both payment & new-order
   COPY_VAL(w_id,buf,ptr);
@@ -1532,6 +1663,17 @@ void TPCCQueryMessage::copy_from_buf(char * buf) {
     COPY_VAL(o_entry_d,buf,ptr);
   }
 
+  if(txn_type == TPCC_ORDER_STATUS) {
+    COPY_VAL(c_last,buf,ptr);
+    COPY_VAL(by_last_name,buf,ptr);
+  }
+  if(txn_type == TPCC_DELIVERY) {
+    COPY_VAL(o_carrier_id,buf,ptr);
+  }
+  if(txn_type == TPCC_STOCK_LEVEL) {
+    COPY_VAL(threshold,buf,ptr);
+  }
+
  assert(ptr == get_size());
 
 }
@@ -1570,6 +1712,17 @@ void TPCCQueryMessage::copy_to_buf(char * buf) {
     COPY_BUF(buf,ol_cnt,ptr);
     COPY_BUF(buf,o_entry_d,ptr);
   }
+
+  if(txn_type == TPCC_ORDER_STATUS) {
+    COPY_BUF(buf,c_last,ptr);
+    COPY_BUF(buf,by_last_name,ptr);
+  }
+  if(txn_type == TPCC_DELIVERY) {
+    COPY_BUF(buf,o_carrier_id,ptr);
+  }
+  if(txn_type == TPCC_STOCK_LEVEL) {
+    COPY_BUF(buf,threshold,ptr);
+  }
  assert(ptr == get_size());
 
 }
@@ -159,6 +159,10 @@ public:
 
   RC rc;
   uint64_t pid;
+#if CC_ALG == TICTOC
+  // lower bound on the commit timestamp from the remote accesses
+  uint64_t commit_timestamp;
+#endif
 
 };
 
@@ -195,6 +199,9 @@ public:
   uint64_t pid;
   RC rc;
   uint64_t txn_id;
+#if CC_ALG == TICTOC
+  uint64_t commit_timestamp;
+#endif
 };
 
 class ForwardMessage : public Message {
@@ -226,6 +233,21 @@ public:
   uint64_t batch_id;
 };
 
+// [DL_DETECT] the waits-for edges of the txns blocked on the sender's rows,
+// as flat (waiter, waiter ts, owner) triples
+class DLEdgeMessage : public Message {
+public:
+  void copy_from_buf(char * buf);
+  void copy_to_buf(char * buf);
+  void copy_from_txn(TxnManager * txn) {}
+  void copy_to_txn(TxnManager * txn) {}
+  uint64_t get_size();
+  void init() {}
+  void release() { edges.release(); }
+
+  Array<uint64_t> edges;
+};
+
 class ClientResponseMessage : public Message {
 public:
   void copy_from_buf(char * buf);
@@ -309,6 +331,11 @@ public:
   uint64_t ol_cnt;
   uint64_t o_entry_d;
 
+  // delivery
+  uint64_t o_carrier_id;
+  // stock level
+  uint64_t threshold;
+
 };
 
 class PPSClientQueryMessage : public ClientQueryMessage {
@@ -349,7 +376,7 @@ public:
   void release() {}
 
   uint64_t pid;
-#if CC_ALG == WAIT_DIE || CC_ALG == TIMESTAMP || CC_ALG == MVCC
+#if CC_ALG == WAIT_DIE || CC_ALG == DL_DETECT || CC_ALG == TIMESTAMP || CC_ALG == MVCC
   uint64_t ts;
 #endif
 #if CC_ALG == MVCC 
@@ -409,6 +436,11 @@ public:
   uint64_t ol_cnt;
   uint64_t o_entry_d;
 
+  // delivery
+  uint64_t o_carrier_id;
+  // stock level
+  uint64_t threshold;
+
 };
 
 class PPSQueryMessage : public QueryMessage {
@@ -51,6 +51,14 @@ void MessageThread::check_and_send_batches() {
   INC_STATS(_thd_id,mtx[11],get_sys_clock() - starttime);
 }
 
+bool MessageThread::has_batches() {
+  for(uint64_t dest_node_id = 0; dest_node_id < buffer_cnt; dest_node_id++) {
+    if(buffer[dest_node_id]->cnt > 0)
+      return true;
+  }
+  return false;
+}
+
 void MessageThread::send_batch(uint64_t dest_node_id) {
   uint64_t starttime = get_sys_clock();
     mbuf * sbuf = buffer[dest_node_id];
@@ -76,43 +84,52 @@ void MessageThread::send_batch(uint64_t dest_node_id) {
 void MessageThread::run() {
   
   uint64_t starttime = get_sys_clock();
-  Message * msg = NULL;
-  uint64_t dest_node_id;
-  mbuf * sbuf;
-
+  Message * msgs[MSG_DEQUEUE_MAX];
+  uint64_t dest_node_ids[MSG_DEQUEUE_MAX];
 
-  dest_node_id = msg_queue.dequeue(get_thd_id(), msg);
-  if(!msg) {
+  uint64_t cnt = msg_queue.dequeue(get_thd_id(), msgs, dest_node_ids, MSG_DEQUEUE_MAX);
+  if(cnt == 0) {
     check_and_send_batches();
+    // batches waiting for their deadline keep the thread polling
+    if(!has_batches())
+      msg_queue.idle(get_thd_id());
     INC_STATS(_thd_id,mtx[9],get_sys_clock() - starttime);
     return;
   }
+  msg_queue.busy(get_thd_id());
+  for(uint64_t i = 0; i < cnt; i++) {
+    buffer_msg(msgs[i],dest_node_ids[i]);
+  }
+
+  check_and_send_batches();
+  INC_STATS(_thd_id,mtx[10],get_sys_clock() - starttime);
+
+}
+
+void MessageThread::buffer_msg(Message * msg, uint64_t dest_node_id) {
   assert(msg);
   assert(dest_node_id < g_total_node_cnt);
   assert(dest_node_id != g_node_id);
 
-  sbuf = buffer[dest_node_id];
+  mbuf * sbuf = buffer[dest_node_id];
 
   if(!sbuf->fits(msg->get_size())) {
     assert(sbuf->cnt > 0);
     send_batch(dest_node_id);
   }
 
+  // Serialize straight into the nanomsg buffer that will be sent
   uint64_t copy_starttime = get_sys_clock();
   msg->copy_to_buf(&(sbuf->buffer[sbuf->ptr]));
   INC_STATS(_thd_id,msg_copy_output_time,get_sys_clock() - copy_starttime);
   DEBUG("%ld Buffered Msg %d, (%ld,%ld) to %ld\n",_thd_id,msg->rtype,msg->txn_id,msg->batch_id,dest_node_id);
   sbuf->cnt += 1;
   sbuf->ptr += msg->get_size();
+  sbuf->arrive();
   // Free message here, no longer needed unless CALVIN sequencer
   if(CC_ALG != CALVIN) {
     Message::release_message(msg);
   }
   if(sbuf->starttime == 0)
     sbuf->starttime = get_sys_clock();
-
-  check_and_send_batches();
-  INC_STATS(_thd_id,mtx[10],get_sys_clock() - starttime);
-
 }
-
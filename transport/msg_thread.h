@@ -21,19 +21,25 @@
 #include "helper.h"
 #include "nn.hpp"
 
+class Message;
+
 struct mbuf {
+  // nanomsg-owned; handed to the transport on send and replaced in reset()
   char * buffer;
   uint64_t starttime;
   uint64_t ptr;
   uint64_t cnt;
   bool wait;
+  // last message arrival and the smoothed gap between arrivals
+  uint64_t last_time;
+  uint64_t intv;
 
   void init(uint64_t dest_id) {
-    buffer = (char*)nn_allocmsg(g_msg_size,0);
+    last_time = 0;
+    intv = 0;
   }
   void reset(uint64_t dest_id) {
-    //buffer = (char*)nn_allocmsg(g_msg_size,0);
-    //memset(buffer,0,g_msg_size);
+    buffer = (char*)nn_allocmsg(g_msg_size,0);
     starttime = 0;
     cnt = 0;
     wait = false;
@@ -52,11 +58,20 @@ struct mbuf {
   bool fits(uint64_t s) {
     return (ptr + s) <= g_msg_size;
   }
+  void arrive() {
+    uint64_t now = get_sys_clock();
+    if(last_time > 0)
+      intv = (intv * 7 + (now - last_time)) / 8;
+    last_time = now;
+  }
   bool ready() {
     if(cnt == 0)
       return false;
     if( (get_sys_clock() - starttime) >= g_msg_time_limit )
       return true;
+    // Don't hold the batch if the next message is not expected before the deadline
+    if(last_time + intv >= starttime + g_msg_time_limit)
+      return true;
     return false;
   }
 };
@@ -66,7 +81,9 @@ public:
   void init(uint64_t thd_id);
   void run();
   void check_and_send_batches(); 
+  bool has_batches();
   void send_batch(uint64_t dest_node_id); 
+  void buffer_msg(Message * msg, uint64_t dest_node_id);
   void copy_to_buffer(mbuf * sbuf, RemReqType type, BaseQuery * qry); 
   uint64_t get_msg_size(RemReqType type, BaseQuery * qry); 
   void rack( mbuf * sbuf,BaseQuery * qry);
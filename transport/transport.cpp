@@ -21,6 +21,7 @@
 #include "tpcc_query.h"
 #include "query.h"
 #include "message.h"
+#include <poll.h>
 
 
 #define MAX_IFADDR_LEN 20 // max # of characters in name of address
@@ -216,6 +217,12 @@ void Transport::init() {
     }
   }
 
+  for(uint64_t i = 0; i < recv_sockets.size(); i++) {
+    int fd;
+    size_t fd_size = sizeof(fd);
+    recv_sockets[i]->sock.getsockopt(NN_SOL_SOCKET,NN_RCVFD,&fd,&fd_size);
+    recv_fds.push_back(fd);
+  }
 
 	fflush(stdout);
 }
@@ -225,16 +232,18 @@ void Transport::send_msg(uint64_t send_thread_id, uint64_t dest_node_id, void *
   uint64_t starttime = get_sys_clock();
 
   Socket * socket = send_sockets.find(std::make_pair(dest_node_id,send_thread_id))->second;
-  // Copy messages to nanomsg buffer
-	void * buf = nn_allocmsg(size,0);
-	memcpy(buf,sbuf,size);
+  // sbuf is already a nanomsg buffer: trim it to the batch and send it without a copy.
+  // nanomsg owns it once the send succeeds.
+	void * buf = nn_reallocmsg(sbuf,size);
+  assert(buf);
   DEBUG("%ld Sending batch of %d bytes to node %ld on socket %ld\n",send_thread_id,size,dest_node_id,(uint64_t)socket);
 
   int rc = -1;
   while(rc < 0 && (!simulation->is_setup_done() || (simulation->is_setup_done() && !simulation->is_done()))) {
     rc= socket->sock.send(&buf,NN_MSG,NN_DONTWAIT);
   }
-  //nn_freemsg(sbuf);
+  if(rc < 0)
+    nn_freemsg(buf);
   DEBUG("%ld Batch of %d bytes sent to node %ld\n",send_thread_id,size,dest_node_id);
 
   INC_STATS(send_thread_id,msg_send_time,get_sys_clock() - starttime);
@@ -303,6 +312,25 @@ std::vector<Message*> * Transport::recv_msg(uint64_t thd_id) {
   return msgs;
 }
 
+void Transport::wait_msg(uint64_t thd_id) {
+  uint64_t starttime = get_sys_clock();
+  std::vector<struct pollfd> fds;
+  // the sockets recv_msg visits for this thread
+  for(uint64_t i = thd_id % g_this_rem_thread_cnt; i < recv_fds.size(); i += g_this_rem_thread_cnt) {
+    struct pollfd pfd;
+    pfd.fd = recv_fds[i];
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    fds.push_back(pfd);
+  }
+  if(fds.empty())
+    return;
+  int timeout = IDLE_PARK_TIMEOUT / MILLION;
+  poll(&fds[0],fds.size(),timeout > 0 ? timeout : 1);
+  INC_STATS(thd_id,idle_park_cnt,1);
+  INC_STATS(thd_id,idle_park_time,get_sys_clock() - starttime);
+}
+
 /*
 void Transport::simple_send_msg(int size) {
 	void * sbuf = nn_allocmsg(size,0);
@@ -56,8 +56,11 @@ class Transport {
     uint64_t get_port_id(uint64_t src_node_id, uint64_t dest_node_id, uint64_t send_thread_id); 
     Socket * bind(uint64_t port_id); 
     Socket * connect(uint64_t dest_id,uint64_t port_id); 
+    // sbuf must come from nn_allocmsg; ownership passes to the transport
     void send_msg(uint64_t send_thread_id, uint64_t dest_node_id, void * sbuf,int size); 
     std::vector<Message*> * recv_msg(uint64_t thd_id);
+    // sleeps until a socket read by thd_id has a message, or IDLE_PARK_TIMEOUT
+    void wait_msg(uint64_t thd_id);
 		void simple_send_msg(int size); 
 		uint64_t simple_recv_msg();
 
@@ -65,6 +68,8 @@ class Transport {
     uint64_t rr;
     std::map<std::pair<uint64_t,uint64_t>,Socket*> send_sockets; // dest_node_id,send_thread_id : socket
     std::vector<Socket*> recv_sockets;
+    // file descriptors that become readable when recv_sockets have messages
+    std::vector<int> recv_fds;
 
     uint64_t _node_cnt;
     uint64_t _sock_cnt;
@@ -0,0 +1,146 @@
+/*
+   Copyright 2016 Massachusetts Institute of Technology
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "global.h"
+#include "helper.h"
+#include "mem_alloc.h"
+#include "index_hash.h"
+
+// Concurrency stress test for IndexHash. Writer threads insert disjoint
+// keys into a small table, so chains are long and readers keep racing
+// with inserts into the bucket they read. Every key gets two items; a key
+// is published once both are in. Readers check that a published key is
+// found with exactly its two items, and that any chain they see, even of
+// a key still being inserted, only holds items of that key.
+
+#define UT_BUCKET_CNT 1024
+#define UT_ITEMS_PER_KEY 2
+
+void parser(int argc, char * argv[]);
+
+static IndexHash ut_index;
+static uint64_t ut_writer_cnt;
+static uint64_t ut_reader_cnt;
+static uint64_t ut_keys_per_writer;
+// keys [0, published[w]) of writer w are fully inserted
+static volatile uint64_t * ut_published;
+static volatile bool ut_writers_done;
+static volatile uint64_t ut_read_cnt;
+
+static idx_key_t ut_key(uint64_t writer, uint64_t i) {
+	return i * ut_writer_cnt + writer;
+}
+
+// location of the n-th item of key, so a reader can tell whose item it is
+static void * ut_location(idx_key_t key, uint64_t n) {
+	return (void *) (key * UT_ITEMS_PER_KEY + n + 1);
+}
+
+// walks the item chain of key and returns its length
+static uint64_t ut_check_chain(idx_key_t key, itemid_t * item) {
+	uint64_t len = 0;
+	bool seen[UT_ITEMS_PER_KEY] = {};
+	for (; item != NULL; item = ATOM_LOAD_ACQ(item->next)) {
+		uint64_t loc = (uint64_t) item->location;
+		M_ASSERT_V(item->valid && loc > key * UT_ITEMS_PER_KEY
+				&& loc <= (key + 1) * UT_ITEMS_PER_KEY,
+				"Torn chain: key %ld has item %ld\n", key, loc);
+		uint64_t n = loc - key * UT_ITEMS_PER_KEY - 1;
+		M_ASSERT_V(!seen[n], "Torn chain: key %ld has item %ld twice\n", key, loc);
+		seen[n] = true;
+		len ++;
+	}
+	return len;
+}
+
+static void * ut_write(void * arg) {
+	uint64_t writer = (uint64_t) arg;
+	for (uint64_t i = 0; i < ut_keys_per_writer; i++) {
+		idx_key_t key = ut_key(writer, i);
+		for (uint64_t n = 0; n < UT_ITEMS_PER_KEY; n++) {
+			itemid_t * item = (itemid_t *) mem_allocator.alloc(sizeof(itemid_t));
+			item->init();
+			item->type = DT_row;
+			item->location = ut_location(key, n);
+			item->valid = true;
+			ut_index.index_insert(key, item, 0);
+		}
+		ATOM_STORE_REL(ut_published[writer], i + 1);
+	}
+	return NULL;
+}
+
+static void * ut_read(void * arg) {
+	uint64_t seed = (uint64_t) arg + 1;
+	uint64_t read_cnt = 0;
+	while (!ut_writers_done) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		uint64_t writer = (seed >> 33) % ut_writer_cnt;
+		uint64_t published = ATOM_LOAD_ACQ(ut_published[writer]);
+		// also probe a few keys past the published ones, which may be mid-insert
+		uint64_t i = (seed >> 17) % (published + 4);
+		idx_key_t key = ut_key(writer, i);
+		itemid_t * item;
+		ut_index.index_read(key, 0, item, 0);
+		uint64_t len = ut_check_chain(key, item);
+		if (i < published) {
+			M_ASSERT_V(len == UT_ITEMS_PER_KEY, "Key %ld has %ld of %d items\n"
+					, key, len, UT_ITEMS_PER_KEY);
+		}
+		read_cnt ++;
+	}
+	ATOM_ADD(ut_read_cnt, read_cnt);
+	return NULL;
+}
+
+int main(int argc, char * argv[]) {
+	parser(argc, argv);
+	ut_writer_cnt = g_thread_cnt;
+	ut_reader_cnt = g_thread_cnt;
+	ut_keys_per_writer = 20000;
+	ut_published = new uint64_t [ut_writer_cnt];
+	for (uint64_t i = 0; i < ut_writer_cnt; i++)
+		ut_published[i] = 0;
+	ut_writers_done = false;
+	ut_read_cnt = 0;
+	ut_index.init(UT_BUCKET_CNT);
+
+	pthread_t * writers = new pthread_t [ut_writer_cnt];
+	pthread_t * readers = new pthread_t [ut_reader_cnt];
+	for (uint64_t i = 0; i < ut_reader_cnt; i++)
+		pthread_create(&readers[i], NULL, ut_read, (void *) i);
+	for (uint64_t i = 0; i < ut_writer_cnt; i++)
+		pthread_create(&writers[i], NULL, ut_write, (void *) i);
+	for (uint64_t i = 0; i < ut_writer_cnt; i++)
+		pthread_join(writers[i], NULL);
+	ut_writers_done = true;
+	for (uint64_t i = 0; i < ut_reader_cnt; i++)
+		pthread_join(readers[i], NULL);
+
+	// every inserted key is found, with all its items
+	for (uint64_t w = 0; w < ut_writer_cnt; w++) {
+		for (uint64_t i = 0; i < ut_keys_per_writer; i++) {
+			idx_key_t key = ut_key(w, i);
+			itemid_t * item;
+			ut_index.index_read(key, 0, item, 0);
+			M_ASSERT_V(ut_check_chain(key, item) == UT_ITEMS_PER_KEY,
+					"Key %ld lost items\n", key);
+		}
+	}
+	printf("IndexHash stress: %ld writers inserted %ld keys while %ld readers did %ld reads: PASS\n"
+			, ut_writer_cnt, ut_writer_cnt * ut_keys_per_writer, ut_reader_cnt, ut_read_cnt);
+	return 0;
+}